@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "heap.h"
+#include "apsp.h"
+#include "workers.h"
+
+// Floyd-Warshall works on FLOYD_BLOCK x FLOYD_BLOCK tiles so the k-row and
+// the i-row of a tile stay in cache; the innermost loop is a plain min over
+// contiguous ints, which the compiler vectorizes at -O3 (or -O2 -ftree-vectorize).
+#define FLOYD_BLOCK 64
+
+#define MATRIX_MAGIC "AIRDIST"
+#define MATRIX_VERSION 1
+
+typedef struct {
+    const FrozenGraph *fg;
+    int *dist;
+    atomic_int nextOrigin;
+    atomic_int failed;
+} DijkstraJob;
+
+typedef struct {
+    int *dist;
+    int n;
+    int kb;         // current diagonal block
+    int blocks;
+    atomic_int nextTile;
+} FloydJob;
+
+static void dijkstra_worker(void *arg, int worker) {
+    DijkstraJob *job = arg;
+    const FrozenGraph *fg = job->fg;
+    int n = fg->cityCount;
+    (void)worker;
+    
+    IndexedHeap heap;
+    if (heap_init(&heap, n > 0 ? n : 1) != 0) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+    
+    while (1) {
+        int s = atomic_fetch_add(&job->nextOrigin, 1);
+        if (s >= n) break;
+        
+        // the matrix row doubles as the distance array of this search
+        int *row = job->dist + (size_t)s * n;
+        for (int v = 0; v < n; ++v) {
+            row[v] = MAX_DISTANCE;
+        }
+        row[s] = 0;
+        heap_clear(&heap);
+        heap_push_or_decrease(&heap, s, 0);
+        
+        while (!heap_empty(&heap)) {
+            int du;
+            int u = heap_pop_min(&heap, &du);
+            for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+                int v = fg->edges[e].dest;
+                int nd = du + fg->edges[e].distance;
+                if (nd < row[v]) {
+                    row[v] = nd;
+                    heap_push_or_decrease(&heap, v, nd);
+                }
+            }
+        }
+    }
+    heap_free(&heap);
+}
+
+static void relax_row(int *restrict row, const int *restrict via, int base, int count) {
+    for (int j = 0; j < count; ++j) {
+        int d = base + via[j];
+        row[j] = d < row[j] ? d : row[j];
+    }
+}
+
+// relaxes tile (i0.., j0..) through intermediates k0.. of one diagonal block
+static void floyd_tile(int *dist, int n, int i0, int j0, int k0) {
+    int i1 = i0 + FLOYD_BLOCK < n ? i0 + FLOYD_BLOCK : n;
+    int j1 = j0 + FLOYD_BLOCK < n ? j0 + FLOYD_BLOCK : n;
+    int k1 = k0 + FLOYD_BLOCK < n ? k0 + FLOYD_BLOCK : n;
+    
+    for (int k = k0; k < k1; ++k) {
+        const int *rowK = dist + (size_t)k * n;
+        for (int i = i0; i < i1; ++i) {
+            int *rowI = dist + (size_t)i * n;
+            int dik = rowI[k];
+            // row k cannot improve itself, which keeps rowI and rowK disjoint
+            if (i == k || dik >= MAX_DISTANCE) continue;
+            relax_row(rowI + j0, rowK + j0, dik, j1 - j0);
+        }
+    }
+}
+
+// phase 3: every tile outside the current block row and column
+static void floyd_worker(void *arg, int worker) {
+    FloydJob *job = arg;
+    int b = job->blocks;
+    int k0 = job->kb * FLOYD_BLOCK;
+    (void)worker;
+    
+    while (1) {
+        int t = atomic_fetch_add(&job->nextTile, 1);
+        if (t >= b * b) break;
+        
+        int ib = t / b;
+        int jb = t % b;
+        if (ib == job->kb || jb == job->kb) continue;
+        floyd_tile(job->dist, job->n, ib * FLOYD_BLOCK, jb * FLOYD_BLOCK, k0);
+    }
+}
+
+static void floyd_warshall(const FrozenGraph *fg, int *dist, int threads) {
+    int n = fg->cityCount;
+    
+    for (size_t i = 0; i < (size_t)n * n; ++i) {
+        dist[i] = MAX_DISTANCE;
+    }
+    for (int u = 0; u < n; ++u) {
+        int *row = dist + (size_t)u * n;
+        row[u] = 0;
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            int v = fg->edges[e].dest;
+            if (fg->edges[e].distance < row[v]) row[v] = fg->edges[e].distance;
+        }
+    }
+    
+    FloydJob job;
+    job.dist = dist;
+    job.n = n;
+    job.blocks = (n + FLOYD_BLOCK - 1) / FLOYD_BLOCK;
+    
+    for (int kb = 0; kb < job.blocks; ++kb) {
+        int k0 = kb * FLOYD_BLOCK;
+        
+        // phase 1: the diagonal block, then phase 2: its block row and column
+        floyd_tile(dist, n, k0, k0, k0);
+        for (int b = 0; b < job.blocks; ++b) {
+            if (b == kb) continue;
+            floyd_tile(dist, n, k0, b * FLOYD_BLOCK, k0);
+            floyd_tile(dist, n, b * FLOYD_BLOCK, k0, k0);
+        }
+        
+        job.kb = kb;
+        atomic_init(&job.nextTile, 0);
+        run_workers(threads, floyd_worker, &job);
+    }
+}
+
+DistanceMatrix *frozen_all_pairs(const FrozenGraph *fg, ApspMethod method, int threads) {
+    if (fg == NULL) return NULL;
+    
+    int n = fg->cityCount;
+    DistanceMatrix *dm = malloc(sizeof(DistanceMatrix));
+    if (dm == NULL) return NULL;
+    
+    dm->cityCount = n;
+    dm->ids = malloc((n > 0 ? n : 1) * sizeof(int));
+    dm->dist = malloc((n > 0 ? (size_t)n * n : 1) * sizeof(int));
+    if (dm->ids == NULL || dm->dist == NULL) {
+        distance_matrix_free(dm);
+        return NULL;
+    }
+    memcpy(dm->ids, fg->ids, n * sizeof(int));
+    
+    if (method == APSP_AUTO) {
+        // Floyd-Warshall does n^3 work regardless of the routes, so it only wins when dense
+        int dense = (long long)fg->edgeCount * 8 >= (long long)n * n;
+        method = n <= APSP_FLOYD_MAX_CITIES && dense ? APSP_FLOYD : APSP_DIJKSTRA;
+    }
+    
+    if (method == APSP_FLOYD) {
+        floyd_warshall(fg, dm->dist, threads);
+    } else {
+        DijkstraJob job;
+        job.fg = fg;
+        job.dist = dm->dist;
+        atomic_init(&job.nextOrigin, 0);
+        atomic_init(&job.failed, 0);
+        run_workers(threads, dijkstra_worker, &job);
+        if (atomic_load(&job.failed)) {
+            distance_matrix_free(dm);
+            return NULL;
+        }
+    }
+    
+    for (size_t i = 0; i < (size_t)n * n; ++i) {
+        if (dm->dist[i] >= MAX_DISTANCE) dm->dist[i] = -1;
+    }
+    return dm;
+}
+
+DistanceMatrix *all_pairs(Graph *g, ApspMethod method, int threads) {
+    if (g == NULL) return NULL;
+    return frozen_all_pairs(graph_snapshot(g), method, threads);
+}
+
+// distance between two city ids, -1 if unreachable or unknown
+int distance_matrix_lookup(const DistanceMatrix *dm, const FrozenGraph *fg, int from, int to) {
+    if (dm == NULL || fg == NULL || fg->cityCount != dm->cityCount) return -1;
+    
+    int i = frozen_find_city(fg, from);
+    int j = frozen_find_city(fg, to);
+    if (i == -1 || j == -1) return -1;
+    return dm->dist[(size_t)i * dm->cityCount + j];
+}
+
+// Layout: "AIRDIST\0", uint32 version, int32 cityCount, int32 ids[cityCount],
+// then the int32 matrix row by row, all in host byte order.
+int distance_matrix_write(const DistanceMatrix *dm, const char *path) {
+    if (dm == NULL || path == NULL) return -1;
+    
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) return -1;
+    
+    char magic[8] = MATRIX_MAGIC;
+    uint32_t version = MATRIX_VERSION;
+    int32_t n = dm->cityCount;
+    size_t cells = (size_t)n * n;
+    
+    int ok = fwrite(magic, sizeof(magic), 1, fp) == 1 &&
+             fwrite(&version, sizeof(version), 1, fp) == 1 &&
+             fwrite(&n, sizeof(n), 1, fp) == 1 &&
+             fwrite(dm->ids, sizeof(int), n, fp) == (size_t)n &&
+             fwrite(dm->dist, sizeof(int), cells, fp) == cells;
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+void distance_matrix_free(DistanceMatrix *dm) {
+    if (dm == NULL) return;
+    free(dm->ids);
+    free(dm->dist);
+    free(dm);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef APSP_H
+#define APSP_H
+
+#include "graph.h"
+
+// Origin-destination distance matrix. dist[i * cityCount + j] is the shortest
+// distance from city ids[i] to city ids[j], or -1 if j cannot be reached.
+
+typedef enum {
+    APSP_AUTO,     // Floyd-Warshall for small dense networks, Dijkstra otherwise
+    APSP_DIJKSTRA, // one single-source search per origin, origins spread over threads
+    APSP_FLOYD     // blocked Floyd-Warshall
+} ApspMethod;
+
+#define APSP_FLOYD_MAX_CITIES 1024
+
+typedef struct {
+    int cityCount;
+    int *ids;
+    int *dist;
+} DistanceMatrix;
+
+DistanceMatrix *all_pairs(Graph *g, ApspMethod method, int threads);
+DistanceMatrix *frozen_all_pairs(const FrozenGraph *fg, ApspMethod method, int threads);
+int distance_matrix_lookup(const DistanceMatrix *dm, const FrozenGraph *fg, int from, int to);
+int distance_matrix_write(const DistanceMatrix *dm, const char *path);
+void distance_matrix_free(DistanceMatrix *dm);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 8
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;
+    size_t used;
+};
+
+// the header is padded so the first allocation in a block is aligned too
+#define BLOCK_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+void arena_init(Arena *a, size_t blockSize) {
+    a->head = NULL;
+    a->blockSize = blockSize;
+    a->reserved = 0;
+    a->blocks = 0;
+}
+
+// exits on allocation failure like the other growth helpers
+void *arena_alloc(Arena *a, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    
+    ArenaBlock *b = a->head;
+    if (b == NULL || b->size - b->used < size) {
+        // oversized requests get a block of their own behind the current one,
+        // so the rest of the current block stays usable
+        size_t blockSize = size > a->blockSize / 4 ? size : a->blockSize;
+        ArenaBlock *fresh = malloc(BLOCK_HEADER + blockSize);
+        if (fresh == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        fresh->size = blockSize;
+        fresh->used = 0;
+        a->reserved += BLOCK_HEADER + blockSize;
+        a->blocks++;
+        
+        if (blockSize != a->blockSize && b != NULL) {
+            fresh->next = b->next;
+            b->next = fresh;
+        } else {
+            fresh->next = b;
+            a->head = fresh;
+        }
+        b = fresh;
+    }
+    
+    void *p = (char *)b + BLOCK_HEADER + b->used;
+    b->used += size;
+    return p;
+}
+
+char *arena_strdup(Arena *a, const char *s) {
+    size_t len = strlen(s) + 1;
+    char *copy = arena_alloc(a, len);
+    memcpy(copy, s, len);
+    return copy;
+}
+
+void arena_free(Arena *a) {
+    ArenaBlock *b = a->head;
+    while (b != NULL) {
+        ArenaBlock *next = b->next;
+        free(b);
+        b = next;
+    }
+    a->head = NULL;
+    a->reserved = 0;
+    a->blocks = 0;
+}
+
+void block_pool_init(BlockPool *p, size_t elemSize, size_t slabSize) {
+    arena_init(&p->arena, slabSize);
+    p->elemSize = elemSize;
+    for (int i = 0; i < POOL_CLASS_COUNT; ++i) {
+        p->freeLists[i] = NULL;
+    }
+}
+
+static int size_class(int capacity) {
+    int k = 0;
+    while ((POOL_MIN_CAPACITY << k) < capacity) k++;
+    return k;
+}
+
+// returns an array of at least count elements; *capacity receives its real size
+void *block_pool_alloc(BlockPool *p, int count, int *capacity) {
+    int k = size_class(count);
+    if (k >= POOL_CLASS_COUNT) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = POOL_MIN_CAPACITY << k;
+    
+    void *block = p->freeLists[k];
+    if (block != NULL) {
+        // a released block stores the next free block in its first bytes
+        memcpy(&p->freeLists[k], block, sizeof(void *));
+        return block;
+    }
+    return arena_alloc(&p->arena, (size_t)*capacity * p->elemSize);
+}
+
+void block_pool_release(BlockPool *p, void *block, int capacity) {
+    if (block == NULL) return;
+    
+    int k = size_class(capacity);
+    memcpy(block, &p->freeLists[k], sizeof(void *));
+    p->freeLists[k] = block;
+}
+
+void block_pool_free(BlockPool *p) {
+    arena_free(&p->arena);
+    for (int i = 0; i < POOL_CLASS_COUNT; ++i) {
+        p->freeLists[i] = NULL;
+    }
+}
\ No newline at end of file
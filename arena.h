@@ -0,0 +1,38 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator: memory comes from large blocks and is only returned all
+// at once by arena_free.
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;
+    size_t blockSize;
+    size_t reserved;       // bytes obtained from malloc
+    unsigned long blocks;  // number of malloc calls made
+} Arena;
+
+// Power-of-two size classes of element arrays carved from an arena.
+// Released arrays go on a free list for their class and are reused.
+#define POOL_MIN_CAPACITY 4
+#define POOL_CLASS_COUNT 28
+
+typedef struct {
+    Arena arena;
+    size_t elemSize;
+    void *freeLists[POOL_CLASS_COUNT];
+} BlockPool;
+
+void arena_init(Arena *a, size_t blockSize);
+void *arena_alloc(Arena *a, size_t size);
+char *arena_strdup(Arena *a, const char *s);
+void arena_free(Arena *a);
+
+void block_pool_init(BlockPool *p, size_t elemSize, size_t slabSize);
+void *block_pool_alloc(BlockPool *p, int count, int *capacity);
+void block_pool_release(BlockPool *p, void *block, int capacity);
+void block_pool_free(BlockPool *p);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "graph.h"
+#include "heap.h"
+#include "astar.h"
+#include "query.h"
+
+// Bidirectional A* with great-circle lower bounds.
+//
+// hT(v) = floor(geoBound * gc(v, t)) and hS(v) = floor(geoBound * gc(s, v)) are
+// consistent for integer route lengths. Both searches use the average potential
+// in doubled units, P(v) = hT(v) - hS(v): forward keys are 2 * df(v) + P(v) and
+// backward keys are 2 * db(v) - P(v). Both then walk the same non-negative
+// reduced graph, so the usual bidirectional stopping rule applies:
+// stop once minForward + minBackward >= 2 * best.
+
+typedef struct {
+    const FrozenGraph *fg;
+    QueryContext *qc; // potentials are cached in qc for the current query
+    int source;
+    int target;
+} GeoPotential;
+
+static int potential_of(GeoPotential *gp, int v) {
+    QueryContext *qc = gp->qc;
+    if (qc->potentialStamp[v] != qc->generation) {
+        const FrozenGraph *fg = gp->fg;
+        int toTarget = 0, fromSource = 0;
+        if (fg->geoBound > 0) {
+            toTarget = (int)floor(fg->geoBound * great_circle_km(fg->latitude[v], fg->longitude[v],
+                                                                 fg->latitude[gp->target], fg->longitude[gp->target]));
+            fromSource = (int)floor(fg->geoBound * great_circle_km(fg->latitude[gp->source], fg->longitude[gp->source],
+                                                                   fg->latitude[v], fg->longitude[v]));
+        }
+        qc->potential[v] = toTarget - fromSource;
+        qc->potentialStamp[v] = qc->generation;
+    }
+    return qc->potential[v];
+}
+
+int frozen_point_to_point_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest,
+                              int *path, int *pathLength, int *settled) {
+    if (fg == NULL || qc == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    int sourceIdx = frozen_find_city(fg, source);
+    int destIdx = frozen_find_city(fg, dest);
+    if (sourceIdx == -1 || destIdx == -1) return -1;
+    if (query_context_fit(qc, fg->cityCount, fg->edgeCount) != 0) return -1;
+    
+    query_begin(qc);
+    GeoPotential gp = { fg, qc, sourceIdx, destIdx };
+    SearchSide *fw = &qc->forward;
+    SearchSide *bw = &qc->backward;
+    
+    int best = MAX_DISTANCE;
+    int meet = -1;
+    int settledCount = 0;
+    
+    side_set(qc, fw, sourceIdx, 0, -1);
+    side_set(qc, bw, destIdx, 0, -1);
+    heap_push_or_decrease(&fw->heap, sourceIdx, potential_of(&gp, sourceIdx));
+    heap_push_or_decrease(&bw->heap, destIdx, -potential_of(&gp, destIdx));
+    if (sourceIdx == destIdx) {
+        best = 0;
+        meet = sourceIdx;
+    }
+    
+    while (!heap_empty(&fw->heap) && !heap_empty(&bw->heap)) {
+        int topF = heap_min_key(&fw->heap);
+        int topB = heap_min_key(&bw->heap);
+        if (best != MAX_DISTANCE && (long)topF + topB >= 2L * best) break;
+        
+        if (topF <= topB) {
+            int u = heap_pop_min(&fw->heap, NULL);
+            int du = fw->dist[u];
+            settledCount++;
+            for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+                int v = fg->edges[e].dest;
+                int newDist = du + fg->edges[e].distance;
+                if (newDist < side_dist(qc, fw, v)) {
+                    side_set(qc, fw, v, newDist, u);
+                    heap_push_or_decrease(&fw->heap, v, 2 * newDist + potential_of(&gp, v));
+                    int dv = side_dist(qc, bw, v);
+                    if (dv != MAX_DISTANCE && newDist + dv < best) {
+                        best = newDist + dv;
+                        meet = v;
+                    }
+                }
+            }
+        } else {
+            int u = heap_pop_min(&bw->heap, NULL);
+            int du = bw->dist[u];
+            settledCount++;
+            for (int e = fg->revOffsets[u]; e < fg->revOffsets[u + 1]; ++e) {
+                int v = fg->revEdges[e].dest;
+                int newDist = du + fg->revEdges[e].distance;
+                if (newDist < side_dist(qc, bw, v)) {
+                    side_set(qc, bw, v, newDist, u);
+                    heap_push_or_decrease(&bw->heap, v, 2 * newDist - potential_of(&gp, v));
+                    int dv = side_dist(qc, fw, v);
+                    if (dv != MAX_DISTANCE && dv + newDist < best) {
+                        best = dv + newDist;
+                        meet = v;
+                    }
+                }
+            }
+        }
+    }
+    
+    if (meet != -1) {
+        int len = 0;
+        for (int cur = meet; cur != -1; cur = fw->link[cur]) {
+            len++;
+        }
+        int at = len;
+        for (int cur = meet; cur != -1; cur = fw->link[cur]) {
+            path[--at] = fg->ids[cur];
+        }
+        for (int cur = bw->link[meet]; cur != -1; cur = bw->link[cur]) {
+            path[len++] = fg->ids[cur];
+        }
+        *pathLength = len;
+    }
+    if (settled != NULL) *settled = settledCount;
+    return meet == -1 ? -1 : best;
+}
+
+int frozen_point_to_point(const FrozenGraph *fg, int source, int dest, int *path, int *pathLength, int *settled) {
+    if (fg == NULL) return -1;
+    
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int result = frozen_point_to_point_ctx(fg, qc, source, dest, path, pathLength, settled);
+    query_context_free(qc);
+    return result;
+}
+
+int point_to_point_path(Graph *g, int source, int dest, int *path, int *pathLength, int *settled) {
+    if (g == NULL) return -1;
+    
+    QueryContext *qc = graph_query_context(g);
+    if (qc == NULL) return -1;
+    return frozen_point_to_point_ctx(g->frozen, qc, source, dest, path, pathLength, settled);
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#ifndef ASTAR_H
+#define ASTAR_H
+
+#include "graph.h"
+
+int point_to_point_path(Graph *g, int source, int dest, int *path, int *pathLength, int *settled);
+int frozen_point_to_point(const FrozenGraph *fg, int source, int dest, int *path, int *pathLength, int *settled);
+int frozen_point_to_point_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int *path, int *pathLength, int *settled);
+
+#endif
\ No newline at end of file
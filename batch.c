@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "ksp.h"
+#include "batch.h"
+#include "workers.h"
+#include "reach.h"
+#include "stats.h"
+#include "query.h"
+#include "hublabel.h"
+
+// Queries are read in blocks; within a block workers claim fixed-size chunks
+// and format each chunk into its own buffer, so the buffers can be written
+// out in chunk order once the block is done.
+
+#define BATCH_BLOCK 16384
+#define BATCH_CHUNK 64
+#define LINE_SIZE 256
+
+// Building the hub labels costs about as much as a Dijkstra search from a
+// third of the cities (20k-city scale-free network: 7.5 s against about 1 ms
+// a search). Distance queries are searched until there have been that many,
+// so a batch with a few of them never waits for the labels.
+#define BATCH_LABEL_DIVISOR 3
+
+enum { QUERY_REACH, QUERY_SHORTEST, QUERY_ALTERNATE, QUERY_DISTANCE, QUERY_MALFORMED };
+
+static const char *queryNames[] = { "reach", "shortest", "alternate", "distance" };
+
+typedef struct {
+    int kind;
+    int source;
+    int dest;
+    int k;
+    int line;
+} BatchQuery;
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} OutBuffer;
+
+typedef struct {
+    const FrozenGraph *fg;
+    const ReachIndex *reach; // NULL falls back to a search per reach query
+    const HubLabels *labels; // NULL falls back to a search per distance query
+    const BatchQuery *queries;
+    int count;
+    OutBuffer *chunks;
+    atomic_int nextChunk;
+} BatchRound;
+
+static void out_reserve(OutBuffer *out, size_t extra) {
+    if (out->len + extra <= out->cap) return;
+    
+    size_t newCap = out->cap == 0 ? 4096 : out->cap * 2;
+    while (newCap < out->len + extra) newCap *= 2;
+    char *grown = realloc(out->data, newCap);
+    if (grown == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    out->data = grown;
+    out->cap = newCap;
+}
+
+static void out_printf(OutBuffer *out, const char *fmt, ...) {
+    va_list ap;
+    out_reserve(out, 64);
+    
+    va_start(ap, fmt);
+    int n = vsnprintf(out->data + out->len, out->cap - out->len, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    
+    if ((size_t)n >= out->cap - out->len) {
+        out_reserve(out, (size_t)n + 1);
+        va_start(ap, fmt);
+        vsnprintf(out->data + out->len, out->cap - out->len, fmt, ap);
+        va_end(ap);
+    }
+    out->len += (size_t)n;
+}
+
+static void out_path(OutBuffer *out, int distance, const int *cities, int length) {
+    out_printf(out, "\t%d\t", distance);
+    for (int i = 0; i < length; ++i) {
+        out_printf(out, "%s%d", i == 0 ? "" : ",", cities[i]);
+    }
+}
+
+static void answer_query(const BatchRound *round, QueryContext *qc, const BatchQuery *q, Itinerary *routes, OutBuffer *out) {
+    const FrozenGraph *fg = round->fg;
+    if (q->kind == QUERY_MALFORMED) {
+        out_printf(out, "error\t%d\tmalformed query\n", q->line);
+        return;
+    }
+    
+    out_printf(out, "%s\t%d\t%d", queryNames[q->kind], q->source, q->dest);
+    int sourceIdx = frozen_find_city(fg, q->source);
+    int destIdx = frozen_find_city(fg, q->dest);
+    if (sourceIdx == -1 || destIdx == -1) {
+        out_printf(out, "\terror\tunknown city\n");
+        return;
+    }
+    
+    if (q->kind == QUERY_REACH) {
+        STATS_BEGIN(scope);
+        int reachable = round->reach != NULL ? reach_query(round->reach, sourceIdx, destIdx)
+                                             : frozen_can_reach_ctx(fg, qc, q->source, q->dest);
+        STATS_END(scope, STATS_CAN_REACH);
+        out_printf(out, "\t%d\n", reachable);
+    } else if (q->kind == QUERY_DISTANCE) {
+        int length = 0;
+        int distance = round->labels != NULL ? hub_labels_distance_idx(round->labels, sourceIdx, destIdx)
+                                             : frozen_shortest_path_ctx(fg, qc, q->source, q->dest, qc->path, &length, NULL);
+        if (distance < 0) out_printf(out, "\tnone\n");
+        else out_printf(out, "\t%d\n", distance);
+    } else if (q->kind == QUERY_SHORTEST) {
+        int length = 0;
+        int distance = frozen_shortest_path_ctx(fg, qc, q->source, q->dest, qc->path, &length, NULL);
+        if (distance < 0) {
+            out_printf(out, "\tnone\n");
+        } else {
+            out_path(out, distance, qc->path, length);
+            out_printf(out, "\n");
+        }
+    } else {
+        STATS_BEGIN(scope);
+        int count = frozen_k_shortest_paths_ctx(fg, qc, q->source, q->dest, q->k, routes);
+        STATS_END(scope, STATS_ALTERNATE_ROUTE);
+        if (count < 0) {
+            out_printf(out, "\terror\tout of memory\n");
+        } else if (count == 0) {
+            out_printf(out, "\tnone\n");
+        } else {
+            for (int i = 0; i < count; ++i) {
+                out_path(out, routes[i].distance, routes[i].cities, routes[i].length);
+            }
+            out_printf(out, "\n");
+            free_itineraries(routes, count);
+        }
+    }
+}
+
+static void batch_worker(void *arg, int worker) {
+    BatchRound *round = arg;
+    (void)worker;
+    
+    // one workspace per worker for the whole round, so queries do not allocate
+    QueryContext *qc = query_context_create(round->fg->cityCount, round->fg->edgeCount);
+    Itinerary *routes = malloc(BATCH_MAX_ALTERNATES * sizeof(Itinerary));
+    if (qc == NULL || routes == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    int chunkCount = (round->count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    while (1) {
+        int c = atomic_fetch_add(&round->nextChunk, 1);
+        if (c >= chunkCount) break;
+        
+        OutBuffer *out = &round->chunks[c];
+        out->len = 0;
+        int end = (c + 1) * BATCH_CHUNK;
+        if (end > round->count) end = round->count;
+        for (int i = c * BATCH_CHUNK; i < end; ++i) {
+            answer_query(round, qc, &round->queries[i], routes, out);
+        }
+    }
+    
+    query_context_free(qc);
+    free(routes);
+}
+
+// returns 1 for a query (possibly malformed), 0 for a blank or comment line
+static int parse_query(const char *line, int lineNo, BatchQuery *q) {
+    while (isspace((unsigned char)*line)) line++;
+    if (*line == '\0' || *line == '#') return 0;
+    
+    char word[16];
+    int fields = sscanf(line, "%15s %d %d %d", word, &q->source, &q->dest, &q->k);
+    q->line = lineNo;
+    q->kind = QUERY_MALFORMED;
+    
+    if (fields == 3 && strcmp(word, "reach") == 0) {
+        q->kind = QUERY_REACH;
+    } else if (fields == 3 && strcmp(word, "shortest") == 0) {
+        q->kind = QUERY_SHORTEST;
+    } else if (fields == 3 && strcmp(word, "distance") == 0) {
+        q->kind = QUERY_DISTANCE;
+    } else if (fields >= 3 && strcmp(word, "alternate") == 0) {
+        if (fields == 3) q->k = BATCH_DEFAULT_ALTERNATES;
+        if (q->k >= 1 && q->k <= BATCH_MAX_ALTERNATES) q->kind = QUERY_ALTERNATE;
+    }
+    return 1;
+}
+
+static int read_block(FILE *in, BatchQuery *queries, int *lineNo) {
+    char line[LINE_SIZE];
+    int count = 0;
+    
+    while (count < BATCH_BLOCK && fgets(line, sizeof(line), in) != NULL) {
+        (*lineNo)++;
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            // overlong line: drop the rest of it and report it as malformed
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF);
+            queries[count].kind = QUERY_MALFORMED;
+            queries[count].line = *lineNo;
+            count++;
+            continue;
+        }
+        count += parse_query(line, *lineNo, &queries[count]);
+    }
+    return count;
+}
+
+int run_batch(const FrozenGraph *fg, FILE *in, FILE *out, int threads) {
+    if (fg == NULL || in == NULL || out == NULL) return -1;
+    
+    int chunkCount = (BATCH_BLOCK + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    BatchQuery *queries = malloc(BATCH_BLOCK * sizeof(BatchQuery));
+    OutBuffer *chunks = calloc(chunkCount, sizeof(OutBuffer));
+    if (queries == NULL || chunks == NULL) {
+        free(queries);
+        free(chunks);
+        return -1;
+    }
+    
+    ReachIndex *reach = reach_build(fg);
+    HubLabels *labels = NULL;
+    int labelsTried = 0;
+    long long distanceQueries = 0;
+    int answered = 0;
+    int lineNo = 0;
+    int count;
+    while ((count = read_block(in, queries, &lineNo)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            if (queries[i].kind == QUERY_DISTANCE) distanceQueries++;
+        }
+        if (!labelsTried && distanceQueries > 0 && distanceQueries >= fg->cityCount / BATCH_LABEL_DIVISOR) {
+            labels = frozen_hub_labels_build(fg);
+            labelsTried = 1;
+        }
+        
+        BatchRound round;
+        round.fg = fg;
+        round.reach = reach;
+        round.labels = labels;
+        round.queries = queries;
+        round.count = count;
+        round.chunks = chunks;
+        atomic_init(&round.nextChunk, 0);
+        
+        int used = (count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+        run_workers(threads < used ? threads : used, batch_worker, &round);
+        
+        for (int c = 0; c < used; ++c) {
+            fwrite(chunks[c].data, 1, chunks[c].len, out);
+        }
+        answered += count;
+    }
+    fflush(out);
+    
+    for (int c = 0; c < chunkCount; ++c) {
+        free(chunks[c].data);
+    }
+    free(chunks);
+    free(queries);
+    reach_free(reach);
+    hub_labels_free(labels);
+    return answered;
+}
\ No newline at end of file
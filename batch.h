@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "graph.h"
+
+// Reads one query per line from in and writes one tab-separated result line
+// per query to out, in input order:
+//   reach SRC DST          -> reach     SRC DST 1|0
+//   shortest SRC DST       -> shortest  SRC DST DISTANCE ID,ID,...
+//   alternate SRC DST [K]  -> alternate SRC DST DISTANCE ID,ID,... DISTANCE ID,ID,...
+//   distance SRC DST       -> distance  SRC DST DISTANCE
+// Unreachable pairs give "none", unknown cities "error\tunknown city", and
+// unparsable lines "error\tLINE\tmalformed query". Blank lines and lines
+// starting with '#' are skipped. Distance queries are answered by Dijkstra
+// searches until there have been a third as many as cities, then from hub
+// labels built at that block. Returns the number of queries answered.
+
+#define BATCH_DEFAULT_ALTERNATES 3
+#define BATCH_MAX_ALTERNATES 64
+
+int run_batch(const FrozenGraph *fg, FILE *in, FILE *out, int threads);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,1379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "netgen.h"
+#include "astar.h"
+#include "ch.h"
+#include "heap.h"
+#include "timetable.h"
+#include "query.h"
+#include "stats.h"
+#include "workers.h"
+#include "publish.h"
+#include "spt.h"
+#include "bfs.h"
+#include "landmark.h"
+#include "hublabel.h"
+#include "overlay.h"
+#include "sssp.h"
+
+// Benchmark harness: builds a seeded synthetic network, times each graph
+// operation call by call and reports percentiles and throughput, as a table
+// and optionally as JSON (one result per line, so runs diff cleanly between
+// commits). The checksum column is a digest of the answers, so a change that
+// alters results shows up next to a change that alters timings.
+//
+// bench.exe [--model hub|scale|regional] [--cities n] [--links m] [--hubs h] [--seed s]
+//           [--queries q] [--readers r] [--threads t] [--json file|-] [--verify]
+
+#define MAX_MISMATCH_REPORTS 10
+#define PUBLISH_ROUNDS 64 // edits the writer publishes while readers query
+#define TREE_HUBS 3 // best connected cities whose shortest path trees are maintained
+#define TREE_RECOMPUTE_SAMPLES 32
+#define BFS_RUNS 32 // whole-network and multi-source hop sweeps
+#define BFS_SOURCES 8
+#define SSSP_RUNS 16 // one-to-all searches, serial and delta-stepping, from the first query sources
+#define CH_RANDOM_PAIRS 2000 // extra random pairs ch_verify checks the contraction hierarchy on
+#define LABEL_RANDOM_PAIRS 2000 // extra random pairs the hub labels are checked on under --verify
+#define LANDMARK_EDITS 64 // removals and longer routes the landmark index must survive under --verify
+#define OVERLAY_REWEIGHTS 4 // rounds of new distances on every route, each followed by a customization
+#define OVERLAY_CLOSED_REWEIGHTS 1 // rounds of the --verify pass with every overlay cell closed
+
+typedef enum {
+    OP_BUILD,
+    OP_FREEZE,
+    OP_REACH_BUILD,
+    OP_CAN_REACH,
+    OP_SHORTEST,
+    OP_ALTERNATE,
+    OP_ASTAR,
+    OP_LANDMARK_BUILD,
+    OP_LANDMARK,
+    OP_LABEL_BUILD,
+    OP_LABEL_DISTANCE,
+    OP_OVERLAY_BUILD,
+    OP_OVERLAY_CUSTOMIZE,
+    OP_OVERLAY,
+    OP_BFS_NETWORK,
+    OP_BFS_HOPS,
+    OP_SSSP_SERIAL,
+    OP_SSSP_DELTA,
+    OP_TIMETABLE_BUILD,
+    OP_EARLIEST_ARRIVAL,
+    OP_PROFILE,
+    OP_PUBLISH,
+    OP_READ_UNDER_EDIT,
+    OP_ADD_ROUTE,
+    OP_REMOVE_ROUTE,
+    OP_HUB_ADD_ROUTE,
+    OP_HUB_REMOVE_ROUTE,
+    OP_TREE_BUILD,
+    OP_TREE_UPDATE,
+    OP_TREE_RECOMPUTE,
+    OP_COUNT
+} BenchOp;
+
+static const char *opNames[OP_COUNT] = {
+    "build", "freeze", "reach_build", "can_reach", "shortest_path", "alternate_route", "astar",
+    "landmark_build", "landmark", "label_build", "label_distance", "overlay_build", "overlay_customize",
+    "overlay", "bfs_network", "bfs_hops", "sssp_serial", "sssp_delta", "timetable_build",
+    "earliest_arrival", "profile", "publish", "read_under_edit", "add_route", "remove_route",
+    "hub_add_route", "hub_remove_route", "tree_build", "tree_update", "tree_recompute"
+};
+
+// by NetgenModel: the --model argument and the name printed for it
+static const char *modelArgs[] = {"hub", "scale", "regional"};
+static const char *modelNames[] = {"hub-and-spoke", "scale-free", "regional"};
+
+typedef struct {
+    double *samples; // microseconds per call
+    int count;
+    int cap;
+    long long checksum;
+    double p50, p90, p99, max, total;
+} OpStats;
+
+typedef struct {
+    int from; // city ids
+    int to;
+} QueryPair;
+
+static double now_us(void) {
+    static time_t base = 0; // keeps the double well inside its exact range
+    struct timespec t;
+    timespec_get(&t, TIME_UTC);
+    if (base == 0) base = t.tv_sec;
+    return (t.tv_sec - base) * 1e6 + t.tv_nsec / 1e3;
+}
+
+static void record(OpStats *s, double us) {
+    if (s->count == s->cap) {
+        s->cap = s->cap == 0 ? 1024 : s->cap * 2;
+        s->samples = realloc(s->samples, s->cap * sizeof(double));
+        if (s->samples == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    s->samples[s->count++] = us;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// nearest-rank percentile of sorted samples
+static double percentile(const double *sorted, int count, double pct) {
+    int rank = (int)(pct / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static void summarize(OpStats *s) {
+    if (s->count == 0) return;
+    
+    qsort(s->samples, s->count, sizeof(double), compare_doubles);
+    s->total = 0;
+    for (int i = 0; i < s->count; ++i) {
+        s->total += s->samples[i];
+    }
+    s->p50 = percentile(s->samples, s->count, 50);
+    s->p90 = percentile(s->samples, s->count, 90);
+    s->p99 = percentile(s->samples, s->count, 99);
+    s->max = s->samples[s->count - 1];
+}
+
+static void print_table(const OpStats *stats) {
+    printf("%-16s %8s %12s %12s %10s %10s %10s %10s %14s\n",
+           "operation", "count", "total ms", "ops/s", "p50 us", "p90 us", "p99 us", "max us", "checksum");
+    for (int op = 0; op < OP_COUNT; ++op) {
+        const OpStats *s = &stats[op];
+        if (s->count == 0) continue;
+        printf("%-16s %8d %12.3f %12.0f %10.2f %10.2f %10.2f %10.2f %14lld\n",
+               opNames[op], s->count, s->total / 1e3, s->total > 0 ? s->count * 1e6 / s->total : 0.0,
+               s->p50, s->p90, s->p99, s->max, s->checksum);
+    }
+}
+
+static int write_json(const char *path, const NetgenParams *p, const Graph *g, long long routes,
+                      int queries, const OpStats *stats) {
+    FILE *fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (fp == NULL) return -1;
+    
+    fprintf(fp, "{\"model\": \"%s\", \"cities\": %d, \"routes\": %lld, \"links\": %d, \"seed\": %llu, \"queries\": %d,\n",
+            modelArgs[p->model], g->cityCount, routes, p->linksPerCity,
+            (unsigned long long)p->seed, queries);
+    fprintf(fp, " \"results\": [\n");
+    int first = 1;
+    for (int op = 0; op < OP_COUNT; ++op) {
+        const OpStats *s = &stats[op];
+        if (s->count == 0) continue;
+        fprintf(fp, "%s  {\"op\": \"%s\", \"count\": %d, \"total_ms\": %.3f, \"ops_per_sec\": %.1f, "
+                "\"p50_us\": %.2f, \"p90_us\": %.2f, \"p99_us\": %.2f, \"max_us\": %.2f, \"checksum\": %lld}",
+                first ? "" : ",\n", opNames[op], s->count, s->total / 1e3,
+                s->total > 0 ? s->count * 1e6 / s->total : 0.0, s->p50, s->p90, s->p99, s->max, s->checksum);
+        first = 0;
+    }
+    fprintf(fp, "\n ]}\n");
+    
+    if (fp != stdout) fclose(fp);
+    return 0;
+}
+
+// distance of a path of city ids, or -1 if it uses a route that does not exist
+static long long path_distance(const FrozenGraph *fg, const int *path, int length) {
+    long long total = 0;
+    for (int i = 0; i + 1 < length; ++i) {
+        int u = frozen_find_city(fg, path[i]);
+        int v = frozen_find_city(fg, path[i + 1]);
+        if (u == -1 || v == -1) return -1;
+        
+        int found = -1;
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            if (fg->edges[e].dest == v) {
+                found = fg->edges[e].distance;
+                break;
+            }
+        }
+        if (found == -1) return -1;
+        total += found;
+    }
+    return total;
+}
+
+static int check_path(const FrozenGraph *fg, int from, int to, int dist, const int *path, int length) {
+    if (dist < 0) return 1;
+    if (length < 1 || path[0] != from || path[length - 1] != to) return 0;
+    return path_distance(fg, path, length) == dist;
+}
+
+static void report_mismatch(int *mismatches, int from, int to, const char *what, int got, int want) {
+    if (++*mismatches <= MAX_MISMATCH_REPORTS) {
+        fprintf(stderr, "verify: %d -> %d: %s gave %d, expected %d\n", from, to, what, got, want);
+    }
+}
+
+// cross-checks every engine against plain Dijkstra on the query pairs, returns the mismatch count
+static int verify_engines(Graph *g, const QueryPair *pairs, int count) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    ContractionHierarchy *ch = frozen_ch_build(fg);
+    int *path = malloc(fg->cityCount * sizeof(int));
+    int *other = malloc(fg->cityCount * sizeof(int));
+    if (qc == NULL || ch == NULL || path == NULL || other == NULL) {
+        fprintf(stderr, "verify: could not set up the engines\n");
+        query_context_free(qc);
+        ch_free(ch);
+        free(path);
+        free(other);
+        return 1;
+    }
+    
+    int mismatches = 0;
+    for (int q = 0; q < count; ++q) {
+        int from = pairs[q].from;
+        int to = pairs[q].to;
+        int length = 0;
+        int otherLength = 0;
+        
+        int want = frozen_shortest_path_ctx(fg, qc, from, to, path, &length, NULL);
+        if (!check_path(fg, from, to, want, path, length)) {
+            report_mismatch(&mismatches, from, to, "dijkstra path", (int)path_distance(fg, path, length), want);
+        }
+        
+        int reach = can_reach(g, from, to);
+        if (reach != (want >= 0)) report_mismatch(&mismatches, from, to, "can_reach", reach, want >= 0);
+        int bfs = frozen_can_reach_ctx(fg, qc, from, to);
+        if (bfs != (want >= 0)) report_mismatch(&mismatches, from, to, "bfs", bfs, want >= 0);
+        
+        int got = frozen_point_to_point_ctx(fg, qc, from, to, other, &otherLength, NULL);
+        if (got != want) report_mismatch(&mismatches, from, to, "astar", got, want);
+        else if (!check_path(fg, from, to, got, other, otherLength)) report_mismatch(&mismatches, from, to, "astar path", -1, want);
+        
+        got = ch_shortest_path_ctx(ch, qc, from, to, other, &otherLength, NULL);
+        if (got != want) report_mismatch(&mismatches, from, to, "ch", got, want);
+        else if (!check_path(fg, from, to, got, other, otherLength)) report_mismatch(&mismatches, from, to, "ch path", -1, want);
+        
+        if (want >= 0) {
+            got = frozen_alternate_route_ctx(fg, qc, from, to, other, &otherLength, path, length);
+            if (got >= 0 && (got < want || !check_path(fg, from, to, got, other, otherLength))) {
+                report_mismatch(&mismatches, from, to, "alternate", got, want);
+            }
+        }
+    }
+    
+    printf("verify: %d pairs checked, %d mismatches\n", count, mismatches);
+    int chMismatches = ch_verify(ch, fg, CH_RANDOM_PAIRS, 1);
+    printf("verify: contraction hierarchy checked on %d random pairs, %d mismatches\n", CH_RANDOM_PAIRS, chMismatches);
+    mismatches += chMismatches < 0 ? 1 : chMismatches;
+    query_context_free(qc);
+    ch_free(ch);
+    free(path);
+    free(other);
+    return mismatches;
+}
+
+// time-dependent Dijkstra over the connections, valid while every flight has a single leg
+static int reference_arrival(const Timetable *tt, const int *byCity, const int *cityStart,
+                             IndexedHeap *heap, int *arrival, int s, int t, int departAfter) {
+    for (int v = 0; v < tt->cityCount; ++v) {
+        arrival[v] = INT_MAX;
+    }
+    heap_clear(heap);
+    arrival[s] = departAfter;
+    heap_push_or_decrease(heap, s, departAfter);
+    
+    while (!heap_empty(heap)) {
+        int at;
+        int v = heap_pop_min(heap, &at);
+        if (v == t) return at;
+        
+        int ready = v == s ? at : at + tt->minTransfer;
+        for (int k = cityStart[v]; k < cityStart[v + 1]; ++k) {
+            const Connection *c = &tt->connections[byCity[k]];
+            if (c->departure >= ready && c->arrival < arrival[c->to]) {
+                arrival[c->to] = c->arrival;
+                heap_push_or_decrease(heap, c->to, c->arrival);
+            }
+        }
+    }
+    return -1;
+}
+
+// checks earliest arrival against the reference and every profile entry against earliest arrival
+static int verify_timetable(const Timetable *tt, const QueryPair *pairs, const int *departures, int count) {
+    int n = tt->cityCount;
+    int *cityStart = calloc(n + 1, sizeof(int));
+    int *byCity = malloc((tt->connectionCount > 0 ? tt->connectionCount : 1) * sizeof(int));
+    int *arrival = malloc(n * sizeof(int));
+    JourneyLeg *legs = malloc(n * sizeof(JourneyLeg));
+    TimetableQuery *tq = timetable_query_create(tt);
+    IndexedHeap heap;
+    if (cityStart == NULL || byCity == NULL || arrival == NULL || legs == NULL || tq == NULL ||
+        heap_init(&heap, n) != 0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < tt->connectionCount; ++i) {
+        cityStart[tt->connections[i].from + 1]++;
+    }
+    for (int v = 0; v < n; ++v) {
+        cityStart[v + 1] += cityStart[v];
+    }
+    int *fill = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (fill == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(fill, cityStart, n * sizeof(int));
+    for (int i = 0; i < tt->connectionCount; ++i) {
+        byCity[fill[tt->connections[i].from]++] = i;
+    }
+    free(fill);
+    
+    int mismatches = 0;
+    for (int q = 0; q < count; ++q) {
+        int from = pairs[q].from;
+        int to = pairs[q].to;
+        int s = id_index_find(&tt->index, from);
+        int t = id_index_find(&tt->index, to);
+        int legCount = 0;
+        
+        int want = reference_arrival(tt, byCity, cityStart, &heap, arrival, s, t, departures[q]);
+        int got = timetable_earliest_arrival(tt, tq, from, to, departures[q], legs, &legCount);
+        if (got != want) {
+            report_mismatch(&mismatches, from, to, "earliest arrival", got, want);
+            continue;
+        }
+        
+        // the legs must chain from the source to the destination and respect the transfer time
+        int ready = departures[q];
+        int at = from;
+        for (int i = 0; i < legCount && got >= 0 && s != t; ++i) {
+            if (legs[i].from != at || legs[i].departure < ready) {
+                report_mismatch(&mismatches, from, to, "journey leg", i, legCount);
+                break;
+            }
+            at = legs[i].to;
+            ready = legs[i].arrival + tt->minTransfer;
+        }
+        if (got >= 0 && s != t && (legCount == 0 || at != to || legs[legCount - 1].arrival != got)) {
+            report_mismatch(&mismatches, from, to, "journey end", legCount > 0 ? legs[legCount - 1].arrival : -1, got);
+        }
+        
+        if (s == t) continue;
+        ProfileEntry *entries;
+        int entryCount = timetable_profile(tt, from, to, 0, MINUTES_PER_DAY, &entries);
+        for (int i = 0; i < entryCount; ++i) {
+            int direct = timetable_earliest_arrival(tt, tq, from, to, entries[i].departure, NULL, NULL);
+            int after = timetable_earliest_arrival(tt, tq, from, to, entries[i].departure + 1, NULL, NULL);
+            int next = i + 1 < entryCount ? entries[i + 1].arrival : -1;
+            if (direct != entries[i].arrival) report_mismatch(&mismatches, from, to, "profile entry", entries[i].arrival, direct);
+            else if (after != next) report_mismatch(&mismatches, from, to, "profile gap", next, after);
+        }
+        if (entryCount == 0 && timetable_earliest_arrival(tt, tq, from, to, 0, NULL, NULL) != -1) {
+            report_mismatch(&mismatches, from, to, "empty profile", -1, 0);
+        }
+        free(entries);
+    }
+    
+    printf("verify: %d timetable queries checked, %d mismatches\n", count, mismatches);
+    heap_free(&heap);
+    timetable_query_free(tq);
+    free(cityStart);
+    free(byCity);
+    free(arrival);
+    free(legs);
+    return mismatches;
+}
+
+// plain Dijkstra over the graph's own edge lists, the reference for the maintained trees
+static void reference_tree(const Graph *g, IndexedHeap *heap, int *dist, int s) {
+    for (int v = 0; v < g->cityCount; ++v) {
+        dist[v] = MAX_DISTANCE;
+    }
+    heap_clear(heap);
+    dist[s] = 0;
+    heap_push_or_decrease(heap, s, 0);
+    
+    while (!heap_empty(heap)) {
+        int d;
+        int u = heap_pop_min(heap, &d);
+        const City *c = &g->cities[u];
+        for (int e = 0; e < c->edgeCount; ++e) {
+            int v = id_index_find(&g->index, c->edges[e].destId);
+            if (v != -1 && d + c->edges[e].distance < dist[v]) {
+                dist[v] = d + c->edges[e].distance;
+                heap_push_or_decrease(heap, v, dist[v]);
+            }
+        }
+    }
+}
+
+static int route_distance(const Graph *g, int from, int to) {
+    const City *c = &g->cities[from];
+    for (int e = 0; e < c->edgeCount; ++e) {
+        if (c->edges[e].destId == g->cities[to].id) return c->edges[e].distance;
+    }
+    return -1;
+}
+
+// every tracked tree against a recomputation: distances, and each tree route must exist and be tight
+static int verify_trees(const Graph *g, IndexedHeap *heap, int *dist) {
+    int mismatches = 0;
+    for (int i = 0; i < g->trees->treeCount; ++i) {
+        const ShortestPathTree *t = g->trees->trees[i];
+        int source = g->cities[t->source].id;
+        reference_tree(g, heap, dist, t->source);
+        
+        for (int v = 0; v < g->cityCount; ++v) {
+            int want = dist[v] == MAX_DISTANCE ? -1 : dist[v];
+            int got = t->dist[v] == MAX_DISTANCE ? -1 : t->dist[v];
+            if (got != want) {
+                report_mismatch(&mismatches, source, g->cities[v].id, "maintained tree", got, want);
+                continue;
+            }
+            
+            int p = t->parent[v];
+            if (p == -1) {
+                if (v != t->source && got >= 0) report_mismatch(&mismatches, source, g->cities[v].id, "tree parent", -1, want);
+                continue;
+            }
+            int w = route_distance(g, p, v);
+            if (w < 0 || t->dist[p] + w != t->dist[v]) {
+                report_mismatch(&mismatches, source, g->cities[v].id, "tree route", w < 0 ? -1 : t->dist[p] + w, want);
+            }
+        }
+    }
+    return mismatches;
+}
+
+static long long tree_digest(const HubTrees *ht, int cityCount) {
+    long long sum = 0;
+    for (int i = 0; i < ht->treeCount; ++i) {
+        for (int v = 0; v < cityCount; ++v) {
+            if (ht->trees[i]->dist[v] != MAX_DISTANCE) sum += ht->trees[i]->dist[v];
+        }
+    }
+    return sum;
+}
+
+// the k cities with the most routes, best first; returns how many were found
+static int best_connected(const Graph *g, int *hubs, int k) {
+    int count = 0;
+    for (int v = 0; v < g->cityCount; ++v) {
+        if (count < k) hubs[count++] = v;
+        else if (g->cities[v].edgeCount > g->cities[hubs[k - 1]].edgeCount) hubs[k - 1] = v;
+        else continue;
+        
+        for (int i = count - 1; i > 0 && g->cities[hubs[i - 1]].edgeCount < g->cities[hubs[i]].edgeCount; --i) {
+            int tmp = hubs[i];
+            hubs[i] = hubs[i - 1];
+            hubs[i - 1] = tmp;
+        }
+    }
+    return count;
+}
+
+// serial queue BFS, the reference for the parallel kernel
+static void reference_hops(const FrozenGraph *fg, const int *sources, int count, int maxHops, int *hops, int *queue) {
+    int front = 0, rear = 0;
+    for (int v = 0; v < fg->cityCount; ++v) {
+        hops[v] = -1;
+    }
+    for (int i = 0; i < count; ++i) {
+        int s = frozen_find_city(fg, sources[i]);
+        if (hops[s] == -1) {
+            hops[s] = 0;
+            queue[rear++] = s;
+        }
+    }
+    while (front < rear) {
+        int u = queue[front++];
+        if (maxHops >= 0 && hops[u] >= maxHops) continue;
+        
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            int v = fg->edges[e].dest;
+            if (hops[v] == -1) {
+                hops[v] = hops[u] + 1;
+                queue[rear++] = v;
+            }
+        }
+    }
+}
+
+// whole-network reachability from single cities, then what the best connected cities reach
+// within 1-3 hops; returns the mismatch count against a serial BFS
+static int run_bfs(Graph *g, const QueryPair *pairs, int queries, int threads, int verify, OpStats *stats) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    ParallelBfs *b = bfs_create(fg, threads);
+    int *hops = malloc(fg->cityCount * sizeof(int));
+    int *queue = malloc(fg->cityCount * sizeof(int));
+    if (b == NULL || hops == NULL || queue == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    
+    int hubs[BFS_SOURCES];
+    int sources[BFS_SOURCES];
+    int sourceCount = best_connected(g, hubs, BFS_SOURCES);
+    for (int i = 0; i < sourceCount; ++i) {
+        sources[i] = g->cities[hubs[i]].id;
+    }
+    
+    int mismatches = 0;
+    int runs = queries < BFS_RUNS ? queries : BFS_RUNS;
+    for (int r = 0; r < 2 * runs; ++r) {
+        int multi = r >= runs;
+        const int *from = multi ? sources : &pairs[r].from;
+        int count = multi ? sourceCount : 1;
+        int maxHops = multi ? 1 + r % 3 : BFS_UNLIMITED;
+        
+        double t = now_us();
+        int reached = bfs_run(b, from, count, maxHops);
+        record(&stats[multi ? OP_BFS_HOPS : OP_BFS_NETWORK], now_us() - t);
+        stats[multi ? OP_BFS_HOPS : OP_BFS_NETWORK].checksum += reached;
+        
+        if (!verify) continue;
+        reference_hops(fg, from, count, maxHops, hops, queue);
+        for (int v = 0; v < fg->cityCount; ++v) {
+            if (b->hops[v] != hops[v] || bfs_reached(b, v) != (hops[v] >= 0)) {
+                report_mismatch(&mismatches, from[0], fg->ids[v], multi ? "bfs hops" : "bfs network", b->hops[v], hops[v]);
+            }
+        }
+    }
+    if (verify) printf("verify: %d parallel BFS runs checked, %d mismatches\n", 2 * runs, mismatches);
+    
+    bfs_free(b);
+    free(hops);
+    free(queue);
+    return mismatches;
+}
+
+// routes out of the best connected city: the duplicate check and removal scan its whole route list
+// unless the city indexes its destinations
+// landmark queries next to the cities plain Dijkstra settles for the same pairs
+static int compare_landmarks(Graph *g, QueryContext *qc, const QueryPair *pairs, int queries, int verify,
+                             OpStats *stats, int *path, int *other) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    long long altSettled = 0;
+    long long dijkstraSettled = 0;
+    int mismatches = 0;
+    
+    for (int q = 0; q < queries; ++q) {
+        int from = pairs[q].from;
+        int to = pairs[q].to;
+        int length = 0;
+        int otherLength = 0;
+        int settled = 0;
+        
+        double t = now_us();
+        int dist = landmark_shortest_path(g, from, to, path, &length, &settled);
+        if (stats != NULL) {
+            record(&stats[OP_LANDMARK], now_us() - t);
+            if (dist >= 0) stats[OP_LANDMARK].checksum += dist;
+        }
+        altSettled += settled;
+        
+        int want = frozen_shortest_path_ctx(fg, qc, from, to, other, &otherLength, &settled);
+        dijkstraSettled += settled;
+        if (!verify) continue;
+        if (dist != want) report_mismatch(&mismatches, from, to, "landmark", dist, want);
+        else if (!check_path(fg, from, to, dist, path, length)) report_mismatch(&mismatches, from, to, "landmark path", -1, want);
+    }
+    if (stats != NULL && queries > 0) {
+        printf("landmarks: %.1f cities settled per query, plain Dijkstra %.1f\n",
+               (double)altSettled / queries, (double)dijkstraSettled / queries);
+    }
+    return mismatches;
+}
+
+// Builds the landmark index and times its queries. Under --verify the answers
+// are also checked after removing and lengthening routes, which keep the
+// index; the routes are restored afterwards.
+static int run_landmarks(Graph *g, const QueryPair *pairs, int queries, int verify, OpStats *stats) {
+    double t = now_us();
+    const LandmarkIndex *li = graph_landmarks(g);
+    record(&stats[OP_LANDMARK_BUILD], now_us() - t);
+    const FrozenGraph *fg = graph_snapshot(g);
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int *path = malloc(fg->cityCount * sizeof(int));
+    int *other = malloc(fg->cityCount * sizeof(int));
+    RouteSpec *undo = malloc(LANDMARK_EDITS * sizeof(RouteSpec));
+    if (li == NULL || qc == NULL || path == NULL || other == NULL || undo == NULL) {
+        fprintf(stderr, "Could not build the landmark index\n");
+        exit(1);
+    }
+    stats[OP_LANDMARK_BUILD].checksum = li->landmarkCount;
+    
+    int mismatches = compare_landmarks(g, qc, pairs, queries, verify, stats, path, other);
+    if (!verify) {
+        query_context_free(qc);
+        free(path);
+        free(other);
+        free(undo);
+        return 0;
+    }
+    
+    int edits = 0;
+    for (int q = 0; q < queries && edits < LANDMARK_EDITS; ++q) {
+        City *c = &g->cities[find_city_index(g, pairs[q].from)];
+        if (c->edgeCount == 0) continue;
+        
+        undo[edits].from = c->id;
+        undo[edits].to = c->edges[0].destId;
+        undo[edits].distance = c->edges[0].distance;
+        if (edits % 2 == 0) graph_remove_route(g, undo[edits].from, undo[edits].to);
+        else graph_set_route_distance(g, undo[edits].from, undo[edits].to, 2 * undo[edits].distance + 1);
+        edits++;
+    }
+    if (graph_landmarks(g) != li) {
+        fprintf(stderr, "verify: removals and longer routes dropped the landmark index\n");
+        mismatches++;
+    }
+    mismatches += compare_landmarks(g, qc, pairs, queries, verify, NULL, path, other);
+    printf("verify: %d landmark queries checked, again after %d removals and longer routes, %d mismatches\n",
+           queries, edits, mismatches);
+    
+    // newest first, in case one route was edited twice
+    for (int i = edits - 1; i >= 0; --i) {
+        if (graph_set_route_distance(g, undo[i].from, undo[i].to, undo[i].distance) == ROUTE_NOT_FOUND) {
+            graph_add_route(g, undo[i].from, undo[i].to, undo[i].distance);
+        }
+    }
+    query_context_free(qc);
+    free(path);
+    free(other);
+    free(undo);
+    return mismatches;
+}
+
+// Builds the hub labels and times distance lookups on the query pairs. Under
+// --verify every answer, and those for LABEL_RANDOM_PAIRS more random pairs,
+// must equal dijkstra_shortest_path exactly.
+static int run_labels(Graph *g, const QueryPair *pairs, int queries, uint64_t seed, int verify, OpStats *stats) {
+    double t = now_us();
+    HubLabels *hl = hub_labels_build(g);
+    record(&stats[OP_LABEL_BUILD], now_us() - t);
+    int *path = malloc(g->cityCount * sizeof(int));
+    if (hl == NULL || path == NULL) {
+        fprintf(stderr, "Could not build the hub labels\n");
+        exit(1);
+    }
+    stats[OP_LABEL_BUILD].checksum = hl->entries;
+    printf("hub labels: %.1f entries per city (out and in)\n", hl->cityCount > 0 ? (double)hl->entries / hl->cityCount : 0.0);
+    
+    for (int q = 0; q < queries; ++q) {
+        t = now_us();
+        int dist = hub_labels_distance(hl, pairs[q].from, pairs[q].to);
+        record(&stats[OP_LABEL_DISTANCE], now_us() - t);
+        if (dist >= 0) stats[OP_LABEL_DISTANCE].checksum += dist;
+    }
+    
+    int mismatches = 0;
+    if (verify) {
+        NetgenRng rng;
+        netgen_rng_seed(&rng, seed ^ 0x9E3779B97F4A7C15ULL);
+        for (int q = 0; q < queries + LABEL_RANDOM_PAIRS; ++q) {
+            int from = q < queries ? pairs[q].from : g->cities[netgen_rng_below(&rng, g->cityCount)].id;
+            int to = q < queries ? pairs[q].to : g->cities[netgen_rng_below(&rng, g->cityCount)].id;
+            int length = 0;
+            int want = dijkstra_shortest_path(g, from, to, path, &length);
+            int got = hub_labels_distance(hl, from, to);
+            if (got != want) report_mismatch(&mismatches, from, to, "hub labels", got, want);
+        }
+        printf("verify: %d hub label distances checked against Dijkstra, %d mismatches\n",
+               queries + LABEL_RANDOM_PAIRS, mismatches);
+    }
+    hub_labels_free(hl);
+    free(path);
+    return mismatches;
+}
+
+// times the overlay's queries on the query pairs; under --verify they must match Dijkstra
+static int compare_overlay(const Overlay *ov, const FrozenGraph *fg, QueryContext *qc, const QueryPair *pairs,
+                           int queries, int verify, OpStats *stats, int *path, int *other) {
+    int mismatches = 0;
+    for (int q = 0; q < queries; ++q) {
+        int from = pairs[q].from;
+        int to = pairs[q].to;
+        int length = 0;
+        int otherLength = 0;
+        double t = now_us();
+        int dist = overlay_shortest_path_ctx(ov, qc, from, to, path, &length, NULL);
+        record(&stats[OP_OVERLAY], now_us() - t);
+        if (dist >= 0) stats[OP_OVERLAY].checksum += dist;
+        if (!verify) continue;
+        
+        int want = frozen_shortest_path_ctx(fg, qc, from, to, other, &otherLength, NULL);
+        if (dist != want) report_mismatch(&mismatches, from, to, "overlay", dist, want);
+        else if (!check_path(fg, from, to, dist, path, length)) report_mismatch(&mismatches, from, to, "overlay path", -1, want);
+    }
+    return mismatches;
+}
+
+// One-to-all searches from the first query sources, by serial Dijkstra and
+// by delta-stepping on at least two threads, whatever the network's size.
+// Under --verify the distances must agree and every predecessor must lie on
+// a shortest path.
+static int run_sssp(Graph *g, const QueryPair *pairs, int queries, int threads, int verify, OpStats *stats) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    DeltaStepping *serial = sssp_create(fg, 1, SSSP_AUTO_DELTA);
+    DeltaStepping *ds = sssp_create(fg, threads > 1 ? threads : 2, SSSP_AUTO_DELTA);
+    if (serial == NULL || ds == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    serial->serialCities = INT_MAX;
+    ds->serialCities = 0;
+    
+    int mismatches = 0;
+    long long phases = 0;
+    int runs = queries < SSSP_RUNS ? queries : SSSP_RUNS;
+    for (int r = 0; r < runs; ++r) {
+        double t = now_us();
+        int reached = sssp_run(serial, pairs[r].from);
+        record(&stats[OP_SSSP_SERIAL], now_us() - t);
+        stats[OP_SSSP_SERIAL].checksum += reached;
+        
+        t = now_us();
+        reached = sssp_run(ds, pairs[r].from);
+        record(&stats[OP_SSSP_DELTA], now_us() - t);
+        stats[OP_SSSP_DELTA].checksum += reached;
+        phases += ds->phases;
+        
+        if (!verify) continue;
+        for (int v = 0; v < fg->cityCount; ++v) {
+            int p = ds->pred[v];
+            int ok = ds->dist[v] == serial->dist[v];
+            if (ok && p != -1) {
+                ok = 0;
+                for (int e = fg->offsets[p]; e < fg->offsets[p + 1]; ++e) {
+                    if (fg->edges[e].dest == v && ds->dist[p] + fg->edges[e].distance == ds->dist[v]) ok = 1;
+                }
+            } else if (ok) {
+                ok = ds->dist[v] == 0 || ds->dist[v] == MAX_DISTANCE;
+            }
+            if (!ok) report_mismatch(&mismatches, pairs[r].from, fg->ids[v], "delta-stepping", ds->dist[v], serial->dist[v]);
+        }
+    }
+    if (runs > 0) printf("delta-stepping: delta %d km, %.1f light phases per search\n", ds->delta, (double)phases / runs);
+    if (verify) printf("verify: %d delta-stepping searches checked, %d mismatches\n", runs, mismatches);
+    
+    sssp_free(serial);
+    sssp_free(ds);
+    return mismatches;
+}
+
+// Partitions the network once, then customizes the overlay for the current
+// distances and for `rounds` rounds of new distances on every route (each
+// within 20% of the original), timing the queries after each. The original
+// distances are restored afterwards.
+static int run_overlay(Graph *g, const QueryPair *pairs, int queries, int threads, uint64_t seed, int cliqueFactor,
+                       int rounds, int verify, OpStats *stats) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    double t = now_us();
+    Overlay *ov = overlay_build(fg, cliqueFactor);
+    record(&stats[OP_OVERLAY_BUILD], now_us() - t);
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int *path = malloc(fg->cityCount * sizeof(int));
+    int *other = malloc(fg->cityCount * sizeof(int));
+    int *original = malloc((fg->edgeCount > 0 ? fg->edgeCount : 1) * sizeof(int));
+    if (ov == NULL || qc == NULL || path == NULL || other == NULL || original == NULL) {
+        fprintf(stderr, "Could not build the overlay\n");
+        exit(1);
+    }
+    stats[OP_OVERLAY_BUILD].checksum = overlay_matrix_entries(ov);
+    int cells = 0;
+    int closed = 0;
+    for (int l = 0; l < ov->levelCount; ++l) {
+        for (int c = 0; c < ov->levels[l].cellCount; ++c) {
+            cells++;
+            closed += ov->levels[l].closed[c];
+        }
+    }
+    printf("overlay: %d of %d cells closed, %lld entry-to-exit distances over %d levels\n",
+           closed, cells, overlay_matrix_entries(ov), ov->levelCount);
+    
+    // route k in city order is the k-th edge of the snapshot
+    int k = 0;
+    for (int i = 0; i < g->cityCount; ++i) {
+        for (int e = 0; e < g->cities[i].edgeCount; ++e) {
+            original[k++] = g->cities[i].edges[e].distance;
+        }
+    }
+    
+    NetgenRng rng;
+    netgen_rng_seed(&rng, seed ^ 0xD1B54A32D192ED03ULL);
+    int mismatches = 0;
+    for (int round = 0; round <= rounds; ++round) {
+        if (round > 0) {
+            k = 0;
+            for (int i = 0; i < g->cityCount; ++i) {
+                City *c = &g->cities[i];
+                for (int e = 0; e < c->edgeCount; ++e) {
+                    int distance = (int)((long long)original[k++] * (80 + netgen_rng_below(&rng, 41)) / 100);
+                    graph_set_route_distance(g, c->id, c->edges[e].destId, distance > 0 ? distance : 1);
+                }
+            }
+            fg = graph_snapshot(g);
+        }
+        
+        t = now_us();
+        int failed = overlay_customize(ov, fg, threads) != 0;
+        record(&stats[OP_OVERLAY_CUSTOMIZE], now_us() - t);
+        if (failed) {
+            fprintf(stderr, "The overlay no longer fits the network\n");
+            exit(1);
+        }
+        mismatches += compare_overlay(ov, fg, qc, pairs, queries, verify, stats, path, other);
+    }
+    if (verify) {
+        printf("verify: %d overlay queries checked under %d sets of distances%s, %d mismatches\n", queries,
+               rounds + 1, cliqueFactor == OVERLAY_ALL_CLOSED ? " with every cell closed" : "", mismatches);
+    }
+    
+    k = 0;
+    for (int i = 0; i < g->cityCount; ++i) {
+        City *c = &g->cities[i];
+        for (int e = 0; e < c->edgeCount; ++e) {
+            graph_set_route_distance(g, c->id, c->edges[e].destId, original[k++]);
+        }
+    }
+    overlay_free(ov);
+    query_context_free(qc);
+    free(path);
+    free(other);
+    free(original);
+    return mismatches;
+}
+
+static void run_hub_edits(Graph *g, int edits, uint64_t seed, OpStats *stats) {
+    int hub;
+    if (best_connected(g, &hub, 1) < 1) return;
+    
+    int *targets = malloc(edits * sizeof(int));
+    if (targets == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    NetgenRng rng;
+    netgen_rng_seed(&rng, seed ^ 0x94D049BB133111EBULL);
+    int from = g->cities[hub].id;
+    
+    int added = 0;
+    for (int e = 0; e < edits; ++e) {
+        int to = g->cities[netgen_rng_below(&rng, g->cityCount)].id;
+        double t = now_us();
+        int result = graph_add_route(g, from, to, 1 + netgen_rng_below(&rng, 5000));
+        record(&stats[OP_HUB_ADD_ROUTE], now_us() - t);
+        if (result == ROUTE_OK) targets[added++] = to;
+    }
+    stats[OP_HUB_ADD_ROUTE].checksum = added;
+    
+    // take them out in a different order than they went in
+    for (int i = added - 1; i > 0; --i) {
+        int j = netgen_rng_below(&rng, i + 1);
+        int tmp = targets[i];
+        targets[i] = targets[j];
+        targets[j] = tmp;
+    }
+    for (int i = 0; i < added; ++i) {
+        double t = now_us();
+        int result = graph_remove_route(g, from, targets[i]);
+        record(&stats[OP_HUB_REMOVE_ROUTE], now_us() - t);
+        stats[OP_HUB_REMOVE_ROUTE].checksum += result == ROUTE_OK;
+    }
+    free(targets);
+}
+
+// tracks the best connected cities, then times a seeded mix of route additions,
+// removals and distance changes that each update the trees; returns the mismatch count
+static int run_trees(Graph *g, int edits, uint64_t seed, int verify, OpStats *stats) {
+    int n = g->cityCount;
+    int hubs[TREE_HUBS];
+    int hubCount = best_connected(g, hubs, TREE_HUBS);
+    
+    for (int h = 0; h < hubCount; ++h) {
+        double t = now_us();
+        const ShortestPathTree *tree = graph_track_source(g, g->cities[hubs[h]].id);
+        record(&stats[OP_TREE_BUILD], now_us() - t);
+        if (tree == NULL) {
+            fprintf(stderr, "Could not build the shortest path tree from %d\n", g->cities[hubs[h]].id);
+            exit(1);
+        }
+    }
+    stats[OP_TREE_BUILD].checksum = tree_digest(g->trees, n);
+    
+    IndexedHeap heap;
+    int *dist = malloc(n * sizeof(int));
+    if (dist == NULL || heap_init(&heap, n) != 0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    
+    NetgenRng rng;
+    netgen_rng_seed(&rng, seed ^ 0xD1B54A32D192ED03ULL);
+    const ShortestPathTree *first = g->trees->trees[0];
+    int mismatches = 0;
+    int checked = 0;
+    for (int e = 0; e < edits; ++e) {
+        int kind = netgen_rng_below(&rng, 3);
+        int from = netgen_rng_below(&rng, n);
+        int to = netgen_rng_below(&rng, n);
+        int result;
+        double t;
+        
+        if (kind == 0) {
+            int distance = 1 + netgen_rng_below(&rng, 5000);
+            t = now_us();
+            result = graph_add_route(g, g->cities[from].id, g->cities[to].id, distance);
+        } else {
+            // half of the removals and changes hit a route of the first tree
+            if (first->parent[to] != -1 && netgen_rng_below(&rng, 2) == 0) {
+                from = first->parent[to];
+            } else if (g->cities[from].edgeCount > 0) {
+                to = id_index_find(&g->index, g->cities[from].edges[netgen_rng_below(&rng, g->cities[from].edgeCount)].destId);
+            } else {
+                continue;
+            }
+            int old = route_distance(g, from, to);
+            int distance = 1 + netgen_rng_below(&rng, 2 * old);
+            t = now_us();
+            result = kind == 1 ? graph_remove_route(g, g->cities[from].id, g->cities[to].id)
+                               : graph_set_route_distance(g, g->cities[from].id, g->cities[to].id, distance);
+        }
+        if (result != ROUTE_OK) continue;
+        record(&stats[OP_TREE_UPDATE], now_us() - t);
+        
+        if (verify) {
+            mismatches += verify_trees(g, &heap, dist);
+            checked++;
+        }
+    }
+    stats[OP_TREE_UPDATE].checksum = (long long)g->trees->settled;
+    if (verify) printf("verify: %d tree edits checked against recomputation, %d mismatches\n", checked, mismatches);
+    
+    // what every edit would cost without incremental maintenance
+    int samples = edits < TREE_RECOMPUTE_SAMPLES ? edits : TREE_RECOMPUTE_SAMPLES;
+    for (int s = 0; s < samples; ++s) {
+        double t = now_us();
+        spt_rebuild(g->trees, g);
+        record(&stats[OP_TREE_RECOMPUTE], now_us() - t);
+    }
+    stats[OP_TREE_RECOMPUTE].checksum = tree_digest(g->trees, n);
+    
+    for (int h = 0; h < hubCount; ++h) {
+        graph_untrack_source(g, g->cities[hubs[h]].id);
+    }
+    heap_free(&heap);
+    free(dist);
+    return mismatches;
+}
+
+// concurrent phase: worker 0 edits the graph and publishes each version while
+// the other workers run shortest path queries on whatever version is current
+typedef struct {
+    Graph *g;            // touched by the writer only
+    int cityCount;
+    GraphPublisher *pub;
+    const QueryPair *pairs;
+    int queries;
+    int readers;
+    uint64_t seed;
+    atomic_int next;     // read work claimed so far, out of queries * readers
+    OpStats *readStats;  // one per worker
+    int *failures;       // per worker: answers inconsistent with their own snapshot
+    int *regressions;    // per worker: a version older than one already seen
+    OpStats *publish;
+} ConcurrentRun;
+
+static void concurrent_writer(ConcurrentRun *run) {
+    NetgenRng rng;
+    netgen_rng_seed(&rng, run->seed ^ 0x9E3779B97F4A7C15ULL);
+    int rounds = run->queries < PUBLISH_ROUNDS ? run->queries : PUBLISH_ROUNDS;
+    int added[PUBLISH_ROUNDS];
+    
+    // add a batch of routes then take them out again, publishing after every edit
+    for (int r = 0; r < 2 * rounds; ++r) {
+        const QueryPair *q = &run->pairs[r % rounds];
+        if (r < rounds) {
+            added[r] = graph_add_route(run->g, q->from, q->to, 1 + netgen_rng_below(&rng, 5000)) == ROUTE_OK;
+            if (!added[r]) continue;
+        } else {
+            if (!added[r - rounds]) continue;
+            graph_remove_route(run->g, q->from, q->to);
+        }
+        
+        double t = now_us();
+        int result = publisher_publish_graph(run->pub, run->g);
+        record(run->publish, now_us() - t);
+        if (result == 0) run->publish->checksum++;
+    }
+}
+
+static void concurrent_reader(ConcurrentRun *run, int worker) {
+    int slot = publisher_register(run->pub);
+    QueryContext *qc = query_context_create(run->cityCount, 0);
+    int *path = malloc(run->cityCount * sizeof(int)); // edits never add cities
+    if (slot < 0 || qc == NULL || path == NULL) {
+        fprintf(stderr, "Reader %d could not start\n", worker);
+        publisher_unregister(run->pub, slot);
+        query_context_free(qc);
+        free(path);
+        return;
+    }
+    
+    OpStats *stats = &run->readStats[worker];
+    unsigned int lastVersion = 0;
+    int total = run->queries * run->readers;
+    int k;
+    while ((k = atomic_fetch_add_explicit(&run->next, 1, memory_order_relaxed)) < total) {
+        const QueryPair *q = &run->pairs[k % run->queries];
+        int length = 0;
+        
+        double t = now_us();
+        const PublishedGraph *pg = publisher_enter(run->pub, slot);
+        query_context_fit(qc, pg->graph->cityCount, pg->graph->edgeCount);
+        int dist = frozen_shortest_path_ctx(pg->graph, qc, q->from, q->to, path, &length, NULL);
+        record(stats, now_us() - t);
+        
+        // checked against the same snapshot, which must not have been reclaimed meanwhile
+        if (!check_path(pg->graph, q->from, q->to, dist, path, length)) run->failures[worker]++;
+        else stats->checksum++;
+        if (pg->version < lastVersion) run->regressions[worker]++;
+        lastVersion = pg->version;
+        publisher_exit(run->pub, slot);
+    }
+    
+    publisher_unregister(run->pub, slot);
+    query_context_free(qc);
+    free(path);
+}
+
+static void concurrent_worker(void *arg, int worker) {
+    ConcurrentRun *run = arg;
+    if (worker == 0) concurrent_writer(run);
+    else concurrent_reader(run, worker);
+}
+
+// returns the number of inconsistent reads
+static int run_concurrent(Graph *g, const QueryPair *pairs, int queries, int readers, uint64_t seed,
+                          OpStats *stats) {
+    GraphPublisher pub;
+    if (publisher_init(&pub) != 0 || publisher_publish_graph(&pub, g) != 0) {
+        fprintf(stderr, "Could not publish the graph\n");
+        exit(1);
+    }
+    
+    ConcurrentRun run;
+    run.g = g;
+    run.cityCount = g->cityCount;
+    run.pub = &pub;
+    run.pairs = pairs;
+    run.queries = queries;
+    run.readers = readers;
+    run.seed = seed;
+    atomic_init(&run.next, 0);
+    run.readStats = calloc(readers + 1, sizeof(OpStats));
+    run.failures = calloc(readers + 1, sizeof(int));
+    run.regressions = calloc(readers + 1, sizeof(int));
+    run.publish = &stats[OP_PUBLISH];
+    if (run.readStats == NULL || run.failures == NULL || run.regressions == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    
+    int started = run_workers(readers + 1, concurrent_worker, &run);
+    
+    int failures = 0;
+    int regressions = 0;
+    OpStats *read = &stats[OP_READ_UNDER_EDIT];
+    for (int w = 1; w <= readers; ++w) {
+        for (int i = 0; i < run.readStats[w].count; ++i) {
+            record(read, run.readStats[w].samples[i]);
+        }
+        read->checksum += run.readStats[w].checksum;
+        failures += run.failures[w];
+        regressions += run.regressions[w];
+        free(run.readStats[w].samples);
+    }
+    if (started < readers + 1) {
+        fprintf(stderr, "Only %d of %d reader threads started\n", started - 1, readers);
+    }
+    if (failures > 0 || regressions > 0) {
+        fprintf(stderr, "concurrent: %d reads inconsistent with their snapshot, %d saw an older version\n",
+                failures, regressions);
+    }
+    fprintf(stderr, "Published %lu versions, %lu reclaimed while readers ran\n",
+            pub.published, pub.reclaimed);
+    
+    publisher_destroy(&pub);
+    free(run.readStats);
+    free(run.failures);
+    free(run.regressions);
+    return failures + regressions;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: bench [--model hub|scale|regional] [--cities n] [--links m] [--hubs h] [--seed s]\n"
+                    "             [--queries q] [--readers r] [--threads t] [--json file|-] [--verify]\n");
+}
+
+int main(int argc, char **argv) {
+    NetgenModel model = NETGEN_HUB_SPOKE;
+    int cities = 10000;
+    int hubs = 0;
+    int links = 0;
+    uint64_t seed = 1;
+    int queries = 1000;
+    int readers = 0;
+    int threads = 0;
+    int verify = 0;
+    const char *jsonPath = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "hub") == 0) {
+                model = NETGEN_HUB_SPOKE;
+            } else if (strcmp(argv[i], "scale") == 0) {
+                model = NETGEN_SCALE_FREE;
+            } else if (strcmp(argv[i], "regional") == 0) {
+                model = NETGEN_REGIONAL;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cities") == 0 && i + 1 < argc) {
+            cities = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--links") == 0 && i + 1 < argc) {
+            links = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hubs") == 0 && i + 1 < argc) {
+            hubs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--readers") == 0 && i + 1 < argc) {
+            readers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = 1;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (cities < 2 || queries < 1) {
+        usage();
+        return 1;
+    }
+    if (readers <= 0) readers = cpu_count() > 1 ? cpu_count() - 1 : 1;
+    if (readers > PUBLISH_MAX_READERS) readers = PUBLISH_MAX_READERS;
+    
+    NetgenParams params;
+    netgen_default_params(&params, model, cities, seed);
+    if (hubs > 0) params.hubCount = hubs;
+    if (links > 0) params.linksPerCity = links;
+    
+    OpStats stats[OP_COUNT];
+    memset(stats, 0, sizeof(stats));
+    
+    Graph g;
+    init_graph(&g);
+    double t = now_us();
+    int routes = netgen_build(&g, &params);
+    record(&stats[OP_BUILD], now_us() - t);
+    if (routes < 0) {
+        fprintf(stderr, "Could not generate a network of %d cities\n", params.cityCount);
+        free_graph(&g);
+        return 1;
+    }
+    stats[OP_BUILD].checksum = routes;
+    fprintf(stderr, "Generated %s network: %d cities, %d routes\n",
+            modelNames[params.model], g.cityCount, routes);
+    
+    // query pairs come from their own stream so they do not depend on the generator's draws
+    NetgenRng rng;
+    netgen_rng_seed(&rng, params.seed ^ 0x5DEECE66DULL);
+    QueryPair *pairs = malloc(queries * sizeof(QueryPair));
+    int *path = malloc(g.cityCount * sizeof(int));
+    int *shortest = malloc(g.cityCount * sizeof(int));
+    if (pairs == NULL || path == NULL || shortest == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int q = 0; q < queries; ++q) {
+        pairs[q].from = g.cities[netgen_rng_below(&rng, g.cityCount)].id;
+        pairs[q].to = g.cities[netgen_rng_below(&rng, g.cityCount)].id;
+    }
+    
+    t = now_us();
+    const FrozenGraph *fg = graph_snapshot(&g);
+    record(&stats[OP_FREEZE], now_us() - t);
+    stats[OP_FREEZE].checksum = fg != NULL ? fg->edgeCount : -1;
+    
+    // the first can_reach after an edit builds the reachability index
+    t = now_us();
+    stats[OP_REACH_BUILD].checksum = can_reach(&g, pairs[0].from, pairs[0].to);
+    record(&stats[OP_REACH_BUILD], now_us() - t);
+    
+    for (int q = 0; q < queries; ++q) {
+        t = now_us();
+        int reach = can_reach(&g, pairs[q].from, pairs[q].to);
+        record(&stats[OP_CAN_REACH], now_us() - t);
+        stats[OP_CAN_REACH].checksum += reach;
+    }
+    
+    for (int q = 0; q < queries; ++q) {
+        int length = 0;
+        t = now_us();
+        int dist = dijkstra_shortest_path(&g, pairs[q].from, pairs[q].to, path, &length);
+        record(&stats[OP_SHORTEST], now_us() - t);
+        if (dist >= 0) stats[OP_SHORTEST].checksum += dist;
+    }
+    
+    for (int q = 0; q < queries; ++q) {
+        int length = 0;
+        t = now_us();
+        int dist = point_to_point_path(&g, pairs[q].from, pairs[q].to, path, &length, NULL);
+        record(&stats[OP_ASTAR], now_us() - t);
+        if (dist >= 0) stats[OP_ASTAR].checksum += dist;
+    }
+    
+    for (int q = 0; q < queries; ++q) {
+        int shortestLength = 0;
+        int length = 0;
+        if (dijkstra_shortest_path(&g, pairs[q].from, pairs[q].to, shortest, &shortestLength) < 0) continue;
+        
+        t = now_us();
+        int dist = find_alternate_route(&g, pairs[q].from, pairs[q].to, path, &length, shortest, shortestLength);
+        record(&stats[OP_ALTERNATE], now_us() - t);
+        if (dist >= 0) stats[OP_ALTERNATE].checksum += dist;
+    }
+    
+    int mismatches = verify ? verify_engines(&g, pairs, queries) : 0;
+    mismatches += run_landmarks(&g, pairs, queries, verify, stats);
+    mismatches += run_labels(&g, pairs, queries, params.seed, verify, stats);
+    mismatches += run_overlay(&g, pairs, queries, threads, params.seed, OVERLAY_CLIQUE_FACTOR, OVERLAY_REWEIGHTS,
+                              verify, stats);
+    if (verify) {
+        // every cell closed, so customization and the crossings of closed cells run whatever the network;
+        // timed apart, the table keeps the default overlay's numbers
+        OpStats closedStats[OP_COUNT];
+        memset(closedStats, 0, sizeof(closedStats));
+        mismatches += run_overlay(&g, pairs, queries, threads, params.seed, OVERLAY_ALL_CLOSED,
+                                  OVERLAY_CLOSED_REWEIGHTS, 1, closedStats);
+        for (int op = 0; op < OP_COUNT; ++op) {
+            free(closedStats[op].samples);
+        }
+    }
+    mismatches += run_bfs(&g, pairs, queries, threads, verify, stats);
+    mismatches += run_sssp(&g, pairs, queries, threads, verify, stats);
+    
+    // a generated day of single-leg flights over every route, departures from their own stream
+    FlightSpec *flights;
+    int flightCount = netgen_timetable(&g, params.seed, &flights);
+    int *departures = malloc(queries * sizeof(int));
+    if (flightCount < 0 || departures == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    NetgenRng clock;
+    netgen_rng_seed(&clock, params.seed ^ 0x2545F4914F6CDD1DULL);
+    for (int q = 0; q < queries; ++q) {
+        departures[q] = 360 + netgen_rng_below(&clock, 14 * 60);
+    }
+    
+    t = now_us();
+    Timetable *tt = timetable_build(&g, flights, flightCount, DEFAULT_MIN_TRANSFER);
+    record(&stats[OP_TIMETABLE_BUILD], now_us() - t);
+    TimetableQuery *tq = timetable_query_create(tt);
+    JourneyLeg *legs = malloc(g.cityCount * sizeof(JourneyLeg));
+    if (tt == NULL || tq == NULL || legs == NULL) {
+        fprintf(stderr, "Could not build the timetable\n");
+        exit(1);
+    }
+    stats[OP_TIMETABLE_BUILD].checksum = tt->connectionCount;
+    
+    for (int q = 0; q < queries; ++q) {
+        int legCount = 0;
+        t = now_us();
+        int arrival = timetable_earliest_arrival(tt, tq, pairs[q].from, pairs[q].to, departures[q], legs, &legCount);
+        record(&stats[OP_EARLIEST_ARRIVAL], now_us() - t);
+        if (arrival >= 0) stats[OP_EARLIEST_ARRIVAL].checksum += arrival;
+    }
+    
+    for (int q = 0; q < queries; ++q) {
+        ProfileEntry *entries;
+        t = now_us();
+        int count = timetable_profile(tt, pairs[q].from, pairs[q].to, 0, MINUTES_PER_DAY, &entries);
+        record(&stats[OP_PROFILE], now_us() - t);
+        if (count > 0) stats[OP_PROFILE].checksum += count;
+        free(entries);
+    }
+    
+    if (verify) mismatches += verify_timetable(tt, pairs, departures, queries);
+    timetable_query_free(tq);
+    timetable_free(tt);
+    free(flights);
+    free(departures);
+    free(legs);
+    
+    mismatches += run_concurrent(&g, pairs, queries, readers, params.seed, stats);
+    
+    // edits last, each one invalidates the snapshot the queries above relied on
+    int *added = calloc(queries, sizeof(int));
+    if (added == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int q = 0; q < queries; ++q) {
+        t = now_us();
+        int result = graph_add_route(&g, pairs[q].from, pairs[q].to, 1 + netgen_rng_below(&rng, 5000));
+        record(&stats[OP_ADD_ROUTE], now_us() - t);
+        added[q] = result == ROUTE_OK;
+        stats[OP_ADD_ROUTE].checksum += added[q];
+    }
+    for (int q = 0; q < queries; ++q) {
+        if (!added[q]) continue;
+        
+        t = now_us();
+        int result = graph_remove_route(&g, pairs[q].from, pairs[q].to);
+        record(&stats[OP_REMOVE_ROUTE], now_us() - t);
+        stats[OP_REMOVE_ROUTE].checksum += result == ROUTE_OK;
+    }
+    
+    run_hub_edits(&g, queries, params.seed, stats);
+    mismatches += run_trees(&g, queries, params.seed, verify, stats);
+    
+    for (int op = 0; op < OP_COUNT; ++op) {
+        summarize(&stats[op]);
+    }
+    print_table(stats);
+    if (stats_enabled()) stats_dump(stdout); // built with -DAIR_STATS
+    if (jsonPath != NULL && write_json(jsonPath, &params, &g, routes, queries, stats) != 0) {
+        fprintf(stderr, "Could not write %s\n", jsonPath);
+    }
+    
+    for (int op = 0; op < OP_COUNT; ++op) {
+        free(stats[op].samples);
+    }
+    free(added);
+    free(pairs);
+    free(path);
+    free(shortest);
+    free_graph(&g);
+    return mismatches > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bfs.h"
+#include "workers.h"
+
+typedef struct {
+    ParallelBfs *b;
+    int level;      // hops of the cities being expanded
+    int bottomUp;
+    int chunkCount;
+    atomic_int nextChunk;
+    atomic_int found;           // cities reached in this level
+    atomic_llong foundEdges;    // their outgoing routes
+} BfsLevel;
+
+static _Atomic uint64_t *alloc_bitset(int words) {
+    _Atomic uint64_t *bits = malloc((words > 0 ? words : 1) * sizeof(_Atomic uint64_t));
+    if (bits == NULL) return NULL;
+    for (int w = 0; w < words; ++w) {
+        atomic_init(&bits[w], 0);
+    }
+    return bits;
+}
+
+static void clear_bitset(_Atomic uint64_t *bits, int words) {
+    for (int w = 0; w < words; ++w) {
+        atomic_store_explicit(&bits[w], 0, memory_order_relaxed);
+    }
+}
+
+ParallelBfs *bfs_create(const FrozenGraph *fg, int threads) {
+    if (fg == NULL) return NULL;
+    
+    ParallelBfs *b = calloc(1, sizeof(ParallelBfs));
+    if (b == NULL) return NULL;
+    
+    b->fg = fg;
+    b->threads = threads > 0 ? threads : cpu_count();
+    b->words = (fg->cityCount + 63) / 64;
+    b->visited = alloc_bitset(b->words);
+    b->frontier = alloc_bitset(b->words);
+    b->next = alloc_bitset(b->words);
+    b->hops = malloc((fg->cityCount > 0 ? fg->cityCount : 1) * sizeof(int));
+    if (b->visited == NULL || b->frontier == NULL || b->next == NULL || b->hops == NULL) {
+        bfs_free(b);
+        return NULL;
+    }
+    return b;
+}
+
+void bfs_free(ParallelBfs *b) {
+    if (b == NULL) return;
+    
+    free(b->visited);
+    free(b->frontier);
+    free(b->next);
+    free(b->hops);
+    free(b);
+}
+
+// frontier cities claim their unvisited neighbours; several threads may race for one
+static void expand_top_down(BfsLevel *lv, int firstWord, int endWord, int *found, long long *foundEdges) {
+    ParallelBfs *b = lv->b;
+    const FrozenGraph *fg = b->fg;
+    
+    for (int w = firstWord; w < endWord; ++w) {
+        uint64_t bits = atomic_load_explicit(&b->frontier[w], memory_order_relaxed);
+        while (bits != 0) {
+            int u = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            
+            for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+                int v = fg->edges[e].dest;
+                uint64_t bit = (uint64_t)1 << (v & 63);
+                if (atomic_load_explicit(&b->visited[v >> 6], memory_order_relaxed) & bit) continue;
+                if (atomic_fetch_or_explicit(&b->visited[v >> 6], bit, memory_order_relaxed) & bit) continue;
+                
+                atomic_fetch_or_explicit(&b->next[v >> 6], bit, memory_order_relaxed);
+                b->hops[v] = lv->level + 1;
+                (*found)++;
+                *foundEdges += fg->offsets[v + 1] - fg->offsets[v];
+            }
+        }
+    }
+}
+
+// unvisited cities look for a frontier city among their incoming routes; each word has one owner
+static void expand_bottom_up(BfsLevel *lv, int firstWord, int endWord, int *found, long long *foundEdges) {
+    ParallelBfs *b = lv->b;
+    const FrozenGraph *fg = b->fg;
+    int n = fg->cityCount;
+    
+    for (int w = firstWord; w < endWord; ++w) {
+        uint64_t open = ~atomic_load_explicit(&b->visited[w], memory_order_relaxed);
+        if (w == b->words - 1 && (n & 63) != 0) open &= ((uint64_t)1 << (n & 63)) - 1;
+        uint64_t claimed = 0;
+        
+        while (open != 0) {
+            int bitIndex = __builtin_ctzll(open);
+            open &= open - 1;
+            int v = w * 64 + bitIndex;
+            
+            for (int e = fg->revOffsets[v]; e < fg->revOffsets[v + 1]; ++e) {
+                int u = fg->revEdges[e].dest;
+                if (atomic_load_explicit(&b->frontier[u >> 6], memory_order_relaxed) & ((uint64_t)1 << (u & 63))) {
+                    claimed |= (uint64_t)1 << bitIndex;
+                    b->hops[v] = lv->level + 1;
+                    (*found)++;
+                    *foundEdges += fg->offsets[v + 1] - fg->offsets[v];
+                    break;
+                }
+            }
+        }
+        if (claimed != 0) {
+            atomic_fetch_or_explicit(&b->visited[w], claimed, memory_order_relaxed);
+            atomic_store_explicit(&b->next[w], claimed, memory_order_relaxed);
+        }
+    }
+}
+
+static void level_worker(void *arg, int worker) {
+    BfsLevel *lv = arg;
+    (void)worker;
+    
+    int found = 0;
+    long long foundEdges = 0;
+    int c;
+    while ((c = atomic_fetch_add_explicit(&lv->nextChunk, 1, memory_order_relaxed)) < lv->chunkCount) {
+        int first = c * BFS_CHUNK_WORDS;
+        int end = first + BFS_CHUNK_WORDS;
+        if (end > lv->b->words) end = lv->b->words;
+        
+        if (lv->bottomUp) expand_bottom_up(lv, first, end, &found, &foundEdges);
+        else expand_top_down(lv, first, end, &found, &foundEdges);
+    }
+    atomic_fetch_add_explicit(&lv->found, found, memory_order_relaxed);
+    atomic_fetch_add_explicit(&lv->foundEdges, foundEdges, memory_order_relaxed);
+}
+
+// sources are city ids; maxHops BFS_UNLIMITED for plain reachability.
+// Returns the number of cities reached, sources included, or -1 for an unknown source.
+int bfs_run(ParallelBfs *b, const int *sources, int sourceCount, int maxHops) {
+    if (b == NULL || (sources == NULL && sourceCount > 0)) return -1;
+    
+    const FrozenGraph *fg = b->fg;
+    int n = fg->cityCount;
+    clear_bitset(b->visited, b->words);
+    clear_bitset(b->frontier, b->words);
+    for (int v = 0; v < n; ++v) {
+        b->hops[v] = -1;
+    }
+    b->reached = 0;
+    b->levels = 0;
+    b->bottomUpLevels = 0;
+    
+    int frontierSize = 0;
+    long long frontierEdges = 0;
+    for (int i = 0; i < sourceCount; ++i) {
+        int s = frozen_find_city(fg, sources[i]);
+        if (s == -1) return -1;
+        if (b->hops[s] == 0) continue;
+        
+        atomic_fetch_or_explicit(&b->visited[s >> 6], (uint64_t)1 << (s & 63), memory_order_relaxed);
+        atomic_fetch_or_explicit(&b->frontier[s >> 6], (uint64_t)1 << (s & 63), memory_order_relaxed);
+        b->hops[s] = 0;
+        frontierSize++;
+        frontierEdges += fg->offsets[s + 1] - fg->offsets[s];
+    }
+    long long unvisitedEdges = fg->edgeCount - frontierEdges;
+    b->reached = frontierSize;
+    
+    int bottomUp = 0;
+    while (frontierSize > 0 && (maxHops < 0 || b->levels < maxHops)) {
+        if (!bottomUp && frontierEdges > unvisitedEdges / BFS_ALPHA) bottomUp = 1;
+        else if (bottomUp && frontierSize < n / BFS_BETA) bottomUp = 0;
+        
+        BfsLevel lv;
+        lv.b = b;
+        lv.level = b->levels;
+        lv.bottomUp = bottomUp;
+        lv.chunkCount = (b->words + BFS_CHUNK_WORDS - 1) / BFS_CHUNK_WORDS;
+        atomic_init(&lv.nextChunk, 0);
+        atomic_init(&lv.found, 0);
+        atomic_init(&lv.foundEdges, 0);
+        clear_bitset(b->next, b->words);
+        
+        // a thread per BFS_GRAIN routes of expected work, so small levels stay on this thread
+        long long work = (bottomUp ? unvisitedEdges : frontierEdges) + b->words;
+        long long threads = 1 + work / BFS_GRAIN;
+        if (threads > b->threads) threads = b->threads;
+        if (threads > lv.chunkCount) threads = lv.chunkCount;
+        run_workers((int)threads, level_worker, &lv);
+        
+        _Atomic uint64_t *done = b->frontier;
+        b->frontier = b->next;
+        b->next = done;
+        frontierSize = atomic_load(&lv.found);
+        frontierEdges = atomic_load(&lv.foundEdges);
+        unvisitedEdges -= frontierEdges;
+        b->reached += frontierSize;
+        b->levels++;
+        if (bottomUp) b->bottomUpLevels++;
+    }
+    return b->reached;
+}
\ No newline at end of file
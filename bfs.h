@@ -0,0 +1,45 @@
+#ifndef BFS_H
+#define BFS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "graph.h"
+
+// Level-synchronous parallel breadth-first search over a frozen graph, from
+// one or many sources, optionally stopping after a number of hops. Visited
+// cities and the current and next frontiers are bitsets over dense indices.
+// A level runs top-down (frontier cities claim their unvisited neighbours)
+// while the frontier is small, and bottom-up (unvisited cities look for a
+// frontier city among their incoming routes, using the reverse CSR) once the
+// frontier's routes outweigh the unvisited part of the graph (Beamer's
+// direction-optimizing BFS). Large levels are split across threads; small
+// ones run on the calling thread.
+
+#define BFS_UNLIMITED -1
+#define BFS_ALPHA 14          // go bottom-up when frontier routes > unvisited routes / BFS_ALPHA
+#define BFS_BETA 24           // go back top-down when the frontier holds < cities / BFS_BETA
+#define BFS_CHUNK_WORDS 64    // bitset words per unit of parallel work (4096 cities)
+#define BFS_GRAIN (64 * 1024) // routes of work that justify one more thread in a level
+
+typedef struct {
+    const FrozenGraph *fg;
+    int threads;
+    int words;                 // 64-bit words per bitset
+    _Atomic uint64_t *visited; // cities reached by the last run, sources included
+    _Atomic uint64_t *frontier;
+    _Atomic uint64_t *next;
+    int *hops;                 // hops from the nearest source, -1 when not reached
+    int reached;               // cities reached by the last run
+    int levels;                // levels expanded by the last run
+    int bottomUpLevels;        // of which bottom-up
+} ParallelBfs;
+
+ParallelBfs *bfs_create(const FrozenGraph *fg, int threads);
+void bfs_free(ParallelBfs *b);
+int bfs_run(ParallelBfs *b, const int *sources, int sourceCount, int maxHops);
+
+static inline int bfs_reached(const ParallelBfs *b, int index) {
+    return (int)((atomic_load_explicit(&b->visited[index >> 6], memory_order_relaxed) >> (index & 63)) & 1);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,550 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "heap.h"
+#include "ch.h"
+#include "query.h"
+
+#define WITNESS_SETTLE_LIMIT 500 // when actually adding shortcuts
+#define ESTIMATE_SETTLE_LIMIT 32 // when only rating a city for the contraction order
+
+// Contraction Hierarchies: cities are contracted one by one in order of
+// importance, adding a shortcut u -> x through v whenever the path u -> v -> x
+// has no equally short witness avoiding v. Queries then only ever move to
+// higher ranked cities, from both ends.
+
+typedef struct {
+    int target;
+    int weight;
+    int middle;
+} DynEdge;
+
+typedef struct {
+    DynEdge *items;
+    int count;
+    int cap;
+} DynList;
+
+typedef struct {
+    int n;
+    DynList *out;
+    DynList *in;
+    char *contracted;
+    int *deletedNeighbors;
+    
+    // witness search workspace
+    int *dist;
+    int *touched;
+    int touchedCount;
+    IndexedHeap heap;
+} Contractor;
+
+static void dyn_push(DynList *l, int target, int weight, int middle) {
+    if (l->count >= l->cap) {
+        int newCap = l->cap ? l->cap * 2 : 4;
+        DynEdge *temp = realloc(l->items, newCap * sizeof(DynEdge));
+        if (temp == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        l->items = temp;
+        l->cap = newCap;
+    }
+    l->items[l->count].target = target;
+    l->items[l->count].weight = weight;
+    l->items[l->count].middle = middle;
+    l->count++;
+}
+
+static DynEdge *dyn_find(DynList *l, int target) {
+    for (int i = 0; i < l->count; ++i) {
+        if (l->items[i].target == target) return &l->items[i];
+    }
+    return NULL;
+}
+
+static void dyn_remove(DynList *l, int target) {
+    for (int i = 0; i < l->count; ++i) {
+        if (l->items[i].target == target) {
+            l->items[i] = l->items[--l->count];
+            return;
+        }
+    }
+}
+
+static void add_or_improve(Contractor *c, int from, int to, int weight, int middle) {
+    DynEdge *fwd = dyn_find(&c->out[from], to);
+    if (fwd != NULL) {
+        if (weight < fwd->weight) {
+            DynEdge *bwd = dyn_find(&c->in[to], from);
+            fwd->weight = bwd->weight = weight;
+            fwd->middle = bwd->middle = middle;
+        }
+        return;
+    }
+    dyn_push(&c->out[from], to, weight, middle);
+    dyn_push(&c->in[to], from, weight, middle);
+}
+
+// bounded Dijkstra from `from` over uncontracted cities, never entering `skip`
+static void witness_search(Contractor *c, int from, int skip, int limit, int settleLimit) {
+    for (int i = 0; i < c->touchedCount; ++i) {
+        c->dist[c->touched[i]] = MAX_DISTANCE;
+    }
+    c->touchedCount = 0;
+    heap_clear(&c->heap);
+    
+    c->dist[from] = 0;
+    c->touched[c->touchedCount++] = from;
+    heap_push_or_decrease(&c->heap, from, 0);
+    
+    int settled = 0;
+    while (!heap_empty(&c->heap)) {
+        int d;
+        int u = heap_pop_min(&c->heap, &d);
+        if (d > limit || ++settled > settleLimit) break;
+        
+        DynList *l = &c->out[u];
+        for (int i = 0; i < l->count; ++i) {
+            int v = l->items[i].target;
+            if (v == skip || c->contracted[v]) continue;
+            
+            int nd = d + l->items[i].weight;
+            if (nd < c->dist[v]) {
+                if (c->dist[v] == MAX_DISTANCE) {
+                    c->touched[c->touchedCount++] = v;
+                }
+                c->dist[v] = nd;
+                heap_push_or_decrease(&c->heap, v, nd);
+            }
+        }
+    }
+}
+
+// returns the number of shortcuts contracting v needs, adding them when apply is set
+static int contract(Contractor *c, int v, int apply) {
+    int shortcuts = 0;
+    DynList *in = &c->in[v];
+    DynList *out = &c->out[v];
+    
+    for (int i = 0; i < in->count; ++i) {
+        int u = in->items[i].target;
+        if (c->contracted[u]) continue;
+        
+        int maxOut = -1;
+        for (int j = 0; j < out->count; ++j) {
+            int x = out->items[j].target;
+            if (!c->contracted[x] && x != u && out->items[j].weight > maxOut) {
+                maxOut = out->items[j].weight;
+            }
+        }
+        if (maxOut < 0) continue;
+        
+        int w1 = in->items[i].weight;
+        witness_search(c, u, v, w1 + maxOut, apply ? WITNESS_SETTLE_LIMIT : ESTIMATE_SETTLE_LIMIT);
+        
+        for (int j = 0; j < out->count; ++j) {
+            int x = out->items[j].target;
+            if (c->contracted[x] || x == u) continue;
+            
+            int via = w1 + out->items[j].weight;
+            if (c->dist[x] > via) {
+                shortcuts++;
+                if (apply) add_or_improve(c, u, x, via, v);
+            }
+        }
+    }
+    return shortcuts;
+}
+
+static int live_degree(const Contractor *c, int v) {
+    int deg = 0;
+    for (int i = 0; i < c->out[v].count; ++i) {
+        if (!c->contracted[c->out[v].items[i].target]) deg++;
+    }
+    for (int i = 0; i < c->in[v].count; ++i) {
+        if (!c->contracted[c->in[v].items[i].target]) deg++;
+    }
+    return deg;
+}
+
+static int priority(Contractor *c, int v) {
+    int added = contract(c, v, 0);
+    return 2 * (added - live_degree(c, v)) + c->deletedNeighbors[v];
+}
+
+// turns per-city edge lists into a CSR pair of offsets/edges
+static int to_csr(int n, DynList *lists, int **offsets, ChEdge **edges) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) total += lists[i].count;
+    
+    *offsets = malloc((n + 1) * sizeof(int));
+    *edges = malloc((total > 0 ? total : 1) * sizeof(ChEdge));
+    if (*offsets == NULL || *edges == NULL) return -1;
+    
+    int at = 0;
+    for (int i = 0; i < n; ++i) {
+        (*offsets)[i] = at;
+        for (int j = 0; j < lists[i].count; ++j) {
+            (*edges)[at].target = lists[i].items[j].target;
+            (*edges)[at].weight = lists[i].items[j].weight;
+            (*edges)[at].middle = lists[i].items[j].middle;
+            at++;
+        }
+    }
+    (*offsets)[n] = at;
+    return 0;
+}
+
+static void free_lists(DynList *lists, int n) {
+    if (lists == NULL) return;
+    for (int i = 0; i < n; ++i) {
+        free(lists[i].items);
+    }
+    free(lists);
+}
+
+static void free_contractor(Contractor *c) {
+    free_lists(c->out, c->n);
+    free_lists(c->in, c->n);
+    free(c->contracted);
+    free(c->deletedNeighbors);
+    free(c->dist);
+    free(c->touched);
+    heap_free(&c->heap);
+}
+
+static int init_contractor(Contractor *c, const FrozenGraph *fg) {
+    int n = fg->cityCount;
+    int slots = n > 0 ? n : 1;
+    
+    c->n = n;
+    c->out = calloc(slots, sizeof(DynList));
+    c->in = calloc(slots, sizeof(DynList));
+    c->contracted = calloc(slots, sizeof(char));
+    c->deletedNeighbors = calloc(slots, sizeof(int));
+    c->dist = malloc(slots * sizeof(int));
+    c->touched = malloc(slots * sizeof(int));
+    c->touchedCount = 0;
+    c->heap.entries = NULL;
+    c->heap.pos = NULL;
+    
+    if (c->out == NULL || c->in == NULL || c->contracted == NULL || c->deletedNeighbors == NULL ||
+        c->dist == NULL || c->touched == NULL || heap_init(&c->heap, n) != 0) {
+        free_contractor(c);
+        return -1;
+    }
+    
+    for (int u = 0; u < n; ++u) {
+        c->dist[u] = MAX_DISTANCE;
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            add_or_improve(c, u, fg->edges[e].dest, fg->edges[e].distance, -1);
+        }
+    }
+    return 0;
+}
+
+ContractionHierarchy *frozen_ch_build(const FrozenGraph *fg) {
+    if (fg == NULL) return NULL;
+    
+    int n = fg->cityCount;
+    int slots = n > 0 ? n : 1;
+    Contractor c;
+    if (init_contractor(&c, fg) != 0) return NULL;
+    
+    DynList *up = calloc(slots, sizeof(DynList));
+    DynList *down = calloc(slots, sizeof(DynList));
+    ContractionHierarchy *ch = calloc(1, sizeof(ContractionHierarchy));
+    IndexedHeap order;
+    int failed = up == NULL || down == NULL || ch == NULL || heap_init(&order, n) != 0;
+    
+    if (!failed) {
+        ch->cityCount = n;
+        ch->rank = malloc(slots * sizeof(int));
+        ch->ids = malloc(slots * sizeof(int));
+        failed = ch->rank == NULL || ch->ids == NULL;
+        if (failed) heap_free(&order);
+    }
+    if (failed) {
+        free_contractor(&c);
+        free_lists(up, n);
+        free_lists(down, n);
+        ch_free(ch);
+        return NULL;
+    }
+    memcpy(ch->ids, fg->ids, n * sizeof(int));
+    
+    for (int v = 0; v < n; ++v) {
+        heap_push_or_decrease(&order, v, priority(&c, v));
+    }
+    
+    int nextRank = 0;
+    while (!heap_empty(&order)) {
+        int v = heap_pop_min(&order, NULL);
+        
+        // lazy update: contract v only if it is still the cheapest choice
+        int prio = priority(&c, v);
+        if (!heap_empty(&order) && prio > heap_min_key(&order)) {
+            heap_push_or_decrease(&order, v, prio);
+            continue;
+        }
+        
+        contract(&c, v, 1);
+        c.contracted[v] = 1;
+        ch->rank[v] = nextRank++;
+        
+        // v's remaining edges all lead to higher ranked cities; unlink them
+        // from the neighbours so later witness searches stay small
+        for (int i = 0; i < c.out[v].count; ++i) {
+            DynEdge *e = &c.out[v].items[i];
+            dyn_push(&up[v], e->target, e->weight, e->middle);
+            dyn_remove(&c.in[e->target], v);
+            c.deletedNeighbors[e->target]++;
+        }
+        for (int i = 0; i < c.in[v].count; ++i) {
+            DynEdge *e = &c.in[v].items[i];
+            dyn_push(&down[v], e->target, e->weight, e->middle);
+            dyn_remove(&c.out[e->target], v);
+            c.deletedNeighbors[e->target]++;
+        }
+    }
+    
+    int total = 0;
+    for (int v = 0; v < n; ++v) {
+        total += up[v].count + down[v].count;
+    }
+    ch->shortcutCount = total - fg->edgeCount;
+    
+    failed = to_csr(n, up, &ch->upOffsets, &ch->upEdges) != 0 ||
+             to_csr(n, down, &ch->downOffsets, &ch->downEdges) != 0;
+    
+    heap_free(&order);
+    free_contractor(&c);
+    free_lists(up, n);
+    free_lists(down, n);
+    
+    if (failed) {
+        ch_free(ch);
+        return NULL;
+    }
+    id_index_build(&ch->index, ch->ids, n);
+    return ch;
+}
+
+ContractionHierarchy *ch_build(Graph *g) {
+    if (g == NULL) return NULL;
+    
+    const FrozenGraph *fg = graph_snapshot(g);
+    if (fg == NULL) return NULL;
+    return frozen_ch_build(fg);
+}
+
+void ch_free(ContractionHierarchy *ch) {
+    if (ch == NULL) return;
+    
+    free(ch->ids);
+    free(ch->rank);
+    free(ch->upOffsets);
+    free(ch->upEdges);
+    free(ch->downOffsets);
+    free(ch->downEdges);
+    id_index_free(&ch->index);
+    free(ch);
+}
+
+static const ChEdge *find_ch_edge(const int *offsets, const ChEdge *edges, int at, int target) {
+    for (int e = offsets[at]; e < offsets[at + 1]; ++e) {
+        if (edges[e].target == target) return &edges[e];
+    }
+    return NULL;
+}
+
+// appends the cities after `from` on the original route behind edge from -> to
+static void unpack_edge(const ContractionHierarchy *ch, int from, int to, int middle, int *path, int *len) {
+    if (middle == -1) {
+        path[(*len)++] = ch->ids[to];
+        return;
+    }
+    
+    // both halves hang off the bypassed city, which ranks below either end
+    const ChEdge *first = find_ch_edge(ch->downOffsets, ch->downEdges, middle, from);
+    const ChEdge *second = find_ch_edge(ch->upOffsets, ch->upEdges, middle, to);
+    unpack_edge(ch, from, middle, first->middle, path, len);
+    unpack_edge(ch, middle, to, second->middle, path, len);
+}
+
+int ch_shortest_path_ctx(const ContractionHierarchy *ch, QueryContext *qc, int source, int dest,
+                         int *path, int *pathLength, int *settled) {
+    if (ch == NULL || qc == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    int sourceIdx = id_index_find(&ch->index, source);
+    int destIdx = id_index_find(&ch->index, dest);
+    if (sourceIdx == -1 || destIdx == -1) return -1;
+    if (query_context_fit(qc, ch->cityCount, 0) != 0) return -1;
+    
+    query_begin(qc);
+    SearchSide *fw = &qc->forward;
+    SearchSide *bw = &qc->backward;
+    
+    int best = MAX_DISTANCE;
+    int meet = -1;
+    int settledCount = 0;
+    
+    side_set(qc, fw, sourceIdx, 0, -1);
+    side_set(qc, bw, destIdx, 0, -1);
+    heap_push_or_decrease(&fw->heap, sourceIdx, 0);
+    heap_push_or_decrease(&bw->heap, destIdx, 0);
+    
+    while (!heap_empty(&fw->heap) || !heap_empty(&bw->heap)) {
+        int forward;
+        if (heap_empty(&fw->heap)) forward = 0;
+        else if (heap_empty(&bw->heap)) forward = 1;
+        else forward = heap_min_key(&fw->heap) <= heap_min_key(&bw->heap);
+        
+        SearchSide *side = forward ? fw : bw;
+        SearchSide *other = forward ? bw : fw;
+        int d;
+        int u = heap_pop_min(&side->heap, &d);
+        if (d >= best) {
+            heap_clear(&side->heap); // this side cannot improve the meeting point any more
+            continue;
+        }
+        settledCount++;
+        
+        int du = side_dist(qc, other, u);
+        if (du != MAX_DISTANCE && d + du < best) {
+            best = d + du;
+            meet = u;
+        }
+        
+        // stall-on-demand: skip u if a higher city already reaches it more cheaply
+        const int *stallOffsets = forward ? ch->downOffsets : ch->upOffsets;
+        const ChEdge *stallEdges = forward ? ch->downEdges : ch->upEdges;
+        int stalled = 0;
+        for (int e = stallOffsets[u]; e < stallOffsets[u + 1]; ++e) {
+            int dx = side_dist(qc, side, stallEdges[e].target);
+            if (dx != MAX_DISTANCE && dx + stallEdges[e].weight < d) {
+                stalled = 1;
+                break;
+            }
+        }
+        if (stalled) continue;
+        
+        const int *offsets = forward ? ch->upOffsets : ch->downOffsets;
+        const ChEdge *edges = forward ? ch->upEdges : ch->downEdges;
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+            int v = edges[e].target;
+            int nd = d + edges[e].weight;
+            if (nd < side_dist(qc, side, v)) {
+                side_set(qc, side, v, nd, u);
+                side->aux[v] = edges[e].middle;
+                heap_push_or_decrease(&side->heap, v, nd);
+            }
+        }
+    }
+    
+    if (meet != -1) {
+        // the forward chain runs from meet back to the source, so flip it first
+        int chainLen = 0;
+        for (int cur = meet; cur != sourceIdx; cur = fw->link[cur]) {
+            chainLen++;
+        }
+        int *chain = qc->queue;
+        int at = chainLen;
+        for (int cur = meet; cur != sourceIdx; cur = fw->link[cur]) {
+            chain[--at] = cur;
+        }
+        
+        int len = 0;
+        path[len++] = source;
+        int from = sourceIdx;
+        for (int i = 0; i < chainLen; ++i) {
+            unpack_edge(ch, from, chain[i], fw->aux[chain[i]], path, &len);
+            from = chain[i];
+        }
+        for (int cur = meet; bw->link[cur] != -1; cur = bw->link[cur]) {
+            unpack_edge(ch, cur, bw->link[cur], bw->aux[cur], path, &len);
+        }
+        *pathLength = len;
+    }
+    if (settled != NULL) *settled = settledCount;
+    return meet == -1 ? -1 : best;
+}
+
+int ch_shortest_path(const ContractionHierarchy *ch, int source, int dest, int *path, int *pathLength, int *settled) {
+    if (ch == NULL) return -1;
+    
+    QueryContext *qc = query_context_create(ch->cityCount, 0);
+    int result = ch_shortest_path_ctx(ch, qc, source, dest, path, pathLength, settled);
+    query_context_free(qc);
+    return result;
+}
+
+#define CH_VERIFY_REPORTS 10
+
+// sum of the real routes along path, -1 when two consecutive cities have no route
+static long long route_sum(const FrozenGraph *fg, const int *path, int length) {
+    long long total = 0;
+    for (int i = 0; i + 1 < length; ++i) {
+        int u = frozen_find_city(fg, path[i]);
+        int v = frozen_find_city(fg, path[i + 1]);
+        int best = -1;
+        for (int e = u == -1 ? 0 : fg->offsets[u]; u != -1 && e < fg->offsets[u + 1]; ++e) {
+            if (fg->edges[e].dest == v && (best == -1 || fg->edges[e].distance < best)) best = fg->edges[e].distance;
+        }
+        if (best == -1) return -1;
+        total += best;
+    }
+    return total;
+}
+
+// Differential check of ch against frozen_shortest_path on `pairs` random city
+// pairs (xorshift from seed): distances must be equal, and every returned path
+// must run from source to destination over real routes adding up to it. The
+// first mismatches go to stderr. Returns the mismatch count, -1 if the check
+// could not run.
+int ch_verify(const ContractionHierarchy *ch, const FrozenGraph *fg, int pairs, unsigned int seed) {
+    if (ch == NULL || fg == NULL || ch->cityCount != fg->cityCount) return -1;
+    if (fg->cityCount == 0) return 0;
+    
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int *path = malloc(fg->cityCount * sizeof(int));
+    int *other = malloc(fg->cityCount * sizeof(int));
+    if (qc == NULL || path == NULL || other == NULL) {
+        query_context_free(qc);
+        free(path);
+        free(other);
+        return -1;
+    }
+    
+    unsigned int x = seed != 0 ? seed : 1;
+    int mismatches = 0;
+    for (int q = 0; q < pairs; ++q) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        int from = fg->ids[x % fg->cityCount];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        int to = fg->ids[x % fg->cityCount];
+        
+        int wantLength = 0;
+        int gotLength = 0;
+        int want = frozen_shortest_path_ctx(fg, qc, from, to, other, &wantLength, NULL);
+        int got = ch_shortest_path_ctx(ch, qc, from, to, path, &gotLength, NULL);
+        int ok = got == want;
+        if (ok && got >= 0) {
+            ok = gotLength > 0 && path[0] == from && path[gotLength - 1] == to && route_sum(fg, path, gotLength) == got;
+        }
+        if (!ok && mismatches++ < CH_VERIFY_REPORTS) {
+            fprintf(stderr, "ch mismatch %d -> %d: got %d, Dijkstra %d\n", from, to, got, want);
+        }
+    }
+    
+    query_context_free(qc);
+    free(path);
+    free(other);
+    return mismatches;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef CH_H
+#define CH_H
+
+#include "graph.h"
+
+typedef struct {
+    int target;
+    int weight;
+    int middle; // dense index of the city a shortcut bypasses, -1 for a real route
+} ChEdge;
+
+typedef struct {
+    int cityCount;
+    int shortcutCount;
+    int *ids;            // dense index -> city id
+    IdIndex index;       // city id -> dense index
+    int *rank;           // contraction order
+    int *upOffsets;      // v -> higher ranked cities, searched from the source
+    ChEdge *upEdges;
+    int *downOffsets;    // higher ranked cities -> v (target holds the origin), searched from the destination
+    ChEdge *downEdges;
+} ContractionHierarchy;
+
+ContractionHierarchy *ch_build(Graph *g);
+ContractionHierarchy *frozen_ch_build(const FrozenGraph *fg);
+void ch_free(ContractionHierarchy *ch);
+int ch_shortest_path(const ContractionHierarchy *ch, int source, int dest, int *path, int *pathLength, int *settled);
+int ch_shortest_path_ctx(const ContractionHierarchy *ch, QueryContext *qc, int source, int dest, int *path, int *pathLength, int *settled);
+int ch_verify(const ContractionHierarchy *ch, const FrozenGraph *fg, int pairs, unsigned int seed);
+
+#endif
\ No newline at end of file
@@ -1,417 +1,1069 @@
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <limits.h>
-#include "graph.h"
-
-int find_city_index(Graph *g, int cityId) {
-    for (int i = 0; i < g->cityCount; ++i) {
-        if (g->cities[i].id == cityId) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-
-static int city_has_edge_to(City *c, int destId) {
-    for (int i = 0; i < c->edgeCount; ++i) {
-        if (c->edges[i].destId == destId) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-void ensure_city_capacity(Graph *g) {
-    if (g->cityCount >= g->cityCap) {
-        int newCap = g->cityCap ? g->cityCap * 2 : 4;
-        City *temp = realloc(g->cities, newCap * sizeof(City));
-        if (temp == NULL) return;
-        g->cities = temp;
-        g->cityCap = newCap;
-    }
-}
-
-static void ensure_edge_capacity(City *c) {
-    if (c->edgeCount >= c->edgeCap) {
-        int newCap = c->edgeCap ? c->edgeCap * 2 : 4;
-        Edge *temp = realloc(c->edges, newCap * sizeof(Edge));
-        if (temp == NULL) {
-            fprintf(stderr, "Memory allocation failed\n");
-            exit(EXIT_FAILURE);
-        }
-        c->edges = temp;
-        c->edgeCap = newCap;
-    }
-}
-
-void init_graph(Graph *g) {
-    if (g == NULL) return;
-    g->cities = NULL;
-    g->cityCount = 0;
-    g->cityCap = 0;
-}
-
-void free_graph(Graph *g) {
-    if (g == NULL) return;
-    
-    for (int i = 0; i < g->cityCount; ++i) { //freeing all allocated mem of every city
-        free(g->cities[i].name);
-        free(g->cities[i].edges);
-    }
-    free(g->cities); //finally freeing the cities array location itself
-    g->cities = NULL;
-    g->cityCount = 0;
-    g->cityCap = 0;
-}
-
-void add_city(Graph *g, int cityId, const char *name) {
-    if (g == NULL || name == NULL) return;
-    
-    if (find_city_index(g, cityId) != -1) {
-        printf("City with ID %d already exists\n", cityId);
-        return;
-    }
-    
-    ensure_city_capacity(g);
-    City *c = &g->cities[g->cityCount++];
-    c->id = cityId;
-    c->name = copy_string(name);
-    c->edges = NULL;
-    c->edgeCount = 0;
-    c->edgeCap = 0;
-}
-
-void add_route(Graph *g, int from, int to, int distance) {
-    if (g == NULL) return;
-    
-    int ai = find_city_index(g, from); //from city
-    int bi = find_city_index(g, to); //to city
-    
-    if (ai == -1) {
-        printf("Source city %d not found\n", from);
-        return;
-    }
-    if (bi == -1) {
-        printf("Destination city %d not found\n", to);
-        return;
-    }
-    if (from == to) {
-        printf("Cannot create route to same city\n");
-        return;
-    }
-    
-    City *c = &g->cities[ai];
-    if (city_has_edge_to(c, to)) {
-        printf("Route %d -> %d already exists\n", from, to);
-        return;
-    }
-    
-    ensure_edge_capacity(c);
-    c->edges[c->edgeCount].destId = to;
-    c->edges[c->edgeCount].distance = distance;
-    c->edgeCount++;
-    printf("Added route %d -> %d (distance: %d km)\n", from, to, distance);
-}
-
-void remove_route(Graph *g, int from, int to) {
-    if (g == NULL) return;
-    
-    int ai = find_city_index(g, from);
-    if (ai == -1) {
-        printf("Source city %d not found\n", from);
-        return;
-    }
-    
-    City *c = &g->cities[ai];
-    for (int i = 0; i < c->edgeCount; ++i) {
-        if (c->edges[i].destId == to) {
-            for (int j = i; j + 1 < c->edgeCount; ++j) {
-                c->edges[j] = c->edges[j + 1];
-            }
-            c->edgeCount--;
-            printf("Removed route %d -> %d\n", from, to);
-            return;
-        }
-    }
-    printf("Route %d -> %d does not exist\n", from, to);
-}
-
-int can_reach(Graph *g, int from, int to) {
-    if (g == NULL) return 0;
-    
-    int ai = find_city_index(g, from);
-    int bi = find_city_index(g, to);
-    
-    if (ai == -1 || bi == -1) {
-        return 0;
-    }
-    
-    if (from == to) {
-        return 1;
-    }
-    
-    int n = g->cityCount;
-    char *visited = calloc(n, sizeof(char)); // we need to initialize to 0
-    int *queue = malloc(n * sizeof(int));
-    
-    if (visited == NULL || queue == NULL) {
-        return 0;
-    }
-    
-    int front = 0, rear = 0;
-    queue[rear++] = ai;
-    visited[ai] = 1;
-    
-    while (front < rear) {
-        int cur = queue[front++];
-        
-        if (g->cities[cur].id == to) {
-            free(queue);
-            free(visited);
-            return 1;
-        }
-        
-        City *c = &g->cities[cur];
-        for (int i = 0; i < c->edgeCount; ++i) {
-            int ni = find_city_index(g, c->edges[i].destId);
-            if (ni != -1 && !visited[ni]) {
-                queue[rear++] = ni;
-                visited[ni] = 1;
-            }
-        }
-    }
-    
-    free(queue);
-    free(visited);
-    return 0;
-}
-
-void print_cities(Graph *g) {
-    if (g == NULL) return;
-    
-    printf("\n=== Cities ===\n");
-    if (g->cityCount == 0) {
-        printf("No cities in the network\n");
-        return;
-    }
-    
-    for (int i = 0; i < g->cityCount; ++i) {
-        printf("ID %d: %s\n", g->cities[i].id, g->cities[i].name);
-    }
-}
-
-void print_graph(Graph *g) {
-    if (g == NULL) return;
-    
-    printf("\n=== Route Map ===\n");
-    if (g->cityCount == 0) {
-        printf("No cities in the network\n");
-        return;
-    }
-    
-    for (int i = 0; i < g->cityCount; ++i) {
-        City *c = &g->cities[i];
-        printf("%d (%s) ->", c->id, c->name);
-        
-        if (c->edgeCount == 0) {
-            printf(" [no outgoing routes]");
-        } else {
-            for (int j = 0; j < c->edgeCount; ++j) {
-                int neighborIdx = find_city_index(g, c->edges[j].destId);
-                if (neighborIdx != -1) {
-                    printf(" %d(%s, %dkm)", c->edges[j].destId, 
-                           g->cities[neighborIdx].name, c->edges[j].distance);
-                } else {
-                    printf(" %d(?, %dkm)", c->edges[j].destId, c->edges[j].distance);
-                }
-            }
-        }
-        printf("\n");
-    }
-}
-
-int dijkstra_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength) {
-    if (g == NULL || path == NULL || pathLength == NULL) return -1;
-    
-    int n = g->cityCount;
-    int *distance = malloc(n * sizeof(int));
-    int *visited = malloc(n * sizeof(int));
-    int *previous = malloc(n * sizeof(int));
-    
-    if (distance == NULL || visited == NULL || previous == NULL) {
-        free(distance);
-        free(visited);
-        free(previous);
-        return -1;
-    }
-    
-    for (int i = 0; i < n; i++) {
-        distance[i] = MAX_DISTANCE;
-        visited[i] = 0;
-        previous[i] = -1;
-    }
-    
-    int sourceIdx = find_city_index(g, source);
-    int destIdx = find_city_index(g, dest);
-    
-    if (sourceIdx == -1 || destIdx == -1) {
-        free(distance);
-        free(visited);
-        free(previous);
-        return -1;
-    }
-    
-    distance[sourceIdx] = 0;
-    
-    for (int count = 0; count < n; count++) {
-        int minDist = MAX_DISTANCE;
-        int minIdx = -1;
-        
-        for (int i = 0; i < n; i++) {
-            if (!visited[i] && distance[i] < minDist) {
-                minDist = distance[i];
-                minIdx = i;
-            }
-        }
-        
-        if (minIdx == -1) break;
-        
-        visited[minIdx] = 1;
-        
-        if (minIdx == destIdx) break;
-        
-        City *current = &g->cities[minIdx];
-        for (int i = 0; i < current->edgeCount; i++) {
-            int neighborIdx = find_city_index(g, current->edges[i].destId);
-            if (neighborIdx != -1 && !visited[neighborIdx]) {
-                int newDist = distance[minIdx] + current->edges[i].distance;
-                if (newDist < distance[neighborIdx]) {
-                    distance[neighborIdx] = newDist;
-                    previous[neighborIdx] = minIdx;
-                }
-            }
-        }
-    }
-    
-    if (distance[destIdx] == MAX_DISTANCE) {
-        free(distance);
-        free(visited);
-        free(previous);
-        return -1;
-    }
-    
-    int tempPath[n];
-    int tempLen = 0;
-    int current = destIdx;
-    
-    while (current != -1) {
-        tempPath[tempLen++] = g->cities[current].id;
-        current = previous[current];
-    }
-    
-    *pathLength = tempLen;
-    for (int i = 0; i < tempLen; i++) {
-        path[i] = tempPath[tempLen - 1 - i];
-    }
-    
-    int shortestDist = distance[destIdx];
-    free(distance);
-    free(visited);
-    free(previous);
-    return shortestDist;
-}
-
-static int paths_are_different(int *path1, int len1, int *path2, int len2) {
-    if (len1 != len2) return 1;
-    
-    for (int i = 0; i < len1; i++) {
-        if (path1[i] != path2[i]) return 1;
-    }
-    return 0;
-}
-
-static void dfs_find_alternate(Graph *g, int currentIdx, int destIdx, int *visited, 
-                               int *currentPath, int currentLen, 
-                               int *bestPath, int *bestLen, int *bestDist,
-                               int currentDist, int *shortestPath, int shortestLen) {
-    
-    if (currentIdx == destIdx) {
-        if (paths_are_different(currentPath, currentLen, shortestPath, shortestLen)) {
-            if (*bestLen == 0 || currentDist < *bestDist) {
-                *bestLen = currentLen;
-                *bestDist = currentDist;
-                for (int i = 0; i < currentLen; i++) {
-                    bestPath[i] = currentPath[i];
-                }
-            }
-        }
-        return;
-    }
-    
-    City *current = &g->cities[currentIdx];
-    for (int i = 0; i < current->edgeCount; i++) {
-        int neighborIdx = find_city_index(g, current->edges[i].destId);
-        if (neighborIdx != -1 && !visited[neighborIdx]) {
-            visited[neighborIdx] = 1;
-            currentPath[currentLen] = current->edges[i].destId;
-            
-            dfs_find_alternate(g, neighborIdx, destIdx, visited, 
-                             currentPath, currentLen + 1, 
-                             bestPath, bestLen, bestDist,
-                             currentDist + current->edges[i].distance,
-                             shortestPath, shortestLen);
-            
-            visited[neighborIdx] = 0;
-        }
-    }
-}
-
-int find_alternate_route(Graph *g, int source, int dest, int *path, int *pathLength, 
-                        int *shortestPath, int shortestLength) {
-    if (g == NULL || path == NULL || pathLength == NULL) return -1;
-    
-    int sourceIdx = find_city_index(g, source);
-    int destIdx = find_city_index(g, dest);
-    
-    if (sourceIdx == -1 || destIdx == -1) return -1;
-    
-    int n = g->cityCount;
-    int *visited = calloc(n, sizeof(int));
-    int *currentPath = malloc(n * sizeof(int));
-    int *bestPath = malloc(n * sizeof(int));
-    
-    if (visited == NULL || currentPath == NULL || bestPath == NULL) {
-        free(visited);
-        free(currentPath);
-        free(bestPath);
-        return -1;
-    }
-    
-    visited[sourceIdx] = 1;
-    currentPath[0] = source;
-    int bestLen = 0;
-    int bestDist = MAX_DISTANCE;
-    
-    dfs_find_alternate(g, sourceIdx, destIdx, visited, currentPath, 1, 
-                      bestPath, &bestLen, &bestDist, 0, shortestPath, shortestLength);
-    
-    if (bestLen == 0) {
-        free(visited);
-        free(currentPath);
-        free(bestPath);
-        return -1;
-    }
-    
-    *pathLength = bestLen;
-    for (int i = 0; i < bestLen; i++) {
-        path[i] = bestPath[i];
-    }
-    
-    free(visited);
-    free(currentPath);
-    free(bestPath);
-    return bestDist;
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "graph.h"
+#include "heap.h"
+#include "ksp.h"
+#include "snapshot.h"
+#include "reach.h"
+#include "landmark.h"
+#include "overlay.h"
+#include "pathcache.h"
+#include "query.h"
+#include "stats.h"
+#include "spt.h"
+
+static unsigned int hash_city_id(int cityId) {
+    unsigned int h = (unsigned int)cityId * 2654435761u; // Knuth multiplicative hash
+    return h ^ (h >> 16);
+}
+
+int id_index_find(const IdIndex *ix, int cityId) {
+    STATS_ADD(lookups, 1);
+    if (ix->slots == NULL) return -1;
+    
+    unsigned int slot = hash_city_id(cityId) & ix->mask;
+    while (ix->slots[slot].index != -1) {
+        if (ix->slots[slot].id == cityId) {
+            return ix->slots[slot].index;
+        }
+        slot = (slot + 1) & ix->mask;
+    }
+    return -1;
+}
+
+static void id_index_insert(IdIndex *ix, int cityId, int index) {
+    unsigned int slot = hash_city_id(cityId) & ix->mask;
+    while (ix->slots[slot].index != -1) {
+        slot = (slot + 1) & ix->mask;
+    }
+    ix->slots[slot].id = cityId;
+    ix->slots[slot].index = index;
+}
+
+// allocates an empty index with room for `capacity` cities at load <= 1/2
+static void id_index_reset(IdIndex *ix, int capacity) {
+    int slotCount = 8;
+    while (slotCount < capacity * 2) slotCount *= 2;
+    
+    IdSlot *slots = malloc(slotCount * sizeof(IdSlot));
+    if (slots == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < slotCount; ++i) {
+        slots[i].index = -1;
+    }
+    
+    free(ix->slots);
+    ix->slots = slots;
+    ix->mask = slotCount - 1;
+}
+
+double great_circle_km(double lat1, double lon1, double lat2, double lon2) {
+    const double earthRadius = 6371.0;
+    const double toRad = 3.14159265358979323846 / 180.0;
+    
+    double dLat = (lat2 - lat1) * toRad;
+    double dLon = (lon2 - lon1) * toRad;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1 * toRad) * cos(lat2 * toRad) * sin(dLon / 2) * sin(dLon / 2);
+    if (a > 1.0) a = 1.0;
+    return 2.0 * earthRadius * asin(sqrt(a));
+}
+
+void id_index_build(IdIndex *ix, const int *ids, int count) {
+    ix->slots = NULL;
+    id_index_reset(ix, count);
+    for (int i = 0; i < count; ++i) {
+        id_index_insert(ix, ids[i], i);
+    }
+}
+
+void id_index_free(IdIndex *ix) {
+    free(ix->slots);
+    ix->slots = NULL;
+    ix->mask = 0;
+}
+
+int find_city_index(Graph *g, int cityId) {
+    return id_index_find(&g->index, cityId);
+}
+
+// backward-shift deletion keeps every probe run unbroken, so no tombstones are needed
+static void id_index_remove(IdIndex *ix, int cityId) {
+    if (ix->slots == NULL) return;
+    
+    unsigned int slot = hash_city_id(cityId) & ix->mask;
+    while (ix->slots[slot].index != -1 && ix->slots[slot].id != cityId) {
+        slot = (slot + 1) & ix->mask;
+    }
+    if (ix->slots[slot].index == -1) return;
+    
+    unsigned int hole = slot;
+    for (unsigned int next = (slot + 1) & ix->mask; ix->slots[next].index != -1; next = (next + 1) & ix->mask) {
+        unsigned int home = hash_city_id(ix->slots[next].id) & ix->mask;
+        // the entry may fill the hole only if the hole lies on its probe path
+        if (((next - home) & ix->mask) >= ((next - hole) & ix->mask)) {
+            ix->slots[hole] = ix->slots[next];
+            hole = next;
+        }
+    }
+    ix->slots[hole].index = -1;
+}
+
+static void id_index_set(IdIndex *ix, int cityId, int index) {
+    unsigned int slot = hash_city_id(cityId) & ix->mask;
+    while (ix->slots[slot].index != -1) {
+        if (ix->slots[slot].id == cityId) {
+            ix->slots[slot].index = index;
+            return;
+        }
+        slot = (slot + 1) & ix->mask;
+    }
+}
+
+// position of the route to destId in c->edges, or -1
+static int city_find_edge(const City *c, int destId) {
+    if (c->destIndex.slots != NULL) return id_index_find(&c->destIndex, destId);
+    
+    for (int i = 0; i < c->edgeCount; ++i) {
+        if (c->edges[i].destId == destId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void city_index_rebuild(City *c) {
+    id_index_reset(&c->destIndex, c->edgeCount * 2); // room to double before the next rebuild
+    for (int i = 0; i < c->edgeCount; ++i) {
+        id_index_insert(&c->destIndex, c->edges[i].destId, i);
+    }
+}
+
+// indexes the route just appended at the end of c->edges
+static void city_index_appended(City *c) {
+    if (c->destIndex.slots == NULL) {
+        if (c->edgeCount > EDGE_INDEX_THRESHOLD) city_index_rebuild(c);
+    } else if (c->edgeCount * 2 > c->destIndex.mask + 1) {
+        city_index_rebuild(c);
+    } else {
+        id_index_insert(&c->destIndex, c->edges[c->edgeCount - 1].destId, c->edgeCount - 1);
+    }
+}
+
+static void city_remove_edge(City *c, int pos) {
+    int last = c->edgeCount - 1;
+    if (c->destIndex.slots != NULL) id_index_remove(&c->destIndex, c->edges[pos].destId);
+    if (pos != last) {
+        c->edges[pos] = c->edges[last];
+        if (c->destIndex.slots != NULL) id_index_set(&c->destIndex, c->edges[pos].destId, pos);
+    }
+    c->edgeCount--;
+}
+
+void ensure_city_capacity(Graph *g) {
+    if (g->cityCount >= g->cityCap) {
+        int newCap = g->cityCap ? g->cityCap * 2 : 4;
+        City *temp = realloc(g->cities, newCap * sizeof(City));
+        if (temp == NULL) return;
+        g->cities = temp;
+        g->cityCap = newCap;
+        id_index_reset(&g->index, newCap);
+        for (int i = 0; i < g->cityCount; ++i) {
+            id_index_insert(&g->index, g->cities[i].id, i);
+        }
+    }
+}
+
+// edge arrays come from the graph's block pool; the outgrown array goes back to it
+static void ensure_edge_capacity(Graph *g, City *c, int needed) {
+    if (needed <= c->edgeCap) return;
+    
+    int newCap;
+    Edge *block = block_pool_alloc(&g->edgePool, needed, &newCap);
+    if (c->edgeCount > 0) {
+        memcpy(block, c->edges, c->edgeCount * sizeof(Edge));
+    }
+    block_pool_release(&g->edgePool, c->edges, c->edgeCap);
+    c->edges = block;
+    c->edgeCap = newCap;
+}
+
+// the cached snapshot is rebuilt lazily by the next query after an edit
+static void drop_snapshot(Graph *g) {
+    free_frozen_graph(g->frozen);
+    g->frozen = NULL;
+}
+
+// removals can split components, so the reachability index is rebuilt on demand
+static void drop_reach_index(Graph *g) {
+    reach_free(g->reach);
+    g->reach = NULL;
+    g->reachStale = 1;
+}
+
+// only new or shorter routes and new cities can break the landmark bounds
+static void drop_landmarks(Graph *g) {
+    landmark_free(g->landmarks);
+    g->landmarks = NULL;
+}
+
+// the overlay's partition depends only on which routes exist
+static void drop_overlay(Graph *g) {
+    overlay_free(g->overlay);
+    g->overlay = NULL;
+}
+
+const FrozenGraph *graph_snapshot(Graph *g) {
+    if (g->frozen == NULL) {
+        g->frozen = graph_freeze(g);
+    }
+    return g->frozen;
+}
+
+const LandmarkIndex *graph_landmarks(Graph *g) {
+    if (g->landmarks == NULL) {
+        g->landmarks = landmark_build(graph_snapshot(g), ALT_LANDMARKS);
+    }
+    return g->landmarks;
+}
+
+// partitioned on first use; after distance changes only the customization runs again
+const Overlay *graph_overlay(Graph *g) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    if (fg == NULL) return NULL;
+    
+    if (g->overlay == NULL) {
+        g->overlay = overlay_build(fg, OVERLAY_CLIQUE_FACTOR);
+        if (g->overlay == NULL) return NULL;
+    }
+    if (!g->overlay->customized || g->overlay->version != g->version) {
+        if (overlay_customize(g->overlay, fg, 0) != 0) {
+            drop_overlay(g);
+            return NULL;
+        }
+        g->overlay->version = g->version;
+    }
+    return g->overlay;
+}
+
+// workspace for the graph-level query calls, sized to the current snapshot
+QueryContext *graph_query_context(Graph *g) {
+    const FrozenGraph *fg = graph_snapshot(g);
+    if (fg == NULL) return NULL;
+    
+    if (g->scratch == NULL) {
+        g->scratch = query_context_create(fg->cityCount, fg->edgeCount);
+    } else if (query_context_fit(g->scratch, fg->cityCount, fg->edgeCount) != 0) {
+        return NULL;
+    }
+    return g->scratch;
+}
+
+void init_graph(Graph *g) {
+    if (g == NULL) return;
+    g->cities = NULL;
+    g->cityCount = 0;
+    g->cityCap = 0;
+    g->index.slots = NULL;
+    g->index.mask = 0;
+    g->frozen = NULL;
+    g->reach = NULL;
+    g->reachStale = 1;
+    g->version = 0;
+    g->cache = NULL;
+    g->scratch = NULL;
+    g->trees = NULL;
+    g->landmarks = NULL;
+    g->overlay = NULL;
+    arena_init(&g->names, NAME_ARENA_BLOCK);
+    block_pool_init(&g->edgePool, sizeof(Edge), EDGE_SLAB_SIZE);
+}
+
+void free_graph(Graph *g) {
+    if (g == NULL) return;
+    
+    // names and edge arrays live in the graph's arenas; only hub destination indexes are freed per city
+    for (int i = 0; i < g->cityCount; ++i) {
+        id_index_free(&g->cities[i].destIndex);
+    }
+    arena_free(&g->names);
+    block_pool_free(&g->edgePool);
+    free(g->cities);
+    free(g->index.slots);
+    drop_snapshot(g);
+    drop_reach_index(g);
+    path_cache_free(g->cache);
+    g->cache = NULL;
+    query_context_free(g->scratch);
+    g->scratch = NULL;
+    spt_free(g->trees);
+    g->trees = NULL;
+    drop_landmarks(g);
+    drop_overlay(g);
+    g->cities = NULL;
+    g->cityCount = 0;
+    g->cityCap = 0;
+    g->index.slots = NULL;
+    g->index.mask = 0;
+}
+
+void add_city(Graph *g, int cityId, const char *name, double latitude, double longitude) {
+    if (g == NULL || name == NULL) return;
+    
+    if (find_city_index(g, cityId) != -1) {
+        printf("City with ID %d already exists\n", cityId);
+        return;
+    }
+    
+    ensure_city_capacity(g);
+    id_index_insert(&g->index, cityId, g->cityCount);
+    City *c = &g->cities[g->cityCount++];
+    c->id = cityId;
+    c->name = arena_strdup(&g->names, name);
+    c->latitude = latitude;
+    c->longitude = longitude;
+    c->edges = NULL;
+    c->edgeCount = 0;
+    c->edgeCap = 0;
+    c->destIndex.slots = NULL;
+    c->destIndex.mask = 0;
+    drop_snapshot(g);
+    drop_reach_index(g);
+    drop_landmarks(g);
+    drop_overlay(g);
+    spt_city_added(g->trees);
+}
+
+int graph_add_route(Graph *g, int from, int to, int distance) {
+    if (g == NULL) return ROUTE_NO_SOURCE;
+    
+    int ai = find_city_index(g, from); //from city
+    int bi = find_city_index(g, to); //to city
+    
+    if (ai == -1) return ROUTE_NO_SOURCE;
+    if (bi == -1) return ROUTE_NO_DEST;
+    if (from == to) return ROUTE_SAME_CITY;
+    if (distance < 0) return ROUTE_BAD_DISTANCE;
+    
+    City *c = &g->cities[ai];
+    if (city_find_edge(c, to) != -1) return ROUTE_EXISTS;
+    
+    ensure_edge_capacity(g, c, c->edgeCount + 1);
+    c->edges[c->edgeCount].destId = to;
+    c->edges[c->edgeCount].distance = distance;
+    c->edgeCount++;
+    city_index_appended(c);
+    drop_snapshot(g);
+    if (g->reach != NULL) reach_add_route(g->reach, ai, bi);
+    drop_landmarks(g);
+    drop_overlay(g);
+    g->version++; // a new route can shorten any cached path
+    spt_route_added(g->trees, g, ai, bi, distance);
+    return ROUTE_OK;
+}
+
+void add_route(Graph *g, int from, int to, int distance) {
+    if (g == NULL) return;
+    
+    switch (graph_add_route(g, from, to, distance)) {
+        case ROUTE_NO_SOURCE:
+            printf("Source city %d not found\n", from);
+            break;
+        case ROUTE_NO_DEST:
+            printf("Destination city %d not found\n", to);
+            break;
+        case ROUTE_SAME_CITY:
+            printf("Cannot create route to same city\n");
+            break;
+        case ROUTE_EXISTS:
+            printf("Route %d -> %d already exists\n", from, to);
+            break;
+        case ROUTE_BAD_DISTANCE:
+            printf("Route distance cannot be negative\n");
+            break;
+        default:
+            printf("Added route %d -> %d (distance: %d km)\n", from, to, distance);
+            break;
+    }
+}
+
+int graph_remove_route(Graph *g, int from, int to) {
+    if (g == NULL) return ROUTE_NO_SOURCE;
+    
+    int ai = find_city_index(g, from);
+    if (ai == -1) return ROUTE_NO_SOURCE;
+    
+    City *c = &g->cities[ai];
+    int pos = city_find_edge(c, to);
+    if (pos == -1) return ROUTE_NOT_FOUND;
+    
+    city_remove_edge(c, pos);
+    drop_snapshot(g);
+    drop_reach_index(g);
+    drop_overlay(g);
+    g->version++;
+    path_cache_route_removed(g->cache, g->version - 1, g->version, from, to);
+    if (g->trees != NULL) spt_route_removed(g->trees, g, ai, find_city_index(g, to));
+    return ROUTE_OK;
+}
+
+int graph_set_route_distance(Graph *g, int from, int to, int distance) {
+    if (g == NULL) return ROUTE_NO_SOURCE;
+    
+    int ai = find_city_index(g, from);
+    if (ai == -1) return ROUTE_NO_SOURCE;
+    
+    City *c = &g->cities[ai];
+    int pos = city_find_edge(c, to);
+    if (pos == -1) return ROUTE_NOT_FOUND;
+    if (distance < 0) return ROUTE_BAD_DISTANCE;
+    
+    int old = c->edges[pos].distance;
+    if (old == distance) return ROUTE_OK;
+    
+    c->edges[pos].distance = distance;
+    drop_snapshot(g); // reachability does not depend on distances
+    g->version++;
+    // a longer route only spoils the cached paths that use it, a shorter one can improve any
+    if (distance > old) path_cache_route_removed(g->cache, g->version - 1, g->version, from, to);
+    else drop_landmarks(g);
+    if (g->trees != NULL) spt_route_changed(g->trees, g, ai, find_city_index(g, to), old, distance);
+    return ROUTE_OK;
+}
+
+void remove_route(Graph *g, int from, int to) {
+    if (g == NULL) return;
+    
+    switch (graph_remove_route(g, from, to)) {
+        case ROUTE_NO_SOURCE:
+            printf("Source city %d not found\n", from);
+            break;
+        case ROUTE_NOT_FOUND:
+            printf("Route %d -> %d does not exist\n", from, to);
+            break;
+        default:
+            printf("Removed route %d -> %d\n", from, to);
+            break;
+    }
+}
+
+void set_route_distance(Graph *g, int from, int to, int distance) {
+    if (g == NULL) return;
+    
+    switch (graph_set_route_distance(g, from, to, distance)) {
+        case ROUTE_NO_SOURCE:
+            printf("Source city %d not found\n", from);
+            break;
+        case ROUTE_NOT_FOUND:
+            printf("Route %d -> %d does not exist\n", from, to);
+            break;
+        case ROUTE_BAD_DISTANCE:
+            printf("Route distance cannot be negative\n");
+            break;
+        default:
+            printf("Route %d -> %d is now %d km\n", from, to, distance);
+            break;
+    }
+}
+
+void graph_reserve_cities(Graph *g, int capacity) {
+    if (g == NULL || capacity <= g->cityCap) return;
+    
+    City *temp = realloc(g->cities, capacity * sizeof(City));
+    if (temp == NULL) return;
+    g->cities = temp;
+    g->cityCap = capacity;
+    id_index_reset(&g->index, capacity);
+    for (int i = 0; i < g->cityCount; ++i) {
+        id_index_insert(&g->index, g->cities[i].id, i);
+    }
+}
+
+// Silent batch insert. A counting pass buckets the routes by origin, each
+// bucket is deduplicated with a per-destination stamp, and every origin's
+// edge array grows exactly once. Duplicate pairs in the batch keep their
+// shortest distance; pairs that already exist in the graph are left alone,
+// and so are routes with an unknown city or a negative distance. Returns
+// the number of routes added or -1 when out of memory.
+int add_routes_bulk(Graph *g, RouteSpec *routes, int count) {
+    if (g == NULL || routes == NULL || count < 0) return -1;
+    
+    int n = g->cityCount;
+    int *start = calloc(n + 1, sizeof(int));
+    int *stamp = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *slot = malloc((n > 0 ? n : 1) * sizeof(int));
+    Edge *bucketed = malloc((count > 0 ? count : 1) * sizeof(Edge));
+    int *fromIdx = malloc((count > 0 ? count : 1) * sizeof(int));
+    
+    if (start == NULL || stamp == NULL || slot == NULL || bucketed == NULL || fromIdx == NULL) {
+        free(start);
+        free(stamp);
+        free(slot);
+        free(bucketed);
+        free(fromIdx);
+        return -1;
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        int ai = find_city_index(g, routes[i].from);
+        int bi = find_city_index(g, routes[i].to);
+        fromIdx[i] = (ai == -1 || bi == -1 || ai == bi || routes[i].distance < 0) ? -1 : ai;
+        if (fromIdx[i] != -1) start[ai + 1]++;
+    }
+    for (int i = 0; i < n; ++i) {
+        start[i + 1] += start[i];
+        stamp[i] = -1;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (fromIdx[i] == -1) continue;
+        Edge *e = &bucketed[start[fromIdx[i]]++];
+        e->destId = find_city_index(g, routes[i].to); // dense index until copied out
+        e->distance = routes[i].distance;
+    }
+    // the fill loop advanced every start[i] to the next bucket's start
+    for (int i = n; i > 0; --i) {
+        start[i] = start[i - 1];
+    }
+    start[0] = 0;
+    
+    int added = 0;
+    for (int ai = 0; ai < n; ++ai) {
+        if (start[ai] == start[ai + 1]) continue;
+        
+        City *c = &g->cities[ai];
+        int indexed = c->destIndex.slots != NULL; // a hub's routes are looked up, not stamped
+        for (int j = 0; !indexed && j < c->edgeCount; ++j) {
+            int di = find_city_index(g, c->edges[j].destId);
+            if (di != -1) {
+                stamp[di] = ai;
+                slot[di] = -1; // already routed, leave it alone
+            }
+        }
+        
+        // compact the bucket down to one entry per new destination
+        int fresh = start[ai];
+        for (int j = start[ai]; j < start[ai + 1]; ++j) {
+            int di = bucketed[j].destId;
+            if (stamp[di] != ai) {
+                stamp[di] = ai;
+                if (indexed && city_find_edge(c, g->cities[di].id) != -1) {
+                    slot[di] = -1;
+                    continue;
+                }
+                slot[di] = fresh;
+                bucketed[fresh++] = bucketed[j];
+            } else if (slot[di] != -1 && bucketed[j].distance < bucketed[slot[di]].distance) {
+                bucketed[slot[di]].distance = bucketed[j].distance;
+            }
+        }
+        
+        int newCount = fresh - start[ai];
+        ensure_edge_capacity(g, c, c->edgeCount + newCount);
+        for (int j = start[ai]; j < fresh; ++j) {
+            c->edges[c->edgeCount].destId = g->cities[bucketed[j].destId].id;
+            c->edges[c->edgeCount].distance = bucketed[j].distance;
+            c->edgeCount++;
+            city_index_appended(c);
+        }
+        added += newCount;
+    }
+    
+    free(start);
+    free(stamp);
+    free(slot);
+    free(bucketed);
+    free(fromIdx);
+    drop_snapshot(g);
+    drop_reach_index(g);
+    drop_landmarks(g);
+    drop_overlay(g);
+    g->version++;
+    spt_rebuild(g->trees, g);
+    return added;
+}
+
+static int graph_can_reach(Graph *g, int from, int to) {
+    if (g == NULL) return 0;
+    
+    if (g->reachStale) {
+        g->reach = reach_build(graph_snapshot(g));
+        g->reachStale = 0; // a failed build leaves reach NULL until the next structural edit
+    }
+    
+    if (g->reach != NULL) {
+        int ai = find_city_index(g, from);
+        int bi = find_city_index(g, to);
+        if (ai == -1 || bi == -1) return 0;
+        return reach_query(g->reach, ai, bi);
+    }
+    
+    QueryContext *qc = graph_query_context(g);
+    if (qc == NULL) return 0;
+    return frozen_can_reach_ctx(g->frozen, qc, from, to);
+}
+
+int can_reach(Graph *g, int from, int to) {
+    STATS_BEGIN(scope);
+    int result = graph_can_reach(g, from, to);
+    STATS_END(scope, STATS_CAN_REACH);
+    return result;
+}
+
+void print_cities(Graph *g) {
+    if (g == NULL) return;
+    
+    printf("\n=== Cities ===\n");
+    if (g->cityCount == 0) {
+        printf("No cities in the network\n");
+        return;
+    }
+    
+    for (int i = 0; i < g->cityCount; ++i) {
+        printf("ID %d: %s (%.4f, %.4f)\n", g->cities[i].id, g->cities[i].name,
+               g->cities[i].latitude, g->cities[i].longitude);
+    }
+}
+
+void print_graph(Graph *g) {
+    if (g == NULL) return;
+    
+    printf("\n=== Route Map ===\n");
+    if (g->cityCount == 0) {
+        printf("No cities in the network\n");
+        return;
+    }
+    
+    for (int i = 0; i < g->cityCount; ++i) {
+        City *c = &g->cities[i];
+        printf("%d (%s) ->", c->id, c->name);
+        
+        if (c->edgeCount == 0) {
+            printf(" [no outgoing routes]");
+        } else {
+            for (int j = 0; j < c->edgeCount; ++j) {
+                int neighborIdx = find_city_index(g, c->edges[j].destId);
+                if (neighborIdx != -1) {
+                    printf(" %d(%s, %dkm)", c->edges[j].destId, 
+                           g->cities[neighborIdx].name, c->edges[j].distance);
+                } else {
+                    printf(" %d(?, %dkm)", c->edges[j].destId, c->edges[j].distance);
+                }
+            }
+        }
+        printf("\n");
+    }
+}
+
+// capacity 0 turns the cache off
+void graph_enable_path_cache(Graph *g, int capacity) {
+    if (g == NULL) return;
+    path_cache_free(g->cache);
+    g->cache = path_cache_create(capacity);
+}
+
+// the tree from cityId is kept up to date by every edit from now on
+const ShortestPathTree *graph_track_source(Graph *g, int cityId) {
+    if (g == NULL) return NULL;
+    
+    int si = find_city_index(g, cityId);
+    if (si == -1) return NULL;
+    if (g->trees == NULL) {
+        g->trees = spt_create(g);
+        if (g->trees == NULL) return NULL;
+    }
+    return spt_track(g->trees, g, si);
+}
+
+int graph_untrack_source(Graph *g, int cityId) {
+    if (g == NULL) return -1;
+    return spt_untrack(g->trees, find_city_index(g, cityId));
+}
+
+static int graph_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength) {
+    if (g == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    // a tracked source answers by walking its tree
+    const ShortestPathTree *t = spt_find(g->trees, find_city_index(g, source));
+    if (t != NULL) return spt_path(g, t, find_city_index(g, dest), path, pathLength);
+    
+    QueryContext *qc;
+    // unknown cities are not cached, adding one later could make its answer wrong
+    if (g->cache == NULL || find_city_index(g, source) == -1 || find_city_index(g, dest) == -1) {
+        qc = graph_query_context(g);
+        if (qc == NULL) return -1;
+        return frozen_shortest_path_ctx(g->frozen, qc, source, dest, path, pathLength, NULL);
+    }
+    
+    int dist;
+    if (path_cache_lookup(g->cache, g->version, source, dest, &dist, path, pathLength)) {
+        return dist;
+    }
+    
+    qc = graph_query_context(g);
+    if (qc == NULL) return -1;
+    dist = frozen_shortest_path_ctx(g->frozen, qc, source, dest, path, pathLength, NULL);
+    path_cache_store(g->cache, g->version, source, dest, dist, path, dist < 0 ? 0 : *pathLength);
+    return dist;
+}
+
+int dijkstra_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength) {
+    STATS_BEGIN(scope);
+    int result = graph_shortest_path(g, source, dest, path, pathLength);
+    STATS_END(scope, STATS_SHORTEST_PATH);
+    return result;
+}
+
+int find_alternate_route(Graph *g, int source, int dest, int *path, int *pathLength, 
+                        int *shortestPath, int shortestLength) {
+    if (g == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    // the scope also covers refreezing the graph and growing the workspace
+    STATS_BEGIN(scope);
+    QueryContext *qc = graph_query_context(g);
+    int result = qc == NULL ? -1 : frozen_alternate_route_ctx(g->frozen, qc, source, dest, path, pathLength,
+                                                              shortestPath, shortestLength);
+    STATS_END(scope, STATS_ALTERNATE_ROUTE);
+    return result;
+}
+
+// smallest route-km to great-circle-km ratio over all routes, so that
+// geoBound * great_circle_km(v, t) never overestimates the remaining distance
+static double compute_geo_bound(const FrozenGraph *fg) {
+    double bound = -1.0;
+    
+    for (int u = 0; u < fg->cityCount; ++u) {
+        if (isnan(fg->latitude[u]) || isnan(fg->longitude[u])) return 0.0;
+        
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            int v = fg->edges[e].dest;
+            double km = great_circle_km(fg->latitude[u], fg->longitude[u],
+                                        fg->latitude[v], fg->longitude[v]);
+            if (km < 1e-9) continue;
+            
+            double ratio = fg->edges[e].distance / km;
+            if (bound < 0 || ratio < bound) bound = ratio;
+        }
+    }
+    return bound > 0 ? bound * (1.0 - 1e-9) : 0.0;
+}
+
+FrozenGraph *graph_freeze(const Graph *g) {
+    if (g == NULL) return NULL;
+    
+    int n = g->cityCount;
+    int m = 0;
+    size_t nameBytes = 0;
+    for (int i = 0; i < n; ++i) {
+        m += g->cities[i].edgeCount;
+        nameBytes += strlen(g->cities[i].name) + 1;
+    }
+    
+    FrozenGraph *fg = malloc(sizeof(FrozenGraph));
+    if (fg == NULL) return NULL;
+    
+    fg->cityCount = n;
+    fg->edgeCount = m;
+    fg->offsets = malloc((n + 1) * sizeof(int));
+    fg->edges = malloc((m > 0 ? m : 1) * sizeof(CsrEdge));
+    fg->ids = malloc((n > 0 ? n : 1) * sizeof(int));
+    fg->revOffsets = calloc(n + 1, sizeof(int));
+    fg->revEdges = malloc((m > 0 ? m : 1) * sizeof(CsrEdge));
+    fg->nameOffsets = malloc((n > 0 ? n : 1) * sizeof(int));
+    fg->nameData = malloc(nameBytes > 0 ? nameBytes : 1);
+    fg->latitude = malloc((n > 0 ? n : 1) * sizeof(double));
+    fg->longitude = malloc((n > 0 ? n : 1) * sizeof(double));
+    fg->index.slots = NULL;
+    fg->index.mask = 0;
+    fg->mapping = NULL;
+    fg->mappingSize = 0;
+    
+    if (fg->offsets == NULL || fg->edges == NULL || fg->ids == NULL ||
+        fg->revOffsets == NULL || fg->revEdges == NULL ||
+        fg->nameOffsets == NULL || fg->nameData == NULL ||
+        fg->latitude == NULL || fg->longitude == NULL) {
+        free_frozen_graph(fg);
+        return NULL;
+    }
+    STATS_ADD(allocBytes, sizeof(FrozenGraph) + (size_t)(n + 1) * 2 * sizeof(int) + (size_t)m * 2 * sizeof(CsrEdge) +
+                          (size_t)n * (2 * sizeof(int) + 2 * sizeof(double)) + nameBytes);
+
+    id_index_reset(&fg->index, n);
+    
+    int e = 0;
+    size_t nameAt = 0;
+    for (int i = 0; i < n; ++i) {
+        const City *c = &g->cities[i];
+        fg->ids[i] = c->id;
+        id_index_insert(&fg->index, c->id, i);
+        
+        size_t len = strlen(c->name) + 1;
+        memcpy(fg->nameData + nameAt, c->name, len);
+        fg->nameOffsets[i] = (int)nameAt;
+        nameAt += len;
+        fg->latitude[i] = c->latitude;
+        fg->longitude[i] = c->longitude;
+        
+        fg->offsets[i] = e;
+        for (int j = 0; j < c->edgeCount; ++j) {
+            int di = id_index_find(&g->index, c->edges[j].destId);
+            if (di == -1) continue; // route to a city that no longer exists
+            fg->edges[e].dest = di;
+            fg->edges[e].distance = c->edges[j].distance;
+            fg->revOffsets[di + 1]++;
+            e++;
+        }
+    }
+    fg->offsets[n] = e;
+    fg->edgeCount = e;
+    
+    // counting sort of the routes by destination for the reverse graph
+    for (int i = 0; i < n; ++i) {
+        fg->revOffsets[i + 1] += fg->revOffsets[i];
+    }
+    int *fill = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (fill == NULL) {
+        free_frozen_graph(fg);
+        return NULL;
+    }
+    memcpy(fill, fg->revOffsets, n * sizeof(int));
+    for (int u = 0; u < n; ++u) {
+        for (int k = fg->offsets[u]; k < fg->offsets[u + 1]; ++k) {
+            CsrEdge *r = &fg->revEdges[fill[fg->edges[k].dest]++];
+            r->dest = u;
+            r->distance = fg->edges[k].distance;
+        }
+    }
+    free(fill);
+    
+    fg->geoBound = compute_geo_bound(fg);
+    return fg;
+}
+
+void free_frozen_graph(FrozenGraph *fg) {
+    if (fg == NULL) return;
+    
+    if (fg->mapping != NULL) {
+        snapshot_release(fg->mapping, fg->mappingSize);
+        free(fg);
+        return;
+    }
+    
+    free(fg->offsets);
+    free(fg->edges);
+    free(fg->ids);
+    free(fg->index.slots);
+    free(fg->revOffsets);
+    free(fg->revEdges);
+    free(fg->nameOffsets);
+    free(fg->nameData);
+    free(fg->latitude);
+    free(fg->longitude);
+    free(fg);
+}
+
+int frozen_find_city(const FrozenGraph *fg, int cityId) {
+    return id_index_find(&fg->index, cityId);
+}
+
+const char *frozen_city_name(const FrozenGraph *fg, int index) {
+    return fg->nameData + fg->nameOffsets[index];
+}
+
+static int bfs_reach(const FrozenGraph *fg, QueryContext *qc, int from, int to) {
+    if (fg == NULL || qc == NULL) return 0;
+    
+    int ai = frozen_find_city(fg, from);
+    int bi = frozen_find_city(fg, to);
+    
+    if (ai == -1 || bi == -1) {
+        return 0;
+    }
+    
+    if (ai == bi) {
+        return 1;
+    }
+    
+    if (query_context_fit(qc, fg->cityCount, fg->edgeCount) != 0) return 0;
+    query_begin(qc);
+    SearchSide *s = &qc->forward;
+    int *queue = qc->queue;
+    
+    int front = 0, rear = 0;
+    queue[rear++] = ai;
+    side_settle(qc, s, ai);
+    
+    while (front < rear) {
+        int cur = queue[front++];
+        STATS_ADD(settled, 1);
+        
+        for (int e = fg->offsets[cur]; e < fg->offsets[cur + 1]; ++e) {
+            int ni = fg->edges[e].dest;
+            STATS_ADD(relaxed, 1);
+            if (ni == bi) {
+                return 1;
+            }
+            if (!side_is_settled(qc, s, ni)) {
+                queue[rear++] = ni;
+                side_settle(qc, s, ni);
+            }
+        }
+    }
+    return 0;
+}
+
+int frozen_can_reach_ctx(const FrozenGraph *fg, QueryContext *qc, int from, int to) {
+    STATS_BEGIN(scope);
+    int result = bfs_reach(fg, qc, from, to);
+    STATS_END(scope, STATS_CAN_REACH);
+    return result;
+}
+
+int frozen_can_reach(const FrozenGraph *fg, int from, int to) {
+    if (fg == NULL) return 0;
+    
+    STATS_BEGIN(scope);
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int result = frozen_can_reach_ctx(fg, qc, from, to);
+    query_context_free(qc);
+    STATS_END(scope, STATS_CAN_REACH);
+    return result;
+}
+
+// writes the city ids from the search root to destIdx into path, returns its length
+static int build_path(const FrozenGraph *fg, const int *previous, int destIdx, int *path) {
+    int len = 0;
+    for (int cur = destIdx; cur != -1; cur = previous[cur]) {
+        len++;
+    }
+    
+    int at = len;
+    for (int cur = destIdx; cur != -1; cur = previous[cur]) {
+        path[--at] = fg->ids[cur];
+    }
+    return len;
+}
+
+static int dijkstra_search(const FrozenGraph *fg, QueryContext *qc, int source, int dest,
+                           int *path, int *pathLength, int *settled) {
+    if (fg == NULL || qc == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    int sourceIdx = frozen_find_city(fg, source);
+    int destIdx = frozen_find_city(fg, dest);
+    
+    if (sourceIdx == -1 || destIdx == -1) return -1;
+    if (query_context_fit(qc, fg->cityCount, fg->edgeCount) != 0) return -1;
+    
+    query_begin(qc);
+    SearchSide *s = &qc->forward;
+    side_set(qc, s, sourceIdx, 0, -1);
+    heap_push_or_decrease(&s->heap, sourceIdx, 0);
+    int settledCount = 0;
+    
+    while (!heap_empty(&s->heap)) {
+        int minDist;
+        int minIdx = heap_pop_min(&s->heap, &minDist);
+        side_settle(qc, s, minIdx);
+        settledCount++;
+        
+        if (minIdx == destIdx) break;
+        
+        STATS_ADD(relaxed, fg->offsets[minIdx + 1] - fg->offsets[minIdx]);
+        for (int e = fg->offsets[minIdx]; e < fg->offsets[minIdx + 1]; e++) {
+            int neighborIdx = fg->edges[e].dest;
+            if (!side_is_settled(qc, s, neighborIdx)) {
+                int newDist = minDist + fg->edges[e].distance;
+                if (newDist < side_dist(qc, s, neighborIdx)) {
+                    side_set(qc, s, neighborIdx, newDist, minIdx);
+                    heap_push_or_decrease(&s->heap, neighborIdx, newDist);
+                }
+            }
+        }
+    }
+    if (settled != NULL) *settled = settledCount;
+    STATS_ADD(settled, settledCount);
+    
+    int shortestDist = side_dist(qc, s, destIdx);
+    if (shortestDist == MAX_DISTANCE) return -1;
+    
+    *pathLength = build_path(fg, s->link, destIdx, path);
+    return shortestDist;
+}
+
+int frozen_shortest_path_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest,
+                             int *path, int *pathLength, int *settled) {
+    STATS_BEGIN(scope);
+    int result = dijkstra_search(fg, qc, source, dest, path, pathLength, settled);
+    STATS_END(scope, STATS_SHORTEST_PATH);
+    return result;
+}
+
+int frozen_shortest_path(const FrozenGraph *fg, int source, int dest, int *path, int *pathLength, int *settled) {
+    if (fg == NULL) return -1;
+    
+    STATS_BEGIN(scope);
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int result = frozen_shortest_path_ctx(fg, qc, source, dest, path, pathLength, settled);
+    query_context_free(qc);
+    STATS_END(scope, STATS_SHORTEST_PATH);
+    return result;
+}
+
+static int paths_are_different(int *path1, int len1, int *path2, int len2) {
+    if (len1 != len2) return 1;
+    
+    for (int i = 0; i < len1; i++) {
+        if (path1[i] != path2[i]) return 1;
+    }
+    return 0;
+}
+
+// the best itinerary that differs from shortestPath is among Yen's first two
+static int alternate_search(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int *path, int *pathLength,
+                            int *shortestPath, int shortestLength) {
+    if (fg == NULL || qc == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    Itinerary routes[2];
+    int count = frozen_k_shortest_paths_ctx(fg, qc, source, dest, 2, routes);
+    if (count <= 0) return -1;
+    
+    int bestDist = -1;
+    for (int i = 0; i < count; i++) {
+        if (paths_are_different(routes[i].cities, routes[i].length, shortestPath, shortestLength)) {
+            *pathLength = routes[i].length;
+            for (int j = 0; j < routes[i].length; j++) {
+                path[j] = routes[i].cities[j];
+            }
+            bestDist = routes[i].distance;
+            break;
+        }
+    }
+    
+    free_itineraries(routes, count);
+    return bestDist;
+}
+
+int frozen_alternate_route_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int *path, int *pathLength,
+                               int *shortestPath, int shortestLength) {
+    STATS_BEGIN(scope);
+    int result = alternate_search(fg, qc, source, dest, path, pathLength, shortestPath, shortestLength);
+    STATS_END(scope, STATS_ALTERNATE_ROUTE);
+    return result;
+}
+
+int frozen_alternate_route(const FrozenGraph *fg, int source, int dest, int *path, int *pathLength, 
+                           int *shortestPath, int shortestLength) {
+    if (fg == NULL) return -1;
+    
+    STATS_BEGIN(scope);
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int result = frozen_alternate_route_ctx(fg, qc, source, dest, path, pathLength, shortestPath, shortestLength);
+    query_context_free(qc);
+    STATS_END(scope, STATS_ALTERNATE_ROUTE);
+    return result;
 }
\ No newline at end of file
@@ -1,36 +1,148 @@
-#ifndef GRAPH_H
-#define GRAPH_H
-
-#define MAX_DISTANCE 999999
-
-typedef struct {
-    int destId;
-    int distance;
-} Edge;
-
-typedef struct {
-    int id;
-    char *name;
-    Edge *edges;
-    int edgeCount;
-    int edgeCap;
-} City;
-
-typedef struct {
-    City *cities;
-    int cityCount;
-    int cityCap;
-} Graph;
-
-void init_graph(Graph *g);
-void free_graph(Graph *g);
-void add_city(Graph *g, int cityId, const char *name);
-void add_route(Graph *g, int from, int to, int distance);
-void remove_route(Graph *g, int from, int to);
-int can_reach(Graph *g, int from, int to);
-void print_cities(Graph *g);
-void print_graph(Graph *g);
-int dijkstra_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength);
-int find_alternate_route(Graph *g, int source, int dest, int *path, int *pathLength, int *shortestPath, int shortestLength);
-
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stddef.h>
+#include "arena.h"
+
+#define MAX_DISTANCE 999999
+
+#define NAME_ARENA_BLOCK (64 * 1024)
+#define EDGE_SLAB_SIZE (256 * 1024)
+#define EDGE_INDEX_THRESHOLD 16 // cities with more routes than this index them by destination
+
+// results of the silent graph_add_route / graph_remove_route calls
+#define ROUTE_OK 0
+#define ROUTE_NO_SOURCE -1
+#define ROUTE_NO_DEST -2
+#define ROUTE_SAME_CITY -3
+#define ROUTE_EXISTS -4
+#define ROUTE_NOT_FOUND -5
+#define ROUTE_BAD_DISTANCE -6 // negative; every search assumes distances of at least 0
+
+typedef struct {
+    int destId;
+    int distance;
+} Edge;
+
+typedef struct {
+    int id;
+    int index; // -1 marks an empty slot
+} IdSlot;
+
+typedef struct {
+    IdSlot *slots; // open addressing, linear probing
+    int mask;      // slot count - 1 (slot count is a power of two)
+} IdIndex;
+
+typedef struct {
+    int id;
+    char *name;
+    double latitude;  // degrees
+    double longitude; // degrees
+    Edge *edges;      // unordered, a removal moves the last route into the gap
+    int edgeCount;
+    int edgeCap;
+    IdIndex destIndex; // destination id -> position in edges, slots NULL up to EDGE_INDEX_THRESHOLD routes
+} City;
+
+typedef struct {
+    int from;     // city ids
+    int to;
+    int distance;
+} RouteSpec;
+
+// read-only compressed-sparse-row snapshot of a Graph for query workloads
+typedef struct {
+    int dest;     // dense city index, not id
+    int distance;
+} CsrEdge;
+
+typedef struct {
+    int cityCount;
+    int edgeCount;
+    int *offsets;     // routes of city i are edges[offsets[i] .. offsets[i + 1])
+    CsrEdge *edges;
+    int *ids;         // dense index -> city id
+    IdIndex index;    // city id -> dense index
+    int *revOffsets;  // incoming routes, edges point back at the origin city
+    CsrEdge *revEdges;
+    int *nameOffsets; // names and coordinates live apart from the traversal arrays
+    char *nameData;
+    double *latitude;
+    double *longitude;
+    double geoBound;  // route km per great-circle km never drops below this (0 = no bound)
+    void *mapping;    // set when the arrays point into a mapped snapshot file
+    size_t mappingSize;
+} FrozenGraph;
+
+typedef struct ReachIndex ReachIndex;     // see reach.h
+typedef struct PathCache PathCache;       // see pathcache.h
+typedef struct QueryContext QueryContext; // see query.h
+typedef struct HubTrees HubTrees;         // see spt.h
+typedef struct ShortestPathTree ShortestPathTree;
+typedef struct LandmarkIndex LandmarkIndex; // see landmark.h
+typedef struct Overlay Overlay;             // see overlay.h
+
+typedef struct {
+    City *cities;
+    int cityCount;
+    int cityCap;
+    IdIndex index;         // city id -> position in cities
+    FrozenGraph *frozen;   // cached snapshot for queries, dropped on every edit
+    ReachIndex *reach;     // reachability index, kept current as routes are added
+    int reachStale;        // reach must be rebuilt before the next can_reach
+    unsigned int version;  // bumped by every route edit
+    PathCache *cache;      // shortest path results, NULL unless enabled
+    QueryContext *scratch; // workspace reused by the graph-level queries
+    HubTrees *trees;       // shortest path trees kept current by the edits, NULL until a source is tracked
+    LandmarkIndex *landmarks; // ALT bounds, built by the first landmark query and kept across removals
+    Overlay *overlay;      // cell overlay, kept across distance changes and customized again for them
+    Arena names;           // city names
+    BlockPool edgePool;    // per-city edge arrays
+} Graph;
+
+double great_circle_km(double lat1, double lon1, double lat2, double lon2);
+
+void id_index_build(IdIndex *ix, const int *ids, int count);
+int id_index_find(const IdIndex *ix, int cityId);
+void id_index_free(IdIndex *ix);
+
+void init_graph(Graph *g);
+void free_graph(Graph *g);
+int find_city_index(Graph *g, int cityId);
+void add_city(Graph *g, int cityId, const char *name, double latitude, double longitude);
+void add_route(Graph *g, int from, int to, int distance);
+void remove_route(Graph *g, int from, int to);
+void set_route_distance(Graph *g, int from, int to, int distance);
+int graph_add_route(Graph *g, int from, int to, int distance);
+int graph_remove_route(Graph *g, int from, int to);
+int graph_set_route_distance(Graph *g, int from, int to, int distance);
+void graph_reserve_cities(Graph *g, int capacity);
+void graph_enable_path_cache(Graph *g, int capacity);
+const ShortestPathTree *graph_track_source(Graph *g, int cityId);
+int graph_untrack_source(Graph *g, int cityId);
+int add_routes_bulk(Graph *g, RouteSpec *routes, int count);
+int can_reach(Graph *g, int from, int to);
+void print_cities(Graph *g);
+void print_graph(Graph *g);
+int dijkstra_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength);
+int find_alternate_route(Graph *g, int source, int dest, int *path, int *pathLength, int *shortestPath, int shortestLength);
+
+FrozenGraph *graph_freeze(const Graph *g);
+const FrozenGraph *graph_snapshot(Graph *g);
+const LandmarkIndex *graph_landmarks(Graph *g);
+const Overlay *graph_overlay(Graph *g);
+QueryContext *graph_query_context(Graph *g);
+void free_frozen_graph(FrozenGraph *fg);
+int frozen_find_city(const FrozenGraph *fg, int cityId);
+const char *frozen_city_name(const FrozenGraph *fg, int index);
+int frozen_can_reach(const FrozenGraph *fg, int from, int to);
+int frozen_shortest_path(const FrozenGraph *fg, int source, int dest, int *path, int *pathLength, int *settled);
+int frozen_alternate_route(const FrozenGraph *fg, int source, int dest, int *path, int *pathLength, int *shortestPath, int shortestLength);
+
+// variants that run in a caller-owned QueryContext instead of allocating per call
+int frozen_can_reach_ctx(const FrozenGraph *fg, QueryContext *qc, int from, int to);
+int frozen_shortest_path_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int *path, int *pathLength, int *settled);
+int frozen_alternate_route_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int *path, int *pathLength, int *shortestPath, int shortestLength);
+
 #endif
\ No newline at end of file
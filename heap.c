@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include "heap.h"
+
+#define HEAP_ARITY 4
+
+int heap_init(IndexedHeap *h, int capacity) {
+    if (h == NULL) return -1;
+    
+    h->entries = malloc((capacity > 0 ? capacity : 1) * sizeof(HeapEntry));
+    h->pos = malloc((capacity > 0 ? capacity : 1) * sizeof(int));
+    h->size = 0;
+    h->capacity = capacity;
+    
+    if (h->entries == NULL || h->pos == NULL) {
+        free(h->entries);
+        free(h->pos);
+        h->entries = NULL;
+        h->pos = NULL;
+        return -1;
+    }
+    
+    for (int i = 0; i < capacity; ++i) {
+        h->pos[i] = -1;
+    }
+    return 0;
+}
+
+void heap_free(IndexedHeap *h) {
+    if (h == NULL) return;
+    free(h->entries);
+    free(h->pos);
+    h->entries = NULL;
+    h->pos = NULL;
+    h->size = 0;
+    h->capacity = 0;
+}
+
+// only touches the nodes still queued, so reuse between queries is cheap
+void heap_clear(IndexedHeap *h) {
+    for (int i = 0; i < h->size; ++i) {
+        h->pos[h->entries[i].node] = -1;
+    }
+    h->size = 0;
+}
+
+int heap_empty(const IndexedHeap *h) {
+    return h->size == 0;
+}
+
+int heap_contains(const IndexedHeap *h, int node) {
+    return h->pos[node] != -1;
+}
+
+int heap_min_key(const IndexedHeap *h) {
+    return h->entries[0].key;
+}
+
+static void sift_up(IndexedHeap *h, int slot) {
+    HeapEntry e = h->entries[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / HEAP_ARITY;
+        if (h->entries[parent].key <= e.key) break;
+        h->entries[slot] = h->entries[parent];
+        h->pos[h->entries[slot].node] = slot;
+        slot = parent;
+    }
+    h->entries[slot] = e;
+    h->pos[e.node] = slot;
+}
+
+static void sift_down(IndexedHeap *h, int slot) {
+    HeapEntry e = h->entries[slot];
+    for (;;) {
+        int first = slot * HEAP_ARITY + 1;
+        if (first >= h->size) break;
+        
+        int last = first + HEAP_ARITY;
+        if (last > h->size) last = h->size;
+        
+        int best = first;
+        for (int c = first + 1; c < last; ++c) {
+            if (h->entries[c].key < h->entries[best].key) best = c;
+        }
+        if (h->entries[best].key >= e.key) break;
+        
+        h->entries[slot] = h->entries[best];
+        h->pos[h->entries[slot].node] = slot;
+        slot = best;
+    }
+    h->entries[slot] = e;
+    h->pos[e.node] = slot;
+}
+
+void heap_push_or_decrease(IndexedHeap *h, int node, int key) {
+    int slot = h->pos[node];
+    if (slot == -1) {
+        slot = h->size++;
+        h->entries[slot].key = key;
+        h->entries[slot].node = node;
+        sift_up(h, slot);
+    } else if (key < h->entries[slot].key) {
+        h->entries[slot].key = key;
+        sift_up(h, slot);
+    }
+}
+
+int heap_pop_min(IndexedHeap *h, int *key) {
+    if (h->size == 0) return -1;
+    
+    HeapEntry top = h->entries[0];
+    h->pos[top.node] = -1;
+    h->size--;
+    if (h->size > 0) {
+        h->entries[0] = h->entries[h->size];
+        sift_down(h, 0);
+    }
+    if (key != NULL) *key = top.key;
+    return top.node;
+}
\ No newline at end of file
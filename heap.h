@@ -0,0 +1,26 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+typedef struct {
+    int key;
+    int node;
+} HeapEntry;
+
+// 4-ary min-heap over node indices [0, capacity) with decrease-key
+typedef struct {
+    HeapEntry *entries;
+    int *pos; // pos[node] = slot in entries, -1 when not queued
+    int size;
+    int capacity;
+} IndexedHeap;
+
+int heap_init(IndexedHeap *h, int capacity);
+void heap_free(IndexedHeap *h);
+void heap_clear(IndexedHeap *h);
+int heap_empty(const IndexedHeap *h);
+int heap_contains(const IndexedHeap *h, int node);
+int heap_min_key(const IndexedHeap *h);
+void heap_push_or_decrease(IndexedHeap *h, int node, int key);
+int heap_pop_min(IndexedHeap *h, int *key);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "heap.h"
+#include "hublabel.h"
+
+// labels while they grow; hubs arrive in rank order, so each stays sorted
+typedef struct {
+    int *hubs;
+    int *dist;
+    int count;
+    int cap;
+} LabelList;
+
+typedef struct {
+    const FrozenGraph *fg;
+    int n;
+    LabelList *out;
+    LabelList *in;
+    int *hubDist;  // by hub rank: distance between the current hub and that one, MAX_DISTANCE otherwise
+    int *dist;     // search distances, MAX_DISTANCE outside the current search
+    int *touched;
+    int touchedCount;
+    IndexedHeap heap;
+} Labeler;
+
+static void label_push(LabelList *l, int hub, int dist) {
+    if (l->count >= l->cap) {
+        int newCap = l->cap ? l->cap * 2 : 4;
+        int *hubs = realloc(l->hubs, newCap * sizeof(int));
+        if (hubs != NULL) l->hubs = hubs;
+        int *dists = realloc(l->dist, newCap * sizeof(int));
+        if (dists != NULL) l->dist = dists;
+        if (hubs == NULL || dists == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        l->cap = newCap;
+    }
+    l->hubs[l->count] = hub;
+    l->dist[l->count] = dist;
+    l->count++;
+}
+
+// shortest distance the labels so far give through the hubs loaded into hubDist
+static int covered_distance(const Labeler *lb, const LabelList *l) {
+    int best = MAX_DISTANCE;
+    for (int i = 0; i < l->count; ++i) {
+        int h = lb->hubDist[l->hubs[i]];
+        if (h != MAX_DISTANCE && h + l->dist[i] < best) best = h + l->dist[i];
+    }
+    return best;
+}
+
+// One pruned Dijkstra from hub v (rank k). Forward, it adds (k, d(v, u)) to
+// the in-labels of the cities it keeps; backward, over the reverse routes,
+// (k, d(u, v)) to their out-labels. A city whose distance the existing labels
+// already match is neither labeled nor expanded.
+static void pruned_search(Labeler *lb, int v, int k, int backward) {
+    const FrozenGraph *fg = lb->fg;
+    const int *offsets = backward ? fg->revOffsets : fg->offsets;
+    const CsrEdge *edges = backward ? fg->revEdges : fg->edges;
+    LabelList *grow = backward ? lb->out : lb->in;
+    const LabelList *own = backward ? &lb->in[v] : &lb->out[v];
+    
+    for (int i = 0; i < own->count; ++i) {
+        lb->hubDist[own->hubs[i]] = own->dist[i];
+    }
+    
+    lb->dist[v] = 0;
+    lb->touched[lb->touchedCount++] = v;
+    heap_push_or_decrease(&lb->heap, v, 0);
+    while (!heap_empty(&lb->heap)) {
+        int du;
+        int u = heap_pop_min(&lb->heap, &du);
+        if (covered_distance(lb, &grow[u]) <= du) continue;
+        
+        label_push(&grow[u], k, du);
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+            int w = edges[e].dest;
+            int newDist = du + edges[e].distance;
+            if (newDist < lb->dist[w]) {
+                if (lb->dist[w] == MAX_DISTANCE) lb->touched[lb->touchedCount++] = w;
+                lb->dist[w] = newDist;
+                heap_push_or_decrease(&lb->heap, w, newDist);
+            }
+        }
+    }
+    
+    for (int i = 0; i < lb->touchedCount; ++i) {
+        lb->dist[lb->touched[i]] = MAX_DISTANCE;
+    }
+    lb->touchedCount = 0;
+    for (int i = 0; i < own->count; ++i) {
+        lb->hubDist[own->hubs[i]] = MAX_DISTANCE;
+    }
+}
+
+typedef struct {
+    long long priority; // (routes out + 1) * (routes in + 1)
+    int city;
+} HubCandidate;
+
+// more connected cities first, ties by index so the order is reproducible
+static int compare_candidates(const void *a, const void *b) {
+    const HubCandidate *x = a;
+    const HubCandidate *y = b;
+    if (x->priority != y->priority) return x->priority > y->priority ? -1 : 1;
+    return (x->city > y->city) - (x->city < y->city);
+}
+
+// copies the growing labels into one flat pair of arrays with a sentinel after each label
+static int flatten(const LabelList *lists, int n, int **offsets, int **hubs, int **dists) {
+    long long total = n;
+    for (int v = 0; v < n; ++v) {
+        total += lists[v].count;
+    }
+    if (total > INT_MAX) return -1;
+    
+    *offsets = malloc((n + 1) * sizeof(int));
+    *hubs = malloc(total * sizeof(int));
+    *dists = malloc(total * sizeof(int));
+    if (*offsets == NULL || *hubs == NULL || *dists == NULL) return -1;
+    
+    int at = 0;
+    for (int v = 0; v < n; ++v) {
+        (*offsets)[v] = at;
+        memcpy(*hubs + at, lists[v].hubs, lists[v].count * sizeof(int));
+        memcpy(*dists + at, lists[v].dist, lists[v].count * sizeof(int));
+        at += lists[v].count;
+        (*hubs)[at] = HUB_SENTINEL;
+        (*dists)[at] = MAX_DISTANCE;
+        at++;
+    }
+    (*offsets)[n] = at;
+    return 0;
+}
+
+HubLabels *frozen_hub_labels_build(const FrozenGraph *fg) {
+    if (fg == NULL) return NULL;
+    
+    int n = fg->cityCount;
+    HubLabels *hl = calloc(1, sizeof(HubLabels));
+    Labeler lb;
+    memset(&lb, 0, sizeof(lb));
+    lb.fg = fg;
+    lb.n = n;
+    lb.out = calloc(n > 0 ? n : 1, sizeof(LabelList));
+    lb.in = calloc(n > 0 ? n : 1, sizeof(LabelList));
+    lb.hubDist = malloc((n > 0 ? n : 1) * sizeof(int));
+    lb.dist = malloc((n > 0 ? n : 1) * sizeof(int));
+    lb.touched = malloc((n > 0 ? n : 1) * sizeof(int));
+    HubCandidate *candidates = malloc((n > 0 ? n : 1) * sizeof(HubCandidate));
+    int heapOk = heap_init(&lb.heap, n) == 0;
+    if (hl != NULL) {
+        hl->cityCount = n;
+        hl->ids = malloc((n > 0 ? n : 1) * sizeof(int));
+        hl->order = malloc((n > 0 ? n : 1) * sizeof(int));
+    }
+    
+    int failed = hl == NULL || hl->ids == NULL || hl->order == NULL || lb.out == NULL || lb.in == NULL ||
+                 lb.hubDist == NULL || lb.dist == NULL || lb.touched == NULL || candidates == NULL || !heapOk;
+    if (!failed) {
+        memcpy(hl->ids, fg->ids, n * sizeof(int));
+        for (int v = 0; v < n; ++v) {
+            long long out = fg->offsets[v + 1] - fg->offsets[v];
+            long long in = fg->revOffsets[v + 1] - fg->revOffsets[v];
+            candidates[v].priority = (out + 1) * (in + 1);
+            candidates[v].city = v;
+            lb.hubDist[v] = MAX_DISTANCE;
+            lb.dist[v] = MAX_DISTANCE;
+        }
+        qsort(candidates, n, sizeof(HubCandidate), compare_candidates);
+        for (int k = 0; k < n; ++k) {
+            hl->order[k] = candidates[k].city;
+        }
+        
+        for (int k = 0; k < n; ++k) {
+            pruned_search(&lb, hl->order[k], k, 0);
+            pruned_search(&lb, hl->order[k], k, 1);
+        }
+        
+        failed = flatten(lb.out, n, &hl->outOffsets, &hl->outHubs, &hl->outDist) != 0 ||
+                 flatten(lb.in, n, &hl->inOffsets, &hl->inHubs, &hl->inDist) != 0;
+        if (!failed) hl->entries = (long long)hl->outOffsets[n] + hl->inOffsets[n] - 2LL * n;
+    }
+    
+    for (int v = 0; lb.out != NULL && lb.in != NULL && v < n; ++v) {
+        free(lb.out[v].hubs);
+        free(lb.out[v].dist);
+        free(lb.in[v].hubs);
+        free(lb.in[v].dist);
+    }
+    free(lb.out);
+    free(lb.in);
+    free(lb.hubDist);
+    free(lb.dist);
+    free(lb.touched);
+    free(candidates);
+    if (heapOk) heap_free(&lb.heap);
+    
+    if (failed) {
+        hub_labels_free(hl);
+        return NULL;
+    }
+    id_index_build(&hl->index, hl->ids, n);
+    return hl;
+}
+
+HubLabels *hub_labels_build(Graph *g) {
+    if (g == NULL) return NULL;
+    
+    const FrozenGraph *fg = graph_snapshot(g);
+    if (fg == NULL) return NULL;
+    return frozen_hub_labels_build(fg);
+}
+
+void hub_labels_free(HubLabels *hl) {
+    if (hl == NULL) return;
+    
+    free(hl->ids);
+    free(hl->order);
+    free(hl->outOffsets);
+    free(hl->outHubs);
+    free(hl->outDist);
+    free(hl->inOffsets);
+    free(hl->inHubs);
+    free(hl->inDist);
+    id_index_free(&hl->index);
+    free(hl);
+}
+
+// Merge of out(s) and in(t). Both end in HUB_SENTINEL, which is larger than
+// any rank, so the loop needs no bounds checks and each step advances the
+// side with the smaller hub (both on a match) without a branch.
+int hub_labels_distance_idx(const HubLabels *hl, int sourceIdx, int destIdx) {
+    if (hl == NULL || sourceIdx < 0 || sourceIdx >= hl->cityCount || destIdx < 0 || destIdx >= hl->cityCount) return -1;
+    
+    const int *outHubs = hl->outHubs + hl->outOffsets[sourceIdx];
+    const int *outDist = hl->outDist + hl->outOffsets[sourceIdx];
+    const int *inHubs = hl->inHubs + hl->inOffsets[destIdx];
+    const int *inDist = hl->inDist + hl->inOffsets[destIdx];
+    int best = MAX_DISTANCE;
+    int i = 0, j = 0;
+    
+    while (1) {
+        int a = outHubs[i];
+        int b = inHubs[j];
+        if (a == b) {
+            if (a == HUB_SENTINEL) break;
+            int d = outDist[i] + inDist[j];
+            best = d < best ? d : best;
+        }
+        i += a <= b;
+        j += b <= a;
+    }
+    return best == MAX_DISTANCE ? -1 : best;
+}
+
+// distance between two city ids, -1 when unreachable or either city is unknown
+int hub_labels_distance(const HubLabels *hl, int source, int dest) {
+    if (hl == NULL) return -1;
+    return hub_labels_distance_idx(hl, id_index_find(&hl->index, source), id_index_find(&hl->index, dest));
+}
\ No newline at end of file
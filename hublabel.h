@@ -0,0 +1,42 @@
+#ifndef HUBLABEL_H
+#define HUBLABEL_H
+
+#include <limits.h>
+#include "graph.h"
+
+// Hub labels (2-hop cover): every city v keeps an out-label of (hub, d(v, hub))
+// and an in-label of (hub, d(hub, v)), chosen so that some hub on a shortest
+// path from s to t appears in both out(s) and in(t). The distance is then the
+// minimum of d(s, h) + d(h, t) over the hubs the two labels share, found by
+// one merge of two sorted arrays. Labels come from pruned landmark labeling:
+// cities are processed from most to least connected, and each one's forward
+// and backward Dijkstra search stops wherever the labels built so far already
+// give a distance at least as short.
+//
+// All labels live in two pairs of flat arrays (hub ranks and distances kept
+// apart, like columns) and each label ends with a HUB_SENTINEL hub, so the
+// merge runs without bounds checks and never touches a city's other data.
+
+#define HUB_SENTINEL INT_MAX
+
+typedef struct {
+    int cityCount;
+    int *ids;          // dense index -> city id
+    IdIndex index;     // city id -> dense index
+    int *order;        // hub rank -> dense index
+    int *outOffsets;   // out-label of v: outHubs/outDist[outOffsets[v] .. outOffsets[v + 1]), sentinel included
+    int *outHubs;      // hub ranks, ascending within a label
+    int *outDist;      // d(v, hub)
+    int *inOffsets;    // in-label of v, same layout
+    int *inHubs;
+    int *inDist;       // d(hub, v)
+    long long entries; // label entries over all cities, sentinels excluded
+} HubLabels;
+
+HubLabels *hub_labels_build(Graph *g);
+HubLabels *frozen_hub_labels_build(const FrozenGraph *fg);
+void hub_labels_free(HubLabels *hl);
+int hub_labels_distance(const HubLabels *hl, int source, int dest);
+int hub_labels_distance_idx(const HubLabels *hl, int sourceIdx, int destIdx);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "heap.h"
+#include "ksp.h"
+#include "query.h"
+#include "stats.h"
+
+// Yen's k shortest loopless paths over the frozen CSR graph
+
+typedef struct {
+    int *nodes; // dense indices, source first
+    int *cum;   // distance from the source up to nodes[i]
+    int length;
+} KPath;
+
+// Dijkstra from `from` to `to` in the context's forward side that skips the
+// nodes and edges banned in qc->nodeBlocked / qc->edgeBlocked
+static int spur_dijkstra(const FrozenGraph *fg, QueryContext *qc, int from, int to) {
+    SearchSide *s = &qc->forward;
+    
+    query_begin(qc);
+    side_set(qc, s, from, 0, -1);
+    heap_push_or_decrease(&s->heap, from, 0);
+    
+    while (!heap_empty(&s->heap)) {
+        int curDist;
+        int cur = heap_pop_min(&s->heap, &curDist);
+        STATS_ADD(settled, 1);
+        if (cur == to) return curDist;
+        
+        STATS_ADD(relaxed, fg->offsets[cur + 1] - fg->offsets[cur]);
+        for (int e = fg->offsets[cur]; e < fg->offsets[cur + 1]; ++e) {
+            int next = fg->edges[e].dest;
+            if (qc->edgeBlocked[e] || qc->nodeBlocked[next]) continue;
+            
+            int newDist = curDist + fg->edges[e].distance;
+            if (newDist < side_dist(qc, s, next)) {
+                side_set(qc, s, next, newDist, cur);
+                heap_push_or_decrease(&s->heap, next, newDist);
+            }
+        }
+    }
+    return -1;
+}
+
+static int find_edge(const FrozenGraph *fg, int from, int to) {
+    for (int e = fg->offsets[from]; e < fg->offsets[from + 1]; ++e) {
+        if (fg->edges[e].dest == to) return e;
+    }
+    return -1;
+}
+
+static void free_kpath(KPath *p) {
+    free(p->nodes);
+    free(p->cum);
+    p->nodes = NULL;
+    p->cum = NULL;
+    p->length = 0;
+}
+
+// joins root[0..spurAt] with the spur search result ending at `to`
+static int make_candidate(const QueryContext *qc, const KPath *root, int spurAt, int to, KPath *out) {
+    const SearchSide *s = &qc->forward;
+    int spurLen = 0;
+    for (int cur = to; cur != -1; cur = s->link[cur]) {
+        spurLen++;
+    }
+    
+    int len = spurAt + spurLen;
+    out->nodes = malloc(len * sizeof(int));
+    out->cum = malloc(len * sizeof(int));
+    STATS_ADD(allocBytes, 2 * len * sizeof(int));
+    if (out->nodes == NULL || out->cum == NULL) {
+        free_kpath(out);
+        return -1;
+    }
+    
+    for (int i = 0; i < spurAt; ++i) {
+        out->nodes[i] = root->nodes[i];
+        out->cum[i] = root->cum[i];
+    }
+    int rootDist = root->cum[spurAt];
+    int at = len;
+    for (int cur = to; cur != -1; cur = s->link[cur]) {
+        --at;
+        out->nodes[at] = cur;
+        out->cum[at] = rootDist + s->dist[cur];
+    }
+    out->length = len;
+    return 0;
+}
+
+static int same_kpath(const KPath *a, const KPath *b) {
+    if (a->length != b->length) return 0;
+    return memcmp(a->nodes, b->nodes, a->length * sizeof(int)) == 0;
+}
+
+static int contains_kpath(const KPath *list, int count, const KPath *p) {
+    for (int i = 0; i < count; ++i) {
+        if (same_kpath(&list[i], p)) return 1;
+    }
+    return 0;
+}
+
+static int kpath_distance(const KPath *p) {
+    return p->cum[p->length - 1];
+}
+
+static int export_kpaths(const FrozenGraph *fg, KPath *found, int count, Itinerary *routes) {
+    for (int i = 0; i < count; ++i) {
+        routes[i].distance = kpath_distance(&found[i]);
+        routes[i].length = found[i].length;
+        routes[i].cities = malloc(found[i].length * sizeof(int));
+        STATS_ADD(allocBytes, found[i].length * sizeof(int));
+        if (routes[i].cities == NULL) {
+            free_itineraries(routes, i);
+            return -1;
+        }
+        for (int j = 0; j < found[i].length; ++j) {
+            routes[i].cities[j] = fg->ids[found[i].nodes[j]];
+        }
+    }
+    return count;
+}
+
+// Result paths still need their own memory; the searches themselves run in qc.
+int frozen_k_shortest_paths_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int k, Itinerary *routes) {
+    if (fg == NULL || qc == NULL || routes == NULL || k <= 0) return -1;
+    
+    int sourceIdx = frozen_find_city(fg, source);
+    int destIdx = frozen_find_city(fg, dest);
+    if (sourceIdx == -1 || destIdx == -1) return -1;
+    if (query_context_fit(qc, fg->cityCount, fg->edgeCount) != 0) return -1;
+    
+    KPath *found = calloc(k, sizeof(KPath));
+    STATS_ADD(allocBytes, k * sizeof(KPath));
+    int foundCount = 0;
+    KPath *candidates = NULL;
+    int candidateCount = 0, candidateCap = 0;
+    int failed = 0;
+    
+    if (found == NULL) return -1;
+    
+    KPath root = {0};
+    root.length = 1;
+    root.nodes = &sourceIdx;
+    root.cum = (int[]){0};
+    
+    if (spur_dijkstra(fg, qc, sourceIdx, destIdx) != -1) {
+        if (make_candidate(qc, &root, 0, destIdx, &found[0]) == 0) {
+            foundCount = 1;
+        } else {
+            failed = 1;
+        }
+    }
+    
+    while (!failed && foundCount > 0 && foundCount < k) {
+        const KPath *last = &found[foundCount - 1];
+        
+        for (int spurAt = 0; spurAt + 1 < last->length && !failed; ++spurAt) {
+            int spurNode = last->nodes[spurAt];
+            
+            // cut the next hop of every accepted path that shares this root
+            for (int i = 0; i < foundCount; ++i) {
+                const KPath *p = &found[i];
+                if (p->length > spurAt + 1 &&
+                    memcmp(p->nodes, last->nodes, (spurAt + 1) * sizeof(int)) == 0) {
+                    int e = find_edge(fg, spurNode, p->nodes[spurAt + 1]);
+                    if (e != -1) qc->edgeBlocked[e] = 1;
+                }
+            }
+            for (int i = 0; i < spurAt; ++i) {
+                qc->nodeBlocked[last->nodes[i]] = 1;
+            }
+            
+            if (spur_dijkstra(fg, qc, spurNode, destIdx) != -1) {
+                KPath cand;
+                if (make_candidate(qc, last, spurAt, destIdx, &cand) != 0) {
+                    failed = 1;
+                } else if (contains_kpath(candidates, candidateCount, &cand) ||
+                           contains_kpath(found, foundCount, &cand)) {
+                    free_kpath(&cand);
+                } else {
+                    if (candidateCount >= candidateCap) {
+                        int newCap = candidateCap ? candidateCap * 2 : 8;
+                        KPath *temp = realloc(candidates, newCap * sizeof(KPath));
+                        STATS_ADD(allocBytes, newCap * sizeof(KPath));
+                        if (temp == NULL) {
+                            free_kpath(&cand);
+                            failed = 1;
+                        } else {
+                            candidates = temp;
+                            candidateCap = newCap;
+                        }
+                    }
+                    if (!failed) candidates[candidateCount++] = cand;
+                }
+            }
+            
+            for (int i = 0; i < foundCount; ++i) {
+                const KPath *p = &found[i];
+                if (p->length > spurAt + 1) {
+                    int e = find_edge(fg, p->nodes[spurAt], p->nodes[spurAt + 1]);
+                    if (e != -1) qc->edgeBlocked[e] = 0;
+                }
+            }
+            for (int i = 0; i < spurAt; ++i) {
+                qc->nodeBlocked[last->nodes[i]] = 0;
+            }
+        }
+        
+        if (failed || candidateCount == 0) break;
+        
+        // the shortest candidate (fewest hops on ties) becomes the next path
+        int best = 0;
+        for (int i = 1; i < candidateCount; ++i) {
+            int d = kpath_distance(&candidates[i]);
+            int bestDist = kpath_distance(&candidates[best]);
+            if (d < bestDist || (d == bestDist && candidates[i].length < candidates[best].length)) {
+                best = i;
+            }
+        }
+        found[foundCount++] = candidates[best];
+        candidates[best] = candidates[--candidateCount];
+    }
+    
+    int result = failed ? -1 : export_kpaths(fg, found, foundCount, routes);
+    
+    for (int i = 0; i < foundCount; ++i) {
+        free_kpath(&found[i]);
+    }
+    for (int i = 0; i < candidateCount; ++i) {
+        free_kpath(&candidates[i]);
+    }
+    free(found);
+    free(candidates);
+    return result;
+}
+
+int frozen_k_shortest_paths(const FrozenGraph *fg, int source, int dest, int k, Itinerary *routes) {
+    if (fg == NULL) return -1;
+    
+    QueryContext *qc = query_context_create(fg->cityCount, fg->edgeCount);
+    int result = frozen_k_shortest_paths_ctx(fg, qc, source, dest, k, routes);
+    query_context_free(qc);
+    return result;
+}
+
+int k_shortest_paths(Graph *g, int source, int dest, int k, Itinerary *routes) {
+    if (g == NULL) return -1;
+    
+    // the menu's alternate routes, accounted with find_alternate_route
+    STATS_BEGIN(scope);
+    QueryContext *qc = graph_query_context(g);
+    int result = qc == NULL ? -1 : frozen_k_shortest_paths_ctx(g->frozen, qc, source, dest, k, routes);
+    STATS_END(scope, STATS_ALTERNATE_ROUTE);
+    return result;
+}
+
+void free_itineraries(Itinerary *routes, int count) {
+    if (routes == NULL) return;
+    
+    for (int i = 0; i < count; ++i) {
+        free(routes[i].cities);
+        routes[i].cities = NULL;
+        routes[i].length = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef KSP_H
+#define KSP_H
+
+#include "graph.h"
+
+typedef struct {
+    int distance;
+    int length;
+    int *cities; // city ids, source first
+} Itinerary;
+
+int k_shortest_paths(Graph *g, int source, int dest, int k, Itinerary *routes);
+int frozen_k_shortest_paths(const FrozenGraph *fg, int source, int dest, int k, Itinerary *routes);
+int frozen_k_shortest_paths_ctx(const FrozenGraph *fg, QueryContext *qc, int source, int dest, int k, Itinerary *routes);
+void free_itineraries(Itinerary *routes, int count);
+
+#endif
\ No newline at end of file
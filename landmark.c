@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "heap.h"
+#include "landmark.h"
+#include "query.h"
+
+#define ALT_UNREACHABLE -1 // potential of a city that cannot reach the target
+
+// one-to-all Dijkstra over a CSR side (forward routes or the reverse ones)
+static void settle_all(const int *offsets, const CsrEdge *edges, int cityCount, IndexedHeap *heap,
+                       int source, int *dist) {
+    for (int v = 0; v < cityCount; ++v) {
+        dist[v] = MAX_DISTANCE;
+    }
+    dist[source] = 0;
+    heap_clear(heap);
+    heap_push_or_decrease(heap, source, 0);
+    
+    while (!heap_empty(heap)) {
+        int du;
+        int u = heap_pop_min(heap, &du);
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+            int v = edges[e].dest;
+            int newDist = du + edges[e].distance;
+            if (newDist < dist[v]) {
+                dist[v] = newDist;
+                heap_push_or_decrease(heap, v, newDist);
+            }
+        }
+    }
+}
+
+// Farthest selection: the first landmark is the city farthest (out and back)
+// from the best connected one, each next one the city whose round trip to its
+// nearest landmark is longest. Only cities in the start's strongly connected
+// component are candidates, so a landmark never lands on a stray island.
+// Costs 2 * count + 2 one-to-all searches.
+LandmarkIndex *landmark_build(const FrozenGraph *fg, int count) {
+    if (fg == NULL || count <= 0) return NULL;
+    
+    int n = fg->cityCount;
+    if (count > ALT_MAX_LANDMARKS) count = ALT_MAX_LANDMARKS;
+    if (count > n) count = n;
+    
+    LandmarkIndex *li = calloc(1, sizeof(LandmarkIndex));
+    if (li == NULL) return NULL;
+    li->cityCount = n;
+    li->landmarkCount = count;
+    li->landmarks = malloc((count > 0 ? count : 1) * sizeof(int));
+    li->dist = malloc(((size_t)n * count > 0 ? (size_t)n * count : 1) * sizeof(LandmarkDistance));
+    int *from = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *to = malloc((n > 0 ? n : 1) * sizeof(int));
+    long long *score = malloc((n > 0 ? n : 1) * sizeof(long long));
+    IndexedHeap heap;
+    int heapOk = heap_init(&heap, n) == 0;
+    
+    if (li->landmarks == NULL || li->dist == NULL || from == NULL || to == NULL || score == NULL || !heapOk) {
+        if (heapOk) heap_free(&heap);
+        free(from);
+        free(to);
+        free(score);
+        landmark_free(li);
+        return NULL;
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        li->landmarks[i] = -1;
+    }
+    for (size_t k = 0; k < (size_t)n * count; ++k) {
+        li->dist[k].from = MAX_DISTANCE;
+        li->dist[k].to = MAX_DISTANCE;
+    }
+    
+    int start = 0;
+    for (int v = 1; v < n; ++v) {
+        if (fg->offsets[v + 1] - fg->offsets[v] > fg->offsets[start + 1] - fg->offsets[start]) start = v;
+    }
+    if (n > 0) {
+        settle_all(fg->offsets, fg->edges, n, &heap, start, from);
+        settle_all(fg->revOffsets, fg->revEdges, n, &heap, start, to);
+    }
+    for (int v = 0; v < n; ++v) {
+        score[v] = (from[v] == MAX_DISTANCE || to[v] == MAX_DISTANCE) ? -1 : (long long)from[v] + to[v];
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        int pick = -1;
+        for (int v = 0; v < n; ++v) {
+            if (score[v] >= 0 && (pick == -1 || score[v] > score[pick])) pick = v;
+        }
+        // every candidate sits on a landmark already
+        if (pick == -1 || (i > 0 && score[pick] == 0)) break;
+        
+        li->landmarks[i] = pick;
+        settle_all(fg->offsets, fg->edges, n, &heap, pick, from);
+        settle_all(fg->revOffsets, fg->revEdges, n, &heap, pick, to);
+        for (int v = 0; v < n; ++v) {
+            LandmarkDistance *d = &li->dist[(size_t)v * count + i];
+            d->from = from[v];
+            d->to = to[v];
+            if (score[v] > 0 && (long long)from[v] + to[v] < score[v]) score[v] = (long long)from[v] + to[v];
+        }
+        score[pick] = 0;
+    }
+    
+    heap_free(&heap);
+    free(from);
+    free(to);
+    free(score);
+    return li;
+}
+
+void landmark_free(LandmarkIndex *li) {
+    if (li == NULL) return;
+    free(li->landmarks);
+    free(li->dist);
+    free(li);
+}
+
+// largest landmark bound on d(v, t), ALT_UNREACHABLE when v provably cannot reach t
+static int landmark_bound(const LandmarkIndex *li, int v, int t) {
+    const LandmarkDistance *dv = &li->dist[(size_t)v * li->landmarkCount];
+    const LandmarkDistance *dt = &li->dist[(size_t)t * li->landmarkCount];
+    int best = 0;
+    
+    for (int i = 0; i < li->landmarkCount; ++i) {
+        if (dv[i].from != MAX_DISTANCE) {
+            if (dt[i].from == MAX_DISTANCE) return ALT_UNREACHABLE; // L reaches v but not t
+            if (dt[i].from - dv[i].from > best) best = dt[i].from - dv[i].from;
+        }
+        if (dt[i].to != MAX_DISTANCE) {
+            if (dv[i].to == MAX_DISTANCE) return ALT_UNREACHABLE; // t reaches L but v does not
+            if (dv[i].to - dt[i].to > best) best = dv[i].to - dt[i].to;
+        }
+    }
+    return best;
+}
+
+static int potential_of(const LandmarkIndex *li, QueryContext *qc, int v, int t) {
+    if (qc->potentialStamp[v] != qc->generation) {
+        qc->potential[v] = landmark_bound(li, v, t);
+        qc->potentialStamp[v] = qc->generation;
+    }
+    return qc->potential[v];
+}
+
+// Dijkstra on keys dist + potential; the potential is consistent, so the
+// search still settles each city once and stops when the target is settled
+int landmark_shortest_path_ctx(const FrozenGraph *fg, const LandmarkIndex *li, QueryContext *qc,
+                               int source, int dest, int *path, int *pathLength, int *settled) {
+    if (fg == NULL || li == NULL || qc == NULL || path == NULL || pathLength == NULL) return -1;
+    if (li->cityCount != fg->cityCount) return -1;
+    
+    int sourceIdx = frozen_find_city(fg, source);
+    int destIdx = frozen_find_city(fg, dest);
+    if (sourceIdx == -1 || destIdx == -1) return -1;
+    if (query_context_fit(qc, fg->cityCount, fg->edgeCount) != 0) return -1;
+    
+    query_begin(qc);
+    SearchSide *s = &qc->forward;
+    int settledCount = 0;
+    
+    int h = potential_of(li, qc, sourceIdx, destIdx);
+    if (h != ALT_UNREACHABLE) {
+        side_set(qc, s, sourceIdx, 0, -1);
+        heap_push_or_decrease(&s->heap, sourceIdx, h);
+    }
+    
+    while (!heap_empty(&s->heap)) {
+        int u = heap_pop_min(&s->heap, NULL);
+        side_settle(qc, s, u);
+        settledCount++;
+        if (u == destIdx) break;
+        
+        int du = s->dist[u];
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            int v = fg->edges[e].dest;
+            if (side_is_settled(qc, s, v)) continue;
+            
+            int newDist = du + fg->edges[e].distance;
+            if (newDist < side_dist(qc, s, v)) {
+                int hv = potential_of(li, qc, v, destIdx);
+                if (hv == ALT_UNREACHABLE) continue;
+                side_set(qc, s, v, newDist, u);
+                heap_push_or_decrease(&s->heap, v, newDist + hv);
+            }
+        }
+    }
+    if (settled != NULL) *settled = settledCount;
+    
+    int dist = side_dist(qc, s, destIdx);
+    if (dist == MAX_DISTANCE) return -1;
+    
+    int len = 0;
+    for (int cur = destIdx; cur != -1; cur = s->link[cur]) {
+        len++;
+    }
+    int at = len;
+    for (int cur = destIdx; cur != -1; cur = s->link[cur]) {
+        path[--at] = fg->ids[cur];
+    }
+    *pathLength = len;
+    return dist;
+}
+
+int landmark_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength, int *settled) {
+    if (g == NULL) return -1;
+    
+    const LandmarkIndex *li = graph_landmarks(g);
+    QueryContext *qc = graph_query_context(g);
+    if (li == NULL || qc == NULL) return -1;
+    return landmark_shortest_path_ctx(g->frozen, li, qc, source, dest, path, pathLength, settled);
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef LANDMARK_H
+#define LANDMARK_H
+
+#include "graph.h"
+#include "query.h"
+
+// ALT lower bounds (A*, landmarks, triangle inequality). A few landmark
+// cities are chosen far apart, and every city keeps its distance from and to
+// each of them. For any city v and target t,
+//     d(v, t) >= d(L, t) - d(L, v)  and  d(v, t) >= d(v, L) - d(t, L),
+// and the largest of these bounds is a consistent A* potential. A city that
+// a landmark reaches but the target's distances say it cannot reach (or the
+// reverse) cannot reach the target at all and is never queued.
+//
+// The bounds stay valid when routes are removed or lengthened, so the graph
+// keeps its index across those edits and only rebuilds it after a route is
+// added or shortened, or a city is added.
+
+#define ALT_LANDMARKS 16     // landmarks the graph builds its index with
+#define ALT_MAX_LANDMARKS 64
+
+typedef struct {
+    int from; // d(landmark, city), MAX_DISTANCE when unreachable
+    int to;   // d(city, landmark)
+} LandmarkDistance;
+
+struct LandmarkIndex {
+    int cityCount;           // dense city indices of the frozen graph it was built from
+    int landmarkCount;
+    int *landmarks;          // dense index of each landmark, -1 for an unused column
+    LandmarkDistance *dist;  // row of landmarkCount entries per city
+};
+
+LandmarkIndex *landmark_build(const FrozenGraph *fg, int count);
+void landmark_free(LandmarkIndex *li);
+int landmark_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength, int *settled);
+int landmark_shortest_path_ctx(const FrozenGraph *fg, const LandmarkIndex *li, QueryContext *qc,
+                               int source, int dest, int *path, int *pathLength, int *settled);
+
+#endif
\ No newline at end of file
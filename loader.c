@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "graph.h"
+#include "loader.h"
+#include "timetable.h"
+
+// Streaming loaders for OpenFlights-style airports.dat / routes.dat files.
+// Nothing is printed per row; both return the number of cities or routes
+// added, or -1 if the file cannot be read.
+
+#define READ_BUFFER_SIZE (1 << 16)
+#define MAX_FIELDS 16
+
+typedef struct {
+    FILE *fp;
+    char *buf;
+    size_t len;
+    size_t pos;
+    int eof;
+} LineReader;
+
+static int reader_open(LineReader *r, const char *path) {
+    r->fp = fopen(path, "rb");
+    r->buf = malloc(READ_BUFFER_SIZE + 1);
+    r->len = 0;
+    r->pos = 0;
+    r->eof = 0;
+    
+    if (r->fp == NULL || r->buf == NULL) {
+        if (r->fp != NULL) fclose(r->fp);
+        free(r->buf);
+        return -1;
+    }
+    return 0;
+}
+
+static void reader_close(LineReader *r) {
+    fclose(r->fp);
+    free(r->buf);
+}
+
+static void reader_rewind(LineReader *r) {
+    rewind(r->fp);
+    r->len = 0;
+    r->pos = 0;
+    r->eof = 0;
+}
+
+// returns the next line without its line ending, valid until the next call
+static char *next_line(LineReader *r) {
+    for (;;) {
+        char *start = r->buf + r->pos;
+        char *nl = memchr(start, '\n', r->len - r->pos);
+        if (nl != NULL) {
+            *nl = '\0';
+            r->pos = nl - r->buf + 1;
+            if (nl > start && nl[-1] == '\r') nl[-1] = '\0';
+            return start;
+        }
+        
+        if (r->eof) {
+            if (r->pos >= r->len) return NULL;
+            r->buf[r->len] = '\0';
+            r->pos = r->len;
+            return start;
+        }
+        
+        // keep the partial line and refill behind it
+        size_t rest = r->len - r->pos;
+        if (rest == READ_BUFFER_SIZE) {
+            r->buf[r->len] = '\0'; // over-long line, hand it out truncated
+            r->pos = r->len;
+            return start;
+        }
+        memmove(r->buf, start, rest);
+        r->len = rest;
+        r->pos = 0;
+        
+        size_t got = fread(r->buf + r->len, 1, READ_BUFFER_SIZE - r->len, r->fp);
+        r->len += got;
+        if (got == 0) r->eof = 1;
+    }
+}
+
+static int count_lines(LineReader *r) {
+    int lines = 0;
+    while (next_line(r) != NULL) lines++;
+    reader_rewind(r);
+    return lines;
+}
+
+// splits a CSV line in place; quoted fields may contain commas and \" escapes
+static int split_csv(char *line, char **fields, int maxFields) {
+    int count = 0;
+    char *p = line;
+    
+    while (count < maxFields) {
+        if (*p == '"') {
+            char *out = ++p;
+            fields[count++] = out;
+            while (*p != '\0' && *p != '"') {
+                if (*p == '\\' && p[1] != '\0') p++;
+                *out++ = *p++;
+            }
+            if (*p == '"') p++;
+            while (*p != '\0' && *p != ',') p++;
+            char next = *p;
+            *out = '\0';
+            if (next == '\0') break;
+            p++;
+        } else {
+            fields[count++] = p;
+            char *comma = strchr(p, ',');
+            if (comma == NULL) break;
+            *comma = '\0';
+            p = comma + 1;
+        }
+    }
+    return count;
+}
+
+// OpenFlights marks missing values with \N
+static int parse_int(const char *s, int *out) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s || *end != '\0') return 0;
+    *out = (int)v;
+    return 1;
+}
+
+static int parse_double(const char *s, double *out) {
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s) return 0;
+    *out = v;
+    return 1;
+}
+
+// airports.dat: id, name, city, country, IATA, ICAO, latitude, longitude, ...
+int load_airports(Graph *g, const char *path) {
+    if (g == NULL || path == NULL) return -1;
+    
+    LineReader r;
+    if (reader_open(&r, path) != 0) return -1;
+    
+    graph_reserve_cities(g, g->cityCount + count_lines(&r));
+    
+    int added = 0;
+    char *line;
+    char *fields[MAX_FIELDS];
+    char name[256];
+    while ((line = next_line(&r)) != NULL) {
+        if (split_csv(line, fields, MAX_FIELDS) < 8) continue;
+        
+        int id;
+        double lat, lon;
+        if (!parse_int(fields[0], &id) || !parse_double(fields[6], &lat) ||
+            !parse_double(fields[7], &lon)) continue;
+        if (find_city_index(g, id) != -1) continue;
+        
+        const char *city = fields[2][0] != '\0' ? fields[2] : fields[1];
+        if (strlen(fields[4]) == 3) {
+            snprintf(name, sizeof(name), "%s (%s)", city, fields[4]);
+        } else {
+            snprintf(name, sizeof(name), "%s", city);
+        }
+        add_city(g, id, name, lat, lon);
+        added++;
+    }
+    
+    reader_close(&r);
+    return added;
+}
+
+// routes.dat: airline, airline id, source, source id, destination, destination id, ...
+// Distances are the great-circle length between the two airports, rounded up.
+int load_routes(Graph *g, const char *path) {
+    if (g == NULL || path == NULL) return -1;
+    
+    LineReader r;
+    if (reader_open(&r, path) != 0) return -1;
+    
+    int cap = count_lines(&r);
+    RouteSpec *routes = malloc((cap > 0 ? cap : 1) * sizeof(RouteSpec));
+    if (routes == NULL) {
+        reader_close(&r);
+        return -1;
+    }
+    
+    int count = 0;
+    char *line;
+    char *fields[MAX_FIELDS];
+    while ((line = next_line(&r)) != NULL && count < cap) {
+        if (split_csv(line, fields, MAX_FIELDS) < 6) continue;
+        
+        int from, to;
+        if (!parse_int(fields[3], &from) || !parse_int(fields[5], &to)) continue;
+        
+        int ai = find_city_index(g, from);
+        int bi = find_city_index(g, to);
+        if (ai == -1 || bi == -1) continue;
+        
+        const City *a = &g->cities[ai];
+        const City *b = &g->cities[bi];
+        routes[count].from = from;
+        routes[count].to = to;
+        routes[count].distance = (int)ceil(great_circle_km(a->latitude, a->longitude,
+                                                           b->latitude, b->longitude));
+        count++;
+    }
+    reader_close(&r);
+    
+    int added = add_routes_bulk(g, routes, count);
+    free(routes);
+    return added;
+}
+
+// HH:MM -> minutes; hours may run past 23 for flights that land the next day
+static int parse_clock(const char *s, int *out) {
+    char *end;
+    long hours = strtol(s, &end, 10);
+    if (end == s || *end != ':' || hours < 0) return 0;
+    
+    const char *m = end + 1;
+    long minutes = strtol(m, &end, 10);
+    if (end == m || *end != '\0' || minutes < 0 || minutes > 59) return 0;
+    *out = (int)(hours * 60 + minutes);
+    return 1;
+}
+
+// schedule: source id, destination id, departure HH:MM, arrival HH:MM[, flight number]
+// An arrival earlier than the departure lands the next day. Lines starting
+// with # and rows that do not parse are skipped.
+Timetable *load_timetable(Graph *g, const char *path, int minTransfer) {
+    if (g == NULL || path == NULL) return NULL;
+    
+    LineReader r;
+    if (reader_open(&r, path) != 0) return NULL;
+    
+    int cap = count_lines(&r);
+    FlightSpec *flights = malloc((cap > 0 ? cap : 1) * sizeof(FlightSpec));
+    if (flights == NULL) {
+        reader_close(&r);
+        return NULL;
+    }
+    
+    int count = 0;
+    char *line;
+    char *fields[MAX_FIELDS];
+    while ((line = next_line(&r)) != NULL && count < cap) {
+        if (line[0] == '#') continue;
+        int fieldCount = split_csv(line, fields, MAX_FIELDS);
+        if (fieldCount < 4) continue;
+        
+        FlightSpec *f = &flights[count];
+        if (!parse_int(fields[0], &f->from) || !parse_int(fields[1], &f->to) ||
+            !parse_clock(fields[2], &f->departure) || !parse_clock(fields[3], &f->arrival)) continue;
+        if (f->arrival < f->departure) f->arrival += MINUTES_PER_DAY;
+        if (fieldCount < 5 || !parse_int(fields[4], &f->flight)) f->flight = -1;
+        count++;
+    }
+    reader_close(&r);
+    
+    Timetable *tt = timetable_build(g, flights, count, minTransfer);
+    free(flights);
+    return tt;
+}
\ No newline at end of file
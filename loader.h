@@ -0,0 +1,11 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "graph.h"
+#include "timetable.h"
+
+int load_airports(Graph *g, const char *path);
+int load_routes(Graph *g, const char *path);
+Timetable *load_timetable(Graph *g, const char *path, int minTransfer);
+
+#endif
\ No newline at end of file
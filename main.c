@@ -1,329 +1,928 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include "graph.h"
-
-void show_menu(void) {
-    printf("\n");
-    printf("========================================\n");
-    printf("    AIRLINE ROUTE MANAGEMENT SYSTEM    \n");
-    printf("========================================\n");
-    printf("1. View cities\n");
-    printf("2. Add route\n");
-    printf("3. Remove route\n");
-    printf("4. Check route connectivity\n");
-    printf("5. Display route map\n");
-    printf("6. Find shortest path (Dijkstra)\n");
-    printf("7. Find alternate route\n");
-    printf("0. Exit\n");
-    printf("========================================\n");
-    printf("Enter choice: ");
-}
-
-void clear_input_buffer(void) {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
-}
-
-int main(void) {
-    Graph g;
-    init_graph(&g);
-    
-    printf("Initializing airline network with 15 cities...\n");
-    add_city(&g, 1, "New Delhi");
-    add_city(&g, 2, "Mumbai");
-    add_city(&g, 3, "Bengaluru");
-    add_city(&g, 4, "Chennai");
-    add_city(&g, 5, "Kolkata");
-    add_city(&g, 6, "Hyderabad");
-    add_city(&g, 7, "Pune");
-    add_city(&g, 8, "Ahmedabad");
-    add_city(&g, 9, "Jaipur");
-    add_city(&g, 10, "Lucknow");
-    add_city(&g, 11, "Kochi");
-    add_city(&g, 12, "Visakhapatnam");
-    add_city(&g, 13, "Indore");
-    add_city(&g, 14, "Chandigarh");
-    add_city(&g, 15, "Goa");
-    
-    printf("\nSetting up default routes...\n");
-    // Routes from Delhi (1)
-    add_route(&g, 1, 2, 1400);
-    add_route(&g, 1, 3, 2150);
-    add_route(&g, 1, 5, 1500);
-    add_route(&g, 1, 6, 1430);
-    add_route(&g, 1, 8, 950);
-    add_route(&g, 1, 9, 250);
-    add_route(&g, 1, 10, 500);
-    add_route(&g, 1, 14, 245);
-    
-    // Routes from Mumbai (2)
-    add_route(&g, 2, 3, 980);
-    add_route(&g, 2, 4, 1330);
-    add_route(&g, 2, 6, 700);
-    add_route(&g, 2, 7, 210);
-    add_route(&g, 2, 8, 550);
-    add_route(&g, 2, 13, 700);
-    add_route(&g, 2, 15, 600);
-    
-    // Routes from Bengaluru (3)
-    add_route(&g, 3, 4, 350);
-    add_route(&g, 3, 6, 470);
-    add_route(&g, 3, 11, 800);
-    add_route(&g, 3, 12, 550);
-    
-    // Routes from Chennai (4)
-    add_route(&g, 4, 6, 340);
-    add_route(&g, 4, 11, 680);
-    add_route(&g, 4, 12, 450);
-    
-    // Routes from Kolkata (5)
-    add_route(&g, 5, 10, 550);
-    add_route(&g, 5, 12, 1100);
-    
-    // Routes from Hyderabad (6)
-    add_route(&g, 6, 11, 800);
-    add_route(&g, 6, 12, 300);
-    add_route(&g, 6, 13, 550);
-    
-    // Routes from Pune (7)
-    add_route(&g, 7, 3, 1200);
-    add_route(&g, 7, 15, 450);
-    
-    // Routes from Ahmedabad (8)
-    add_route(&g, 8, 9, 700);
-    add_route(&g, 8, 13, 600);
-    
-    // Routes from Jaipur (9)
-    add_route(&g, 9, 10, 750);
-    add_route(&g, 9, 14, 350);
-    
-    // Routes from Kochi (11)
-    add_route(&g, 11, 15, 1050);
-    
-    // Routes from Visakhapatnam (12)
-    add_route(&g, 12, 13, 800);
-    
-    // Routes from Indore (13)
-    add_route(&g, 13, 14, 900);
-    
-    printf("\nAirline network initialized successfully with 15 cities!\n");
-    
-    int choice;
-    int from, to, distance;
-    int scanResult;
-    
-    while (1) {
-        show_menu();
-        
-        scanResult = scanf("%d", &choice);
-        if (scanResult != 1) {
-            printf("\nError: Invalid input! Please enter a number.\n");
-            clear_input_buffer();
-            continue;
-        }
-        
-        if (choice == 0) {
-            printf("\nThank you for using Airline Route Management System!\n");
-            printf("Exiting...\n");
-            break;
-        }
-        
-        switch (choice) {
-            case 1:
-                print_cities(&g);
-                break;
-                
-            case 2:
-                printf("\nEnter source city ID: ");
-                if (scanf("%d", &from) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("Enter destination city ID: ");
-                if (scanf("%d", &to) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("Enter distance in km: ");
-                if (scanf("%d", &distance) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                add_route(&g, from, to, distance);
-                break;
-                
-            case 3:
-                printf("\nEnter source city ID: ");
-                if (scanf("%d", &from) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("Enter destination city ID: ");
-                if (scanf("%d", &to) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                remove_route(&g, from, to);
-                break;
-                
-            case 4:
-                printf("\nEnter source city ID: ");
-                if (scanf("%d", &from) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("Enter destination city ID: ");
-                if (scanf("%d", &to) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("\nChecking connectivity...\n");
-                if (can_reach(&g, from, to)) {
-                    printf("Route exists from city %d to city %d\n", from, to);
-                } else {
-                    printf("No route available from city %d to city %d\n", from, to);
-                }
-                break;
-                
-            case 5:
-                print_graph(&g);
-                break;
-                
-            case 6: {
-                printf("\nEnter source city ID: ");
-                if (scanf("%d", &from) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("Enter destination city ID: ");
-                if (scanf("%d", &to) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                int path[100];
-                int pathLength;
-                int dist = dijkstra_shortest_path(&g, from, to, path, &pathLength);
-                
-                if (dist == -1) {
-                    printf("\nNo path exists from city %d to city %d\n", from, to);
-                } else {
-                    printf("\n=== Shortest Path (Dijkstra) ===\n");
-                    printf("Total Distance: %d km\n", dist);
-                    printf("Path: ");
-                    for (int i = 0; i < pathLength; i++) {
-                        int idx = -1;
-                        for (int j = 0; j < g.cityCount; j++) {
-                            if (g.cities[j].id == path[i]) {
-                                idx = j;
-                                break;
-                            }
-                        }
-                        if (idx != -1) {
-                            printf("%s", g.cities[idx].name);
-                            if (i < pathLength - 1) printf(" -> ");
-                        }
-                    }
-                    printf("\n");
-                }
-                break;
-            }
-                
-            case 7: {
-                printf("\nEnter source city ID: ");
-                if (scanf("%d", &from) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                printf("Enter destination city ID: ");
-                if (scanf("%d", &to) != 1) {
-                    printf("Invalid input!\n");
-                    clear_input_buffer();
-                    break;
-                }
-                
-                int shortestPath[100];
-                int shortestLength;
-                int shortestDist = dijkstra_shortest_path(&g, from, to, shortestPath, &shortestLength);
-                
-                if (shortestDist == -1) {
-                    printf("\nNo path exists from city %d to city %d\n", from, to);
-                    break;
-                }
-                
-                printf("\n=== Shortest Path ===\n");
-                printf("Distance: %d km\n", shortestDist);
-                printf("Path: ");
-                for (int i = 0; i < shortestLength; i++) {
-                    int idx = -1;
-                    for (int j = 0; j < g.cityCount; j++) {
-                        if (g.cities[j].id == shortestPath[i]) {
-                            idx = j;
-                            break;
-                        }
-                    }
-                    if (idx != -1) {
-                        printf("%s", g.cities[idx].name);
-                        if (i < shortestLength - 1) printf(" -> ");
-                    }
-                }
-                printf("\n");
-                
-                int altPath[100];
-                int altLength;
-                int altDist = find_alternate_route(&g, from, to, altPath, &altLength, shortestPath, shortestLength);
-                
-                if (altDist == -1) {
-                    printf("\nNo alternate route available\n");
-                } else {
-                    printf("\n=== Alternate Route ===\n");
-                    printf("Distance: %d km\n", altDist);
-                    printf("Path: ");
-                    for (int i = 0; i < altLength; i++) {
-                        int idx = -1;
-                        for (int j = 0; j < g.cityCount; j++) {
-                            if (g.cities[j].id == altPath[i]) {
-                                idx = j;
-                                break;
-                            }
-                        }
-                        if (idx != -1) {
-                            printf("%s", g.cities[idx].name);
-                            if (i < altLength - 1) printf(" -> ");
-                        }
-                    }
-                    printf("\n");
-                    printf("Additional distance: %d km\n", altDist - shortestDist);
-                }
-                break;
-            }
-                
-            default:
-                printf("\nInvalid choice! Please select a valid option (0-7).\n");
-                break;
-        }
-    }
-    
-    free_graph(&g);
-    
-    return 0;
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "graph.h"
+#include "loader.h"
+#include "ksp.h"
+#include "astar.h"
+#include "ch.h"
+#include "snapshot.h"
+#include "batch.h"
+#include "workers.h"
+#include "apsp.h"
+#include "pathcache.h"
+#include "stats.h"
+#include "timetable.h"
+#include "bfs.h"
+#include "landmark.h"
+#include "overlay.h"
+#include "sssp.h"
+
+#define MAX_ALTERNATES 10
+#define MAX_HOP_SOURCES 16
+#define MAX_HOP_LISTED 50
+#define MAX_DISTANCE_LISTED 50
+
+typedef struct {
+    int dist;
+    int city;
+} CityDistance;
+
+static int compare_city_distance(const void *a, const void *b) {
+    const CityDistance *x = a;
+    const CityDistance *y = b;
+    if (x->dist != y->dist) return x->dist < y->dist ? -1 : 1;
+    return (x->city > y->city) - (x->city < y->city);
+}
+
+void show_menu(void) {
+    printf("\n");
+    printf("========================================\n");
+    printf("    AIRLINE ROUTE MANAGEMENT SYSTEM    \n");
+    printf("========================================\n");
+    printf("1. View cities\n");
+    printf("2. Add route\n");
+    printf("3. Remove route\n");
+    printf("4. Check route connectivity\n");
+    printf("5. Display route map\n");
+    printf("6. Find shortest path (Dijkstra)\n");
+    printf("7. Find alternate routes\n");
+    printf("8. Find shortest path (bidirectional A*)\n");
+    printf("9. Path cache statistics\n");
+    printf("10. Query statistics\n");
+    printf("11. Earliest arrival (flight schedule)\n");
+    printf("12. Departures over the day (flight schedule)\n");
+    printf("13. Change route distance\n");
+    printf("14. Cities within k hops of a set of cities\n");
+    printf("15. Find shortest path (A* with landmarks)\n");
+    printf("16. Find shortest path (multi-level overlay)\n");
+    printf("17. All cities by distance from a city\n");
+    printf("0. Exit\n");
+    printf("========================================\n");
+    printf("Enter choice: ");
+}
+
+void clear_input_buffer(void) {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+}
+
+int run_batch_file(const FrozenGraph *fg, const char *path, int threads) {
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (fg == NULL || in == NULL) {
+        fprintf(stderr, "Could not read queries from %s\n", path);
+        return 1;
+    }
+    if (threads <= 0) threads = cpu_count();
+    
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    int answered = run_batch(fg, in, stdout, threads);
+    timespec_get(&end, TIME_UTC);
+    if (in != stdin) fclose(in);
+    if (answered < 0) {
+        fprintf(stderr, "Batch run failed\n");
+        return 1;
+    }
+    fprintf(stderr, "Answered %d queries on %d threads in %.1f ms\n", answered, threads,
+            1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6);
+    return 0;
+}
+
+int write_matrix_file(const FrozenGraph *fg, const char *path, int threads) {
+    if (threads <= 0) threads = cpu_count();
+    
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    DistanceMatrix *dm = frozen_all_pairs(fg, APSP_AUTO, threads);
+    timespec_get(&end, TIME_UTC);
+    if (dm == NULL || distance_matrix_write(dm, path) != 0) {
+        fprintf(stderr, "Could not write distance matrix %s\n", path);
+        distance_matrix_free(dm);
+        return 1;
+    }
+    
+    printf("Wrote %d x %d distance matrix to %s (computed on %d threads in %.1f ms)\n",
+           dm->cityCount, dm->cityCount, path, threads,
+           1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6);
+    distance_matrix_free(dm);
+    return 0;
+}
+
+void print_path_names(Graph *g, const int *path, int length) {
+    printf("Path: ");
+    for (int i = 0; i < length; i++) {
+        int idx = find_city_index(g, path[i]);
+        if (idx != -1) {
+            printf("%s", g->cities[idx].name);
+            if (i < length - 1) printf(" -> ");
+        }
+    }
+    printf("\n");
+}
+
+// minutes from the start of the schedule day as HH:MM, +1 when it is the next day
+void print_clock(int minutes) {
+    printf("%02d:%02d", (minutes % MINUTES_PER_DAY) / 60, minutes % 60);
+    if (minutes >= MINUTES_PER_DAY) printf(" (+%d)", minutes / MINUTES_PER_DAY);
+}
+
+int read_clock(int *minutes) {
+    int hours, mins;
+    if (scanf("%d:%d", &hours, &mins) != 2 || hours < 0 || hours > 23 || mins < 0 || mins > 59) {
+        clear_input_buffer();
+        return 0;
+    }
+    *minutes = hours * 60 + mins;
+    return 1;
+}
+
+void print_journey(Graph *g, const JourneyLeg *legs, int count) {
+    for (int i = 0; i < count; i++) {
+        int a = find_city_index(g, legs[i].from);
+        int b = find_city_index(g, legs[i].to);
+        printf("  ");
+        print_clock(legs[i].departure);
+        printf(" %s -> ", a != -1 ? g->cities[a].name : "?");
+        print_clock(legs[i].arrival);
+        printf(" %s\n", b != -1 ? g->cities[b].name : "?");
+    }
+}
+
+void load_default_network(Graph *g) {
+    printf("Initializing airline network with 15 cities...\n");
+    add_city(g, 1, "New Delhi", 28.6139, 77.2090);
+    add_city(g, 2, "Mumbai", 19.0760, 72.8777);
+    add_city(g, 3, "Bengaluru", 12.9716, 77.5946);
+    add_city(g, 4, "Chennai", 13.0827, 80.2707);
+    add_city(g, 5, "Kolkata", 22.5726, 88.3639);
+    add_city(g, 6, "Hyderabad", 17.3850, 78.4867);
+    add_city(g, 7, "Pune", 18.5204, 73.8567);
+    add_city(g, 8, "Ahmedabad", 23.0225, 72.5714);
+    add_city(g, 9, "Jaipur", 26.9124, 75.7873);
+    add_city(g, 10, "Lucknow", 26.8467, 80.9462);
+    add_city(g, 11, "Kochi", 9.9312, 76.2673);
+    add_city(g, 12, "Visakhapatnam", 17.6868, 83.2185);
+    add_city(g, 13, "Indore", 22.7196, 75.8577);
+    add_city(g, 14, "Chandigarh", 30.7333, 76.7794);
+    add_city(g, 15, "Goa", 15.2993, 74.1240);
+    
+    printf("\nSetting up default routes...\n");
+    // Routes from Delhi (1)
+    add_route(g, 1, 2, 1400);
+    add_route(g, 1, 3, 2150);
+    add_route(g, 1, 5, 1500);
+    add_route(g, 1, 6, 1430);
+    add_route(g, 1, 8, 950);
+    add_route(g, 1, 9, 250);
+    add_route(g, 1, 10, 500);
+    add_route(g, 1, 14, 245);
+    
+    // Routes from Mumbai (2)
+    add_route(g, 2, 3, 980);
+    add_route(g, 2, 4, 1330);
+    add_route(g, 2, 6, 700);
+    add_route(g, 2, 7, 210);
+    add_route(g, 2, 8, 550);
+    add_route(g, 2, 13, 700);
+    add_route(g, 2, 15, 600);
+    
+    // Routes from Bengaluru (3)
+    add_route(g, 3, 4, 350);
+    add_route(g, 3, 6, 470);
+    add_route(g, 3, 11, 800);
+    add_route(g, 3, 12, 550);
+    
+    // Routes from Chennai (4)
+    add_route(g, 4, 6, 340);
+    add_route(g, 4, 11, 680);
+    add_route(g, 4, 12, 450);
+    
+    // Routes from Kolkata (5)
+    add_route(g, 5, 10, 550);
+    add_route(g, 5, 12, 1100);
+    
+    // Routes from Hyderabad (6)
+    add_route(g, 6, 11, 800);
+    add_route(g, 6, 12, 300);
+    add_route(g, 6, 13, 550);
+    
+    // Routes from Pune (7)
+    add_route(g, 7, 3, 1200);
+    add_route(g, 7, 15, 450);
+    
+    // Routes from Ahmedabad (8)
+    add_route(g, 8, 9, 700);
+    add_route(g, 8, 13, 600);
+    
+    // Routes from Jaipur (9)
+    add_route(g, 9, 10, 750);
+    add_route(g, 9, 14, 350);
+    
+    // Routes from Kochi (11)
+    add_route(g, 11, 15, 1050);
+    
+    // Routes from Visakhapatnam (12)
+    add_route(g, 12, 13, 800);
+    
+    // Routes from Indore (13)
+    add_route(g, 13, 14, 900);
+    
+    printf("\nAirline network initialized successfully with 15 cities!\n");
+}
+
+int main(int argc, char **argv) {
+    Graph g;
+    init_graph(&g);
+    
+    // air.exe [airports.dat routes.dat | --snapshot file [--verify-snapshot]] [--save-snapshot file]
+    //         [--batch file|- | --matrix file] [--threads n] [--stats] [--timetable file]
+    //         [--track id,id,...] [--verify-ch pairs]
+    const char *snapshotPath = NULL;
+    const char *mapPath = NULL;
+    const char *batchPath = NULL;
+    const char *matrixPath = NULL;
+    const char *timetablePath = NULL;
+    const char *trackList = NULL;
+    const char *dataPaths[2];
+    int dataCount = 0;
+    int threads = 0;
+    int showStats = 0;
+    int verifyPairs = 0;
+    int verifySnapshot = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--save-snapshot") == 0 && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            mapPath = argv[++i];
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc) {
+            matrixPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--timetable") == 0 && i + 1 < argc) {
+            timetablePath = argv[++i];
+        } else if (strcmp(argv[i], "--track") == 0 && i + 1 < argc) {
+            trackList = argv[++i];
+        } else if (strcmp(argv[i], "--verify-snapshot") == 0) {
+            verifySnapshot = 1;
+        } else if (strcmp(argv[i], "--verify-ch") == 0 && i + 1 < argc) {
+            verifyPairs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            showStats = 1;
+        } else if (dataCount < 2) {
+            dataPaths[dataCount++] = argv[i];
+        }
+    }
+    
+    if (mapPath != NULL) {
+        // a mapped snapshot is read-only, so it only serves batch queries and matrices
+        if (batchPath == NULL && matrixPath == NULL) {
+            fprintf(stderr, "--snapshot needs --batch or --matrix\n");
+            return 1;
+        }
+        // the header is always checked; the checksum and arrays only on request, since they read the whole file
+        FrozenGraph *fg = snapshot_open(mapPath, verifySnapshot);
+        if (fg == NULL) {
+            fprintf(stderr, "Could not open snapshot %s\n", mapPath);
+            return 1;
+        }
+        int status = batchPath != NULL ? run_batch_file(fg, batchPath, threads)
+                                       : write_matrix_file(fg, matrixPath, threads);
+        if (showStats) stats_dump(stderr);
+        free_frozen_graph(fg);
+        return status;
+    }
+    
+    if (dataCount == 2) {
+        clock_t start = clock();
+        int cities = load_airports(&g, dataPaths[0]);
+        int routes = cities < 0 ? -1 : load_routes(&g, dataPaths[1]);
+        if (cities < 0 || routes < 0) {
+            fprintf(stderr, "Could not load %s / %s\n", dataPaths[0], dataPaths[1]);
+            free_graph(&g);
+            return 1;
+        }
+        fprintf(batchPath != NULL ? stderr : stdout, "Loaded %d cities and %d routes in %.1f ms\n",
+                cities, routes, 1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+    } else if (batchPath != NULL) {
+        // the built-in network announces every route on stdout, which is the result stream
+        fprintf(stderr, "--batch needs airports.dat routes.dat or --snapshot\n");
+        return 1;
+    } else {
+        load_default_network(&g);
+    }
+    
+    if (snapshotPath != NULL) {
+        const FrozenGraph *fg = graph_snapshot(&g);
+        int status = fg == NULL ? -1 : snapshot_write(fg, snapshotPath);
+        if (status != 0) {
+            fprintf(stderr, "Could not write snapshot %s\n", snapshotPath);
+        } else {
+            printf("Wrote snapshot of %d cities and %d routes to %s\n",
+                   fg->cityCount, fg->edgeCount, snapshotPath);
+        }
+        free_graph(&g);
+        return status != 0;
+    }
+    
+    if (batchPath != NULL) {
+        int status = run_batch_file(graph_snapshot(&g), batchPath, threads);
+        if (showStats) stats_dump(stderr);
+        free_graph(&g);
+        return status;
+    }
+    
+    if (matrixPath != NULL) {
+        int status = write_matrix_file(graph_snapshot(&g), matrixPath, threads);
+        free_graph(&g);
+        return status;
+    }
+    
+    if (verifyPairs > 0) {
+        const FrozenGraph *fg = graph_snapshot(&g);
+        ContractionHierarchy *ch = ch_build(&g);
+        int mismatches = ch_verify(ch, fg, verifyPairs, 1);
+        if (mismatches < 0) fprintf(stderr, "Could not check the contraction hierarchy\n");
+        else printf("Checked %d pairs against Dijkstra, %d mismatches\n", verifyPairs, mismatches);
+        ch_free(ch);
+        free_graph(&g);
+        return mismatches != 0;
+    }
+    
+    graph_enable_path_cache(&g, PATH_CACHE_DEFAULT_CAPACITY);
+    
+    Timetable *tt = NULL;
+    if (timetablePath != NULL) {
+        tt = load_timetable(&g, timetablePath, DEFAULT_MIN_TRANSFER);
+        if (tt == NULL) {
+            fprintf(stderr, "Could not load flight schedule %s\n", timetablePath);
+            free_graph(&g);
+            return 1;
+        }
+        printf("Loaded %d flights (%d minute minimum connection time)\n", tt->connectionCount, tt->minTransfer);
+    }
+    
+    // hubs whose shortest path trees every edit keeps current, e.g. --track 1,2,3
+    for (const char *p = trackList; p != NULL && *p != '\0'; ) {
+        char *end;
+        int cityId = (int)strtol(p, &end, 10);
+        if (end == p || graph_track_source(&g, cityId) == NULL) {
+            fprintf(stderr, "Cannot track city %.*s\n", (int)strcspn(p, ","), p);
+        } else {
+            printf("Tracking shortest paths from %s\n", g.cities[find_city_index(&g, cityId)].name);
+        }
+        p += strcspn(p, ",");
+        if (*p == ',') p++;
+    }
+    
+    int choice;
+    int from, to, distance;
+    int scanResult;
+    
+    while (1) {
+        show_menu();
+        
+        scanResult = scanf("%d", &choice);
+        if (scanResult != 1) {
+            printf("\nError: Invalid input! Please enter a number.\n");
+            clear_input_buffer();
+            continue;
+        }
+        
+        if (choice == 0) {
+            printf("\nThank you for using Airline Route Management System!\n");
+            printf("Exiting...\n");
+            break;
+        }
+        
+        switch (choice) {
+            case 1:
+                print_cities(&g);
+                break;
+                
+            case 2:
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter distance in km: ");
+                if (scanf("%d", &distance) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                add_route(&g, from, to, distance);
+                break;
+                
+            case 3:
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                remove_route(&g, from, to);
+                break;
+                
+            case 4:
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("\nChecking connectivity...\n");
+                if (can_reach(&g, from, to)) {
+                    printf("Route exists from city %d to city %d\n", from, to);
+                } else {
+                    printf("No route available from city %d to city %d\n", from, to);
+                }
+                break;
+                
+            case 5:
+                print_graph(&g);
+                break;
+                
+            case 6: {
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                int path[100];
+                int pathLength;
+                int dist = dijkstra_shortest_path(&g, from, to, path, &pathLength);
+                
+                if (dist == -1) {
+                    printf("\nNo path exists from city %d to city %d\n", from, to);
+                } else {
+                    printf("\n=== Shortest Path (Dijkstra) ===\n");
+                    printf("Total Distance: %d km\n", dist);
+                    printf("Path: ");
+                    for (int i = 0; i < pathLength; i++) {
+                        int idx = find_city_index(&g, path[i]);
+                        if (idx != -1) {
+                            printf("%s", g.cities[idx].name);
+                            if (i < pathLength - 1) printf(" -> ");
+                        }
+                    }
+                    printf("\n");
+                }
+                break;
+            }
+                
+            case 7: {
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                int altCount;
+                printf("How many alternate routes to show: ");
+                if (scanf("%d", &altCount) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                if (altCount < 1) altCount = 1;
+                if (altCount > MAX_ALTERNATES) altCount = MAX_ALTERNATES;
+                
+                Itinerary routes[MAX_ALTERNATES + 1];
+                int found = k_shortest_paths(&g, from, to, altCount + 1, routes);
+                
+                if (found <= 0) {
+                    printf("\nNo path exists from city %d to city %d\n", from, to);
+                    break;
+                }
+                
+                printf("\n=== Shortest Path ===\n");
+                printf("Distance: %d km\n", routes[0].distance);
+                print_path_names(&g, routes[0].cities, routes[0].length);
+                
+                if (found == 1) {
+                    printf("\nNo alternate route available\n");
+                }
+                for (int r = 1; r < found; r++) {
+                    printf("\n=== Alternate Route %d ===\n", r);
+                    printf("Distance: %d km\n", routes[r].distance);
+                    print_path_names(&g, routes[r].cities, routes[r].length);
+                    printf("Additional distance: %d km\n", routes[r].distance - routes[0].distance);
+                }
+                
+                free_itineraries(routes, found);
+                break;
+            }
+                
+            case 8: {
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                int *path = malloc((g.cityCount > 0 ? g.cityCount : 1) * sizeof(int));
+                int *dijkstraPath = malloc((g.cityCount > 0 ? g.cityCount : 1) * sizeof(int));
+                if (path == NULL || dijkstraPath == NULL) {
+                    printf("Memory allocation failed\n");
+                    free(path);
+                    free(dijkstraPath);
+                    break;
+                }
+                
+                int pathLength;
+                int settled, dijkstraSettled;
+                int dist = point_to_point_path(&g, from, to, path, &pathLength, &settled);
+                
+                if (dist == -1) {
+                    printf("\nNo path exists from city %d to city %d\n", from, to);
+                    free(path);
+                    free(dijkstraPath);
+                    break;
+                }
+                
+                int dijkstraLength;
+                frozen_shortest_path(graph_snapshot(&g), from, to, dijkstraPath, &dijkstraLength, &dijkstraSettled);
+                printf("\n=== Shortest Path (bidirectional A*) ===\n");
+                printf("Total Distance: %d km\n", dist);
+                print_path_names(&g, path, pathLength);
+                printf("Cities settled: %d (plain Dijkstra: %d)\n", settled, dijkstraSettled);
+                free(path);
+                free(dijkstraPath);
+                break;
+            }
+                
+            case 9: {
+                const PathCache *pc = g.cache;
+                if (pc == NULL) {
+                    printf("\nPath cache is disabled\n");
+                    break;
+                }
+                unsigned long lookups = pc->hits + pc->misses;
+                printf("\n=== Path Cache ===\n");
+                printf("Entries: %d / %d\n", pc->used, pc->capacity);
+                printf("Hits: %lu  Misses: %lu  Hit rate: %.1f%%\n", pc->hits, pc->misses,
+                       lookups > 0 ? 100.0 * pc->hits / lookups : 0.0);
+                printf("Evictions: %lu  Invalidated by route removal: %lu\n",
+                       pc->evictions, pc->invalidations);
+                break;
+            }
+                
+            case 10:
+                stats_dump(stdout);
+                break;
+                
+            case 11:
+            case 12: {
+                if (tt == NULL) {
+                    printf("\nNo flight schedule loaded (start with --timetable file)\n");
+                    break;
+                }
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                if (choice == 12) {
+                    ProfileEntry *entries;
+                    int count = timetable_profile(tt, from, to, 0, MINUTES_PER_DAY - 1, &entries);
+                    if (count <= 0) {
+                        printf("\nNo flights connect city %d to city %d\n", from, to);
+                        free(entries);
+                        break;
+                    }
+                    printf("\n=== Departures from %d to %d ===\n", from, to);
+                    for (int i = 0; i < count; i++) {
+                        printf("Depart ");
+                        print_clock(entries[i].departure);
+                        printf("  arrive ");
+                        print_clock(entries[i].arrival);
+                        printf("\n");
+                    }
+                    free(entries);
+                    break;
+                }
+                
+                int departAfter;
+                printf("Depart after (HH:MM): ");
+                if (!read_clock(&departAfter)) {
+                    printf("Invalid time!\n");
+                    break;
+                }
+                
+                TimetableQuery *tq = timetable_query_create(tt);
+                JourneyLeg *legs = malloc((tt->cityCount > 0 ? tt->cityCount : 1) * sizeof(JourneyLeg));
+                int legCount = 0;
+                int arrival = tq == NULL || legs == NULL ? -1
+                              : timetable_earliest_arrival(tt, tq, from, to, departAfter, legs, &legCount);
+                if (arrival < 0) {
+                    printf("\nNo connection from city %d to city %d after ", from, to);
+                    print_clock(departAfter);
+                    printf("\n");
+                } else {
+                    printf("\n=== Earliest Arrival ===\n");
+                    printf("Arrive: ");
+                    print_clock(arrival);
+                    printf("\n");
+                    print_journey(&g, legs, legCount);
+                }
+                timetable_query_free(tq);
+                free(legs);
+                break;
+            }
+                
+            case 13:
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter new distance in km: ");
+                if (scanf("%d", &distance) != 1 || distance < 0) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                set_route_distance(&g, from, to, distance);
+                break;
+                
+            case 14: {
+                int sourceCount;
+                printf("\nHow many starting cities (1-%d)? ", MAX_HOP_SOURCES);
+                if (scanf("%d", &sourceCount) != 1 || sourceCount < 1 || sourceCount > MAX_HOP_SOURCES) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                int sources[MAX_HOP_SOURCES];
+                int valid = 1;
+                for (int i = 0; i < sourceCount && valid; i++) {
+                    printf("Enter city ID %d: ", i + 1);
+                    if (scanf("%d", &sources[i]) != 1) {
+                        printf("Invalid input!\n");
+                        clear_input_buffer();
+                        valid = 0;
+                    } else if (find_city_index(&g, sources[i]) == -1) {
+                        printf("City %d not found\n", sources[i]);
+                        valid = 0;
+                    }
+                }
+                if (!valid) break;
+                
+                int maxHops;
+                printf("Maximum hops (0 for any number): ");
+                if (scanf("%d", &maxHops) != 1 || maxHops < 0) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                const FrozenGraph *fg = graph_snapshot(&g);
+                ParallelBfs *b = bfs_create(fg, threads);
+                int reached = b == NULL ? -1 : bfs_run(b, sources, sourceCount, maxHops == 0 ? BFS_UNLIMITED : maxHops);
+                if (reached < 0) {
+                    printf("\nSearch failed\n");
+                    bfs_free(b);
+                    break;
+                }
+                
+                printf("\n=== Reachable Cities ===\n");
+                printf("%d of %d cities reached in %d levels\n", reached, fg->cityCount, b->levels);
+                int listed = 0;
+                for (int v = 0; v < fg->cityCount; v++) {
+                    if (b->hops[v] <= 0) continue;
+                    if (listed++ == MAX_HOP_LISTED) {
+                        printf("...\n");
+                        break;
+                    }
+                    printf("%d (%s): %d hop%s\n", fg->ids[v], frozen_city_name(fg, v), b->hops[v],
+                           b->hops[v] == 1 ? "" : "s");
+                }
+                bfs_free(b);
+                break;
+            }
+                
+            case 15: {
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                int *path = malloc((g.cityCount > 0 ? g.cityCount : 1) * sizeof(int));
+                int *dijkstraPath = malloc((g.cityCount > 0 ? g.cityCount : 1) * sizeof(int));
+                if (path == NULL || dijkstraPath == NULL) {
+                    printf("Memory allocation failed\n");
+                    free(path);
+                    free(dijkstraPath);
+                    break;
+                }
+                
+                int pathLength;
+                int settled, dijkstraSettled;
+                int dist = landmark_shortest_path(&g, from, to, path, &pathLength, &settled);
+                
+                if (dist == -1) {
+                    printf("\nNo path exists from city %d to city %d\n", from, to);
+                    free(path);
+                    free(dijkstraPath);
+                    break;
+                }
+                
+                int dijkstraLength;
+                frozen_shortest_path(graph_snapshot(&g), from, to, dijkstraPath, &dijkstraLength, &dijkstraSettled);
+                printf("\n=== Shortest Path (A* with %d landmarks) ===\n", g.landmarks->landmarkCount);
+                printf("Total Distance: %d km\n", dist);
+                print_path_names(&g, path, pathLength);
+                printf("Cities settled: %d (plain Dijkstra: %d)\n", settled, dijkstraSettled);
+                free(path);
+                free(dijkstraPath);
+                break;
+            }
+                
+            case 16: {
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                printf("Enter destination city ID: ");
+                if (scanf("%d", &to) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                int *path = malloc((g.cityCount > 0 ? g.cityCount : 1) * sizeof(int));
+                int *dijkstraPath = malloc((g.cityCount > 0 ? g.cityCount : 1) * sizeof(int));
+                if (path == NULL || dijkstraPath == NULL) {
+                    printf("Memory allocation failed\n");
+                    free(path);
+                    free(dijkstraPath);
+                    break;
+                }
+                
+                int pathLength;
+                int settled, dijkstraSettled;
+                int dist = overlay_shortest_path(&g, from, to, path, &pathLength, &settled);
+                
+                if (dist == -1) {
+                    printf("\nNo path exists from city %d to city %d\n", from, to);
+                    free(path);
+                    free(dijkstraPath);
+                    break;
+                }
+                
+                int dijkstraLength;
+                frozen_shortest_path(graph_snapshot(&g), from, to, dijkstraPath, &dijkstraLength, &dijkstraSettled);
+                printf("\n=== Shortest Path (overlay, %lld cell distances) ===\n", overlay_matrix_entries(g.overlay));
+                printf("Total Distance: %d km\n", dist);
+                print_path_names(&g, path, pathLength);
+                printf("Cities settled: %d (plain Dijkstra: %d)\n", settled, dijkstraSettled);
+                free(path);
+                free(dijkstraPath);
+                break;
+            }
+                
+            case 17: {
+                printf("\nEnter source city ID: ");
+                if (scanf("%d", &from) != 1) {
+                    printf("Invalid input!\n");
+                    clear_input_buffer();
+                    break;
+                }
+                
+                const FrozenGraph *fg = graph_snapshot(&g);
+                DeltaStepping *ds = sssp_create(fg, threads, SSSP_AUTO_DELTA);
+                CityDistance *order = fg == NULL ? NULL : malloc((fg->cityCount > 0 ? fg->cityCount : 1) * sizeof(CityDistance));
+                int reached = ds == NULL || order == NULL ? -1 : sssp_run(ds, from);
+                if (reached < 0) {
+                    printf("\nCity %d not found\n", from);
+                    sssp_free(ds);
+                    free(order);
+                    break;
+                }
+                
+                int count = 0;
+                for (int v = 0; v < fg->cityCount; v++) {
+                    if (ds->dist[v] == MAX_DISTANCE || ds->pred[v] == -1) continue;
+                    order[count].dist = ds->dist[v];
+                    order[count].city = v;
+                    count++;
+                }
+                qsort(order, count, sizeof(CityDistance), compare_city_distance);
+                
+                printf("\n=== Cities by Distance from %d ===\n", from);
+                printf("%d of %d cities reached\n", reached, fg->cityCount);
+                for (int i = 0; i < count; i++) {
+                    if (i == MAX_DISTANCE_LISTED) {
+                        printf("...\n");
+                        break;
+                    }
+                    int v = order[i].city;
+                    int pred = ds->pred[v];
+                    printf("%d (%s): %d km, arriving from %s\n", fg->ids[v], frozen_city_name(fg, v), order[i].dist,
+                           frozen_city_name(fg, pred));
+                }
+                sssp_free(ds);
+                free(order);
+                break;
+            }
+                
+            default:
+                printf("\nInvalid choice! Please select a valid option (0-17).\n");
+                break;
+        }
+    }
+    
+    if (showStats) stats_dump(stdout);
+    timetable_free(tt);
+    free_graph(&g);
+    
+    return 0;
 }
\ No newline at end of file
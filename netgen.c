@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "graph.h"
+#include "netgen.h"
+
+#define SPOKE_SPREAD_DEG 4.0 // how far regional airports sit from their hub
+#define POLAR_CIRCLE_DEG 66.0 // cities are placed between the polar circles
+#define KM_PER_DEG 111.19
+#define DETOUR_MAX 0.15      // flown distance exceeds great-circle by up to 15%
+#define CRUISE_KMH 800       // block time of a generated flight is taxi time plus cruise
+#define TAXI_MINUTES 30
+#define FIRST_DEPARTURE 360  // 06:00
+#define LAST_DEPARTURE 1320  // 22:00
+#define DEG_TO_RAD (3.14159265358979323846 / 180.0)
+
+void netgen_rng_seed(NetgenRng *rng, uint64_t seed) {
+    rng->state = seed;
+}
+
+// splitmix64
+uint64_t netgen_rng_next(NetgenRng *rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int netgen_rng_below(NetgenRng *rng, int bound) {
+    if (bound <= 0) return 0;
+    return (int)(((netgen_rng_next(rng) >> 32) * (uint64_t)bound) >> 32);
+}
+
+double netgen_rng_unit(NetgenRng *rng) {
+    return (netgen_rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void netgen_default_params(NetgenParams *p, NetgenModel model, int cityCount, uint64_t seed) {
+    p->model = model;
+    p->cityCount = cityCount;
+    p->hubCount = 0;
+    p->linksPerCity = model == NETGEN_SCALE_FREE ? 3 : 2;
+    p->seed = seed;
+}
+
+// cities bucketed by latitude band and longitude slot, for nearest city searches
+typedef struct {
+    int rows;
+    int cols;
+    double rowDeg;
+    double colDeg;
+    double cellKm;    // cities r cells apart are at least about (r - 1) * cellKm apart
+    int *head;        // first city of each cell, -1 when empty
+    int *next;        // next city in the same cell
+} CityGrid;
+
+typedef struct {
+    NetgenRng rng;
+    double *lat;
+    double *lon;
+    RouteSpec *routes;
+    int routeCount;
+    int routeCap;
+    int *ends;        // every route endpoint once, so a uniform pick is degree-proportional
+    int endCount;
+} Builder;
+
+static void wrap_coordinates(double *lat, double *lon) {
+    if (*lat > 85.0) *lat = 85.0;
+    if (*lat < -85.0) *lat = -85.0;
+    while (*lon >= 180.0) *lon -= 360.0;
+    while (*lon < -180.0) *lon += 360.0;
+}
+
+static void place_uniform(Builder *b, int i) {
+    // uniform over the sphere between the polar circles
+    double z = sin(POLAR_CIRCLE_DEG * DEG_TO_RAD);
+    b->lat[i] = asin((2.0 * netgen_rng_unit(&b->rng) - 1.0) * z) / DEG_TO_RAD;
+    b->lon[i] = 360.0 * netgen_rng_unit(&b->rng) - 180.0;
+}
+
+static void place_near(Builder *b, int i, int anchor) {
+    NetgenRng *r = &b->rng;
+    double dLat = (netgen_rng_unit(r) + netgen_rng_unit(r) + netgen_rng_unit(r) - 1.5) * SPOKE_SPREAD_DEG;
+    double dLon = (netgen_rng_unit(r) + netgen_rng_unit(r) + netgen_rng_unit(r) - 1.5) * SPOKE_SPREAD_DEG;
+    b->lat[i] = b->lat[anchor] + dLat;
+    b->lon[i] = b->lon[anchor] + dLon / cos(b->lat[anchor] * DEG_TO_RAD);
+    wrap_coordinates(&b->lat[i], &b->lon[i]);
+}
+
+// a route in both directions between cities x and y (positions, ids are x + 1 and y + 1)
+static void link_cities(Builder *b, int x, int y) {
+    if (x == y) return;
+    
+    double km = great_circle_km(b->lat[x], b->lon[x], b->lat[y], b->lon[y]);
+    int distance = (int)ceil(km * (1.0 + DETOUR_MAX * netgen_rng_unit(&b->rng)));
+    if (distance < 1) distance = 1;
+    
+    b->routes[b->routeCount].from = x + 1;
+    b->routes[b->routeCount].to = y + 1;
+    b->routes[b->routeCount].distance = distance;
+    b->routeCount++;
+    b->routes[b->routeCount].from = y + 1;
+    b->routes[b->routeCount].to = x + 1;
+    b->routes[b->routeCount].distance = distance;
+    b->routeCount++;
+    
+    b->ends[b->endCount++] = x;
+    b->ends[b->endCount++] = y;
+}
+
+static void build_scale_free(Builder *b, int n, int m) {
+    for (int i = 0; i < n; ++i) {
+        place_uniform(b, i);
+    }
+    
+    // seed clique of m + 1 cities, then each city attaches to m existing ones
+    int seedCount = m + 1 < n ? m + 1 : n;
+    for (int i = 0; i < seedCount; ++i) {
+        for (int j = i + 1; j < seedCount; ++j) {
+            link_cities(b, i, j);
+        }
+    }
+    for (int i = seedCount; i < n; ++i) {
+        int mark = b->endCount;
+        for (int k = 0; k < m; ++k) {
+            // draw only from endpoints that existed before this city arrived
+            link_cities(b, i, b->ends[netgen_rng_below(&b->rng, mark)]);
+        }
+    }
+}
+
+static void build_hub_spoke(Builder *b, int n, int hubs, int m) {
+    // hubs are cities 0 .. hubs - 1, meshed among themselves first
+    for (int h = 0; h < hubs; ++h) {
+        place_uniform(b, h);
+    }
+    int hubLinks = m + 2;
+    for (int h = 1; h < hubs; ++h) {
+        int mark = b->endCount;
+        link_cities(b, h, mark > 0 ? b->ends[netgen_rng_below(&b->rng, mark)] : 0);
+        for (int k = 1; k < hubLinks && k < h; ++k) {
+            link_cities(b, h, b->ends[netgen_rng_below(&b->rng, mark)]);
+        }
+    }
+    
+    // busy hubs attract more regional airports; each spoke also gets m - 1 links to other hubs
+    int hubEnds = b->endCount;
+    for (int i = hubs; i < n; ++i) {
+        int home = hubEnds > 0 ? b->ends[netgen_rng_below(&b->rng, hubEnds)] : 0;
+        place_near(b, i, home);
+        link_cities(b, i, home);
+        for (int k = 1; k < m; ++k) {
+            int other = hubEnds > 0 ? b->ends[netgen_rng_below(&b->rng, hubEnds)] : 0;
+            link_cities(b, i, other);
+        }
+    }
+}
+
+static void grid_cell(const CityGrid *grid, double lat, double lon, int *row, int *col) {
+    *row = (int)((lat + POLAR_CIRCLE_DEG) / grid->rowDeg);
+    *col = (int)((lon + 180.0) / grid->colDeg);
+    if (*row < 0) *row = 0;
+    if (*row >= grid->rows) *row = grid->rows - 1;
+    if (*col < 0) *col = 0;
+    if (*col >= grid->cols) *col = grid->cols - 1;
+}
+
+static void visit_cell(const Builder *b, const CityGrid *grid, int i, int row, int col, int k,
+                       int *found, double *km, int *count) {
+    col = ((col % grid->cols) + grid->cols) % grid->cols;
+    for (int v = grid->head[row * grid->cols + col]; v != -1; v = grid->next[v]) {
+        double d = great_circle_km(b->lat[i], b->lon[i], b->lat[v], b->lon[v]);
+        if (*count == k && d >= km[k - 1]) continue;
+        
+        // insertion into the k nearest so far, nearest first
+        int at = *count < k ? (*count)++ : k - 1;
+        while (at > 0 && km[at - 1] > d) {
+            found[at] = found[at - 1];
+            km[at] = km[at - 1];
+            at--;
+        }
+        found[at] = v;
+        km[at] = d;
+    }
+}
+
+// Up to k of the cities already in the grid nearest to city i, searched ring
+// by ring of cells around its own until no closer one can be left. Column
+// offsets are clamped to one lap around the globe, so no cell is seen twice.
+static int nearest_cities(const Builder *b, const CityGrid *grid, int i, int k, int *found, double *km) {
+    int row, col;
+    grid_cell(grid, b->lat[i], b->lon[i], &row, &col);
+    int westMost = grid->cols / 2;
+    int eastMost = grid->cols - 1 - westMost;
+    int count = 0;
+    
+    for (int r = 0; r <= grid->rows || r <= westMost; ++r) {
+        if (count == k && (r - 1) * grid->cellKm >= km[k - 1]) break;
+        
+        int west = r < westMost ? r : westMost;
+        int east = r < eastMost ? r : eastMost;
+        for (int dr = -r; dr <= r; ++dr) {
+            if (row + dr < 0 || row + dr >= grid->rows) continue;
+            
+            if (dr == -r || dr == r) {
+                for (int dc = -west; dc <= east; ++dc) {
+                    visit_cell(b, grid, i, row + dr, col + dc, k, found, km, &count);
+                }
+            } else {
+                if (west == r) visit_cell(b, grid, i, row + dr, col - r, k, found, km, &count);
+                if (east == r) visit_cell(b, grid, i, row + dr, col + r, k, found, km, &count);
+            }
+        }
+    }
+    return count;
+}
+
+// Cities arrive one by one, uniformly placed, and each links to its m nearest
+// earlier cities. So every route but the first few is short, cities are
+// connected, and a line across the map cuts only the routes near it.
+static int build_regional(Builder *b, int n, int m) {
+    CityGrid grid;
+    // about two cities per cell, cells about square at mid latitudes
+    grid.rows = (int)sqrt(n / 4.4);
+    if (grid.rows < 1) grid.rows = 1;
+    grid.cols = 2 * grid.rows + grid.rows / 5;
+    grid.rowDeg = 2.0 * POLAR_CIRCLE_DEG / grid.rows;
+    grid.colDeg = 360.0 / grid.cols;
+    double minLonKm = grid.colDeg * KM_PER_DEG * cos(POLAR_CIRCLE_DEG * DEG_TO_RAD);
+    grid.cellKm = grid.rowDeg * KM_PER_DEG < minLonKm ? grid.rowDeg * KM_PER_DEG : minLonKm;
+    grid.head = malloc((long long)grid.rows * grid.cols * sizeof(int));
+    grid.next = malloc(n * sizeof(int));
+    int *found = malloc(m * sizeof(int));
+    double *km = malloc(m * sizeof(double));
+    if (grid.head == NULL || grid.next == NULL || found == NULL || km == NULL) {
+        free(grid.head);
+        free(grid.next);
+        free(found);
+        free(km);
+        return -1;
+    }
+    for (int c = 0; c < grid.rows * grid.cols; ++c) {
+        grid.head[c] = -1;
+    }
+    
+    for (int i = 0; i < n; ++i) {
+        place_uniform(b, i);
+        int count = nearest_cities(b, &grid, i, m, found, km);
+        for (int j = 0; j < count; ++j) {
+            link_cities(b, i, found[j]);
+        }
+        
+        int row, col;
+        grid_cell(&grid, b->lat[i], b->lon[i], &row, &col);
+        grid.next[i] = grid.head[row * grid.cols + col];
+        grid.head[row * grid.cols + col] = i;
+    }
+    
+    free(grid.head);
+    free(grid.next);
+    free(found);
+    free(km);
+    return 0;
+}
+
+int netgen_build(Graph *g, const NetgenParams *p) {
+    if (g == NULL || p == NULL || p->cityCount <= 0 || g->cityCount != 0) return -1;
+    
+    int n = p->cityCount;
+    int m = p->linksPerCity > 0 ? p->linksPerCity : 1;
+    int hubs = p->hubCount > 0 ? p->hubCount : n / 100;
+    if (hubs < 1) hubs = 1;
+    if (hubs > n) hubs = n;
+    
+    // upper bound on undirected links for either model
+    long long links = (long long)n * (m + 2) + (long long)(m + 1) * (m + 1);
+    if (links * 2 > 0x7FFFFFFF) return -1;
+    
+    Builder b;
+    netgen_rng_seed(&b.rng, p->seed);
+    b.lat = malloc(n * sizeof(double));
+    b.lon = malloc(n * sizeof(double));
+    b.routeCap = (int)(links * 2);
+    b.routes = malloc(b.routeCap * sizeof(RouteSpec));
+    b.ends = malloc(b.routeCap * sizeof(int));
+    b.routeCount = 0;
+    b.endCount = 0;
+    if (b.lat == NULL || b.lon == NULL || b.routes == NULL || b.ends == NULL) {
+        free(b.lat);
+        free(b.lon);
+        free(b.routes);
+        free(b.ends);
+        return -1;
+    }
+    
+    int failed = 0;
+    if (p->model == NETGEN_SCALE_FREE) {
+        build_scale_free(&b, n, m);
+    } else if (p->model == NETGEN_REGIONAL) {
+        failed = build_regional(&b, n, m) != 0;
+    } else {
+        build_hub_spoke(&b, n, hubs, m);
+    }
+    if (failed) {
+        free(b.lat);
+        free(b.lon);
+        free(b.routes);
+        free(b.ends);
+        return -1;
+    }
+    
+    graph_reserve_cities(g, n);
+    char name[32];
+    for (int i = 0; i < n; ++i) {
+        int isHub = p->model == NETGEN_HUB_SPOKE && i < hubs;
+        snprintf(name, sizeof(name), isHub ? "Hub %d" : "City %d", i + 1);
+        add_city(g, i + 1, name, b.lat[i], b.lon[i]);
+    }
+    int added = add_routes_bulk(g, b.routes, b.routeCount);
+    
+    free(b.lat);
+    free(b.lon);
+    free(b.routes);
+    free(b.ends);
+    return added;
+}
+
+// A day's schedule over every route of g: one to four single-leg flights per
+// route, departing between 06:00 and 22:00, with block times from the route
+// distance. *flights is allocated for the caller. Returns the flight count, or -1.
+int netgen_timetable(const Graph *g, uint64_t seed, FlightSpec **flights) {
+    if (g == NULL || flights == NULL) return -1;
+    
+    long long routes = 0;
+    for (int i = 0; i < g->cityCount; ++i) {
+        routes += g->cities[i].edgeCount;
+    }
+    if (routes * 4 > 0x7FFFFFFF) return -1;
+    
+    *flights = malloc((routes > 0 ? routes * 4 : 1) * sizeof(FlightSpec));
+    if (*flights == NULL) return -1;
+    
+    NetgenRng rng;
+    netgen_rng_seed(&rng, seed);
+    int count = 0;
+    for (int i = 0; i < g->cityCount; ++i) {
+        const City *c = &g->cities[i];
+        for (int j = 0; j < c->edgeCount; ++j) {
+            int block = TAXI_MINUTES + c->edges[j].distance * 60 / CRUISE_KMH;
+            int frequency = 1 + netgen_rng_below(&rng, 4);
+            for (int k = 0; k < frequency; ++k) {
+                FlightSpec *f = &(*flights)[count++];
+                f->from = c->id;
+                f->to = c->edges[j].destId;
+                f->departure = FIRST_DEPARTURE + netgen_rng_below(&rng, LAST_DEPARTURE - FIRST_DEPARTURE);
+                f->arrival = f->departure + block;
+                f->flight = -1;
+            }
+        }
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef NETGEN_H
+#define NETGEN_H
+
+#include <stdint.h>
+#include "graph.h"
+#include "timetable.h"
+
+// Seeded synthetic airline networks for benchmarking. The same parameters
+// always produce the same cities, coordinates and routes. Every route is
+// added in both directions, and its distance is the great-circle distance
+// stretched by a small random detour factor.
+
+typedef enum {
+    NETGEN_HUB_SPOKE, // regional airports around hubs, hubs meshed by preferential attachment
+    NETGEN_SCALE_FREE, // Barabasi-Albert preferential attachment over all cities
+    NETGEN_REGIONAL   // short hops only: each city links to its nearest earlier cities
+} NetgenModel;
+
+typedef struct {
+    NetgenModel model;
+    int cityCount;
+    int hubCount;     // hub-and-spoke only, 0 picks about one hub per 100 cities
+    int linksPerCity; // hub links per spoke city / attachment edges / nearest cities per new city
+    uint64_t seed;
+} NetgenParams;
+
+typedef struct {
+    uint64_t state;
+} NetgenRng;
+
+void netgen_default_params(NetgenParams *p, NetgenModel model, int cityCount, uint64_t seed);
+int netgen_build(Graph *g, const NetgenParams *p);
+int netgen_timetable(const Graph *g, uint64_t seed, FlightSpec **flights);
+
+void netgen_rng_seed(NetgenRng *rng, uint64_t seed);
+uint64_t netgen_rng_next(NetgenRng *rng);
+int netgen_rng_below(NetgenRng *rng, int bound);
+double netgen_rng_unit(NetgenRng *rng);
+
+#endif
\ No newline at end of file
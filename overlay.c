@@ -0,0 +1,528 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "heap.h"
+#include "overlay.h"
+#include "query.h"
+#include "workers.h"
+
+#define DEG_TO_RAD (3.14159265358979323846 / 180.0)
+
+typedef struct {
+    double key;
+    int city;
+} BisectItem;
+
+typedef struct {
+    const FrozenGraph *fg;
+    Overlay *ov;
+    BisectItem *items;
+    int cellSize[OVERLAY_LEVELS];
+} Partitioner;
+
+// search inside one cell, over positions relative to the cell's start in order
+typedef struct {
+    int *dist;
+    unsigned int *stamp; // stamp[i] == generation: dist[i] is set
+    unsigned int generation;
+    int capacity;
+    IndexedHeap heap;
+} CellSearch;
+
+typedef struct {
+    Overlay *ov;
+    int level;
+    int maxCell;
+    atomic_int nextCell;
+} CustomizeJob;
+
+static int compare_items(const void *a, const void *b) {
+    const BisectItem *x = a;
+    const BisectItem *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->city > y->city) - (x->city < y->city);
+}
+
+// cities without coordinates all sit at 0, 0; any split is still a valid partition
+static double coordinate(const double *values, int v) {
+    return isnan(values[v]) ? 0.0 : values[v];
+}
+
+// Splits items[lo, hi) at the median of its wider extent until the range fits
+// a level's cell size, where it becomes one cell of that level. Levels below
+// `open` are not assigned yet for this range.
+static void bisect(Partitioner *p, int lo, int hi, int open) {
+    Overlay *ov = p->ov;
+    while (open > 0 && hi - lo <= p->cellSize[open - 1]) {
+        OverlayLevel *lv = &ov->levels[open - 1];
+        int c = lv->cellCount++;
+        lv->cellStart[c] = lo;
+        for (int i = lo; i < hi; ++i) {
+            lv->cell[p->items[i].city] = c;
+        }
+        open--;
+    }
+    if (open == 0) return;
+    
+    const FrozenGraph *fg = p->fg;
+    double minLat = 90.0, maxLat = -90.0, minLon = 180.0, maxLon = -180.0, sumLat = 0.0;
+    for (int i = lo; i < hi; ++i) {
+        double lat = coordinate(fg->latitude, p->items[i].city);
+        double lon = coordinate(fg->longitude, p->items[i].city);
+        if (lat < minLat) minLat = lat;
+        if (lat > maxLat) maxLat = lat;
+        if (lon < minLon) minLon = lon;
+        if (lon > maxLon) maxLon = lon;
+        sumLat += lat;
+    }
+    int byLat = maxLat - minLat >= (maxLon - minLon) * cos(sumLat / (hi - lo) * DEG_TO_RAD);
+    for (int i = lo; i < hi; ++i) {
+        int v = p->items[i].city;
+        p->items[i].key = byLat ? coordinate(fg->latitude, v) : coordinate(fg->longitude, v);
+    }
+    qsort(p->items + lo, hi - lo, sizeof(BisectItem), compare_items);
+    
+    int mid = lo + (hi - lo) / 2;
+    bisect(p, lo, mid, open);
+    bisect(p, mid, hi, open);
+}
+
+// Entry and exit lists of every cell on one level, and room for the distances
+// of its closed cells. A cell stays open when its entries times its exits
+// would outnumber the overlay's cliqueFactor times the routes inside it:
+// crossing it route by route is then cheaper than through its distances.
+// OVERLAY_ALL_CLOSED closes every cell.
+static int build_boundary(Overlay *ov, OverlayLevel *lv, char *isEntry, char *isExit) {
+    int n = ov->cityCount;
+    memset(isEntry, 0, n);
+    memset(isExit, 0, n);
+    lv->closed = calloc(lv->cellCount > 0 ? lv->cellCount : 1, 1);
+    long long *inner = calloc(lv->cellCount > 0 ? lv->cellCount : 1, sizeof(long long));
+    if (lv->closed == NULL || inner == NULL) {
+        free(inner);
+        return -1;
+    }
+    for (int u = 0; u < n; ++u) {
+        for (int e = ov->offsets[u]; e < ov->offsets[u + 1]; ++e) {
+            int v = ov->heads[e];
+            if (lv->cell[u] != lv->cell[v]) {
+                isExit[u] = 1;
+                isEntry[v] = 1;
+            } else {
+                inner[lv->cell[u]]++;
+            }
+        }
+    }
+    
+    lv->entryStart = malloc((lv->cellCount + 1) * sizeof(int));
+    lv->exitStart = malloc((lv->cellCount + 1) * sizeof(int));
+    lv->matrixStart = malloc((lv->cellCount + 1) * sizeof(long long));
+    lv->entries = malloc((n > 0 ? n : 1) * sizeof(int));
+    lv->exits = malloc((n > 0 ? n : 1) * sizeof(int));
+    lv->entryPos = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (lv->entryStart == NULL || lv->exitStart == NULL || lv->matrixStart == NULL ||
+        lv->entries == NULL || lv->exits == NULL || lv->entryPos == NULL) {
+        free(inner);
+        return -1;
+    }
+    
+    int entryCount = 0;
+    int exitCount = 0;
+    long long cells = 0;
+    for (int c = 0; c < lv->cellCount; ++c) {
+        lv->entryStart[c] = entryCount;
+        lv->exitStart[c] = exitCount;
+        lv->matrixStart[c] = cells;
+        for (int i = lv->cellStart[c]; i < lv->cellStart[c + 1]; ++i) {
+            int v = ov->order[i];
+            lv->entryPos[v] = isEntry[v] ? entryCount - lv->entryStart[c] : -1;
+            if (isEntry[v]) lv->entries[entryCount++] = v;
+            if (isExit[v]) lv->exits[exitCount++] = v;
+        }
+        long long clique = (long long)(entryCount - lv->entryStart[c]) * (exitCount - lv->exitStart[c]);
+        lv->closed[c] = ov->cliqueFactor == OVERLAY_ALL_CLOSED || clique <= ov->cliqueFactor * inner[c];
+        if (lv->closed[c]) cells += clique;
+    }
+    lv->entryStart[lv->cellCount] = entryCount;
+    lv->exitStart[lv->cellCount] = exitCount;
+    lv->matrixStart[lv->cellCount] = cells;
+    lv->matrix = malloc((cells > 0 ? cells : 1) * sizeof(int));
+    free(inner);
+    return lv->matrix == NULL ? -1 : 0;
+}
+
+// topology only: the partition and the cells' entries and exits; distances come with overlay_customize
+Overlay *overlay_build(const FrozenGraph *fg, int cliqueFactor) {
+    if (fg == NULL || cliqueFactor < 0) return NULL;
+    
+    int n = fg->cityCount;
+    int m = fg->edgeCount;
+    Overlay *ov = calloc(1, sizeof(Overlay));
+    if (ov == NULL) return NULL;
+    ov->cityCount = n;
+    ov->edgeCount = m;
+    ov->levelCount = OVERLAY_LEVELS;
+    ov->cliqueFactor = cliqueFactor;
+    ov->ids = malloc((n > 0 ? n : 1) * sizeof(int));
+    ov->order = malloc((n > 0 ? n : 1) * sizeof(int));
+    ov->pos = malloc((n > 0 ? n : 1) * sizeof(int));
+    ov->offsets = malloc((n + 1) * sizeof(int));
+    ov->heads = malloc((m > 0 ? m : 1) * sizeof(int));
+    ov->weights = malloc((m > 0 ? m : 1) * sizeof(int));
+    
+    Partitioner p;
+    p.fg = fg;
+    p.ov = ov;
+    p.items = malloc((n > 0 ? n : 1) * sizeof(BisectItem));
+    char *isEntry = malloc(n > 0 ? n : 1);
+    char *isExit = malloc(n > 0 ? n : 1);
+    
+    int failed = ov->ids == NULL || ov->order == NULL || ov->pos == NULL || ov->offsets == NULL ||
+                 ov->heads == NULL || ov->weights == NULL || p.items == NULL || isEntry == NULL || isExit == NULL;
+    for (int l = 0; l < OVERLAY_LEVELS && !failed; ++l) {
+        OverlayLevel *lv = &ov->levels[l];
+        lv->cell = malloc((n > 0 ? n : 1) * sizeof(int));
+        lv->cellStart = malloc((n + 1) * sizeof(int));
+        failed = lv->cell == NULL || lv->cellStart == NULL;
+        p.cellSize[l] = l == 0 ? OVERLAY_BASE_CELL : p.cellSize[l - 1] * OVERLAY_FANOUT;
+    }
+    
+    if (!failed) {
+        memcpy(ov->ids, fg->ids, n * sizeof(int));
+        memcpy(ov->offsets, fg->offsets, (n + 1) * sizeof(int));
+        for (int e = 0; e < m; ++e) {
+            ov->heads[e] = fg->edges[e].dest;
+            ov->weights[e] = MAX_DISTANCE;
+        }
+        for (int v = 0; v < n; ++v) {
+            p.items[v].city = v;
+        }
+        if (n > 0) bisect(&p, 0, n, OVERLAY_LEVELS);
+        for (int i = 0; i < n; ++i) {
+            ov->order[i] = p.items[i].city;
+            ov->pos[p.items[i].city] = i;
+        }
+        for (int l = 0; l < OVERLAY_LEVELS && !failed; ++l) {
+            ov->levels[l].cellStart[ov->levels[l].cellCount] = n;
+            failed = build_boundary(ov, &ov->levels[l], isEntry, isExit) != 0;
+        }
+    }
+    
+    free(p.items);
+    free(isEntry);
+    free(isExit);
+    if (failed) {
+        overlay_free(ov);
+        return NULL;
+    }
+    id_index_build(&ov->index, ov->ids, n);
+    return ov;
+}
+
+void overlay_free(Overlay *ov) {
+    if (ov == NULL) return;
+    
+    for (int l = 0; l < OVERLAY_LEVELS; ++l) {
+        OverlayLevel *lv = &ov->levels[l];
+        free(lv->cell);
+        free(lv->cellStart);
+        free(lv->closed);
+        free(lv->entryStart);
+        free(lv->entries);
+        free(lv->exitStart);
+        free(lv->exits);
+        free(lv->entryPos);
+        free(lv->matrixStart);
+        free(lv->matrix);
+    }
+    free(ov->ids);
+    free(ov->order);
+    free(ov->pos);
+    free(ov->offsets);
+    free(ov->heads);
+    free(ov->weights);
+    id_index_free(&ov->index);
+    free(ov);
+}
+
+// entry-to-exit distances stored over all levels
+long long overlay_matrix_entries(const Overlay *ov) {
+    if (ov == NULL) return 0;
+    
+    long long total = 0;
+    for (int l = 0; l < ov->levelCount; ++l) {
+        total += ov->levels[l].matrixStart[ov->levels[l].cellCount];
+    }
+    return total;
+}
+
+// Highest level up to `level` whose cell around u is closed, 0 when none is:
+// u then leaves that cell through its distances and the routes out of it, or
+// with 0 through all of its own routes. Every city of that cell gets the same
+// answer, since they share their cells on all levels above it.
+static int cross_level(const Overlay *ov, int u, int level) {
+    for (int l = level; l > 0; --l) {
+        const OverlayLevel *lv = &ov->levels[l - 1];
+        if (lv->closed[lv->cell[u]]) return l;
+    }
+    return 0;
+}
+
+static void cell_relax(CellSearch *cs, int local, int dist) {
+    if (cs->stamp[local] == cs->generation && cs->dist[local] <= dist) return;
+    cs->stamp[local] = cs->generation;
+    cs->dist[local] = dist;
+    heap_push_or_decrease(&cs->heap, local, dist);
+}
+
+// One Dijkstra search per entry of cell c, over the real routes inside the
+// cell on the bottom level, and above that over the cell's sub-cells: the
+// distances of the closed ones and the routes between them.
+static void customize_cell(Overlay *ov, int level, int c, CellSearch *cs) {
+    OverlayLevel *lv = &ov->levels[level];
+    int base = lv->cellStart[c];
+    int exitCount = lv->exitStart[c + 1] - lv->exitStart[c];
+    const int *exits = lv->exits + lv->exitStart[c];
+    int *row = lv->matrix + lv->matrixStart[c];
+    
+    for (int p = lv->entryStart[c]; p < lv->entryStart[c + 1]; ++p, row += exitCount) {
+        if (++cs->generation == 0) {
+            memset(cs->stamp, 0, cs->capacity * sizeof(unsigned int));
+            cs->generation = 1;
+        }
+        cell_relax(cs, ov->pos[lv->entries[p]] - base, 0);
+        
+        while (!heap_empty(&cs->heap)) {
+            int du;
+            int u = ov->order[base + heap_pop_min(&cs->heap, &du)];
+            int sub = cross_level(ov, u, level);
+            if (sub == 0) {
+                for (int e = ov->offsets[u]; e < ov->offsets[u + 1]; ++e) {
+                    int v = ov->heads[e];
+                    if (lv->cell[v] == c) cell_relax(cs, ov->pos[v] - base, du + ov->weights[e]);
+                }
+                continue;
+            }
+            
+            const OverlayLevel *lower = &ov->levels[sub - 1];
+            int cu = lower->cell[u];
+            if (lower->entryPos[u] >= 0) {
+                int lowerExits = lower->exitStart[cu + 1] - lower->exitStart[cu];
+                const int *through = lower->matrix + lower->matrixStart[cu] + (long long)lower->entryPos[u] * lowerExits;
+                const int *to = lower->exits + lower->exitStart[cu];
+                for (int j = 0; j < lowerExits; ++j) {
+                    if (through[j] != MAX_DISTANCE) cell_relax(cs, ov->pos[to[j]] - base, du + through[j]);
+                }
+            }
+            for (int e = ov->offsets[u]; e < ov->offsets[u + 1]; ++e) {
+                int v = ov->heads[e];
+                if (lower->cell[v] != cu && lv->cell[v] == c) cell_relax(cs, ov->pos[v] - base, du + ov->weights[e]);
+            }
+        }
+        
+        for (int j = 0; j < exitCount; ++j) {
+            int local = ov->pos[exits[j]] - base;
+            row[j] = cs->stamp[local] == cs->generation ? cs->dist[local] : MAX_DISTANCE;
+        }
+    }
+}
+
+static void customize_worker(void *arg, int worker) {
+    CustomizeJob *job = arg;
+    (void)worker;
+    
+    CellSearch cs;
+    cs.dist = malloc(job->maxCell * sizeof(int));
+    cs.stamp = calloc(job->maxCell, sizeof(unsigned int));
+    cs.generation = 0;
+    cs.capacity = job->maxCell;
+    if (cs.dist == NULL || cs.stamp == NULL || heap_init(&cs.heap, job->maxCell) != 0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    int cellCount = job->ov->levels[job->level].cellCount;
+    int c;
+    while ((c = atomic_fetch_add_explicit(&job->nextCell, 1, memory_order_relaxed)) < cellCount) {
+        if (job->ov->levels[job->level].closed[c]) customize_cell(job->ov, job->level, c, &cs);
+    }
+    
+    free(cs.dist);
+    free(cs.stamp);
+    heap_free(&cs.heap);
+}
+
+// Takes the route distances of fg, which must have the topology the overlay
+// was built from, and recomputes every cell's distances. Returns -1 when the
+// routes differ. threads 0 uses every core.
+int overlay_customize(Overlay *ov, const FrozenGraph *fg, int threads) {
+    if (ov == NULL || fg == NULL) return -1;
+    
+    ov->customized = 0;
+    if (fg->cityCount != ov->cityCount || fg->edgeCount != ov->edgeCount) return -1;
+    if (memcmp(fg->offsets, ov->offsets, (ov->cityCount + 1) * sizeof(int)) != 0) return -1;
+    for (int e = 0; e < ov->edgeCount; ++e) {
+        if (fg->edges[e].dest != ov->heads[e]) return -1;
+        ov->weights[e] = fg->edges[e].distance;
+    }
+    if (threads <= 0) threads = cpu_count();
+    
+    for (int l = 0; l < ov->levelCount; ++l) {
+        OverlayLevel *lv = &ov->levels[l];
+        CustomizeJob job;
+        job.ov = ov;
+        job.level = l;
+        job.maxCell = 1;
+        for (int c = 0; c < lv->cellCount; ++c) {
+            if (lv->cellStart[c + 1] - lv->cellStart[c] > job.maxCell) job.maxCell = lv->cellStart[c + 1] - lv->cellStart[c];
+        }
+        atomic_init(&job.nextCell, 0);
+        run_workers(threads < lv->cellCount ? threads : lv->cellCount, customize_worker, &job);
+    }
+    ov->customized = 1;
+    return 0;
+}
+
+// highest level whose cell around u holds neither end of the query, 0 when every level does
+static int query_level(const Overlay *ov, int u, int s, int t) {
+    for (int l = ov->levelCount - 1; l >= 0; --l) {
+        const int *cell = ov->levels[l].cell;
+        if (cell[u] != cell[s] && cell[u] != cell[t]) return l + 1;
+    }
+    return 0;
+}
+
+static void overlay_relax(QueryContext *qc, SearchSide *fw, int v, int dist, int from) {
+    if (side_is_settled(qc, fw, v) || dist >= side_dist(qc, fw, v)) return;
+    side_set(qc, fw, v, dist, from);
+    heap_push_or_decrease(&fw->heap, v, dist);
+}
+
+static int is_route(const Overlay *ov, int u, int v, int distance) {
+    for (int e = ov->offsets[u]; e < ov->offsets[u + 1]; ++e) {
+        if (ov->heads[e] == v && ov->weights[e] == distance) return 1;
+    }
+    return 0;
+}
+
+// Appends the cities strictly between u and v, from v's side, for a hop that
+// crossed u's cell on the given level. A Dijkstra search over the real routes
+// inside the cell finds them; it runs on the backward side, whose stamps are
+// cleared again afterwards so the next hop starts clean.
+static int unpack_hop(const Overlay *ov, QueryContext *qc, int level, int u, int v, int *path, int *len) {
+    if (level == 0) return -1;
+    
+    SearchSide *bw = &qc->backward;
+    const int *cell = ov->levels[level - 1].cell;
+    int c = cell[u];
+    int touched = 0;
+    int found = 0;
+    
+    side_set(qc, bw, u, 0, -1);
+    qc->queue[touched++] = u;
+    heap_push_or_decrease(&bw->heap, u, 0);
+    while (!heap_empty(&bw->heap)) {
+        int dx;
+        int x = heap_pop_min(&bw->heap, &dx);
+        if (x == v) {
+            found = 1;
+            break;
+        }
+        for (int e = ov->offsets[x]; e < ov->offsets[x + 1]; ++e) {
+            int y = ov->heads[e];
+            if (cell[y] != c || dx + ov->weights[e] >= side_dist(qc, bw, y)) continue;
+            if (bw->stamp[y] != qc->generation) qc->queue[touched++] = y;
+            side_set(qc, bw, y, dx + ov->weights[e], x);
+            heap_push_or_decrease(&bw->heap, y, dx + ov->weights[e]);
+        }
+    }
+    heap_clear(&bw->heap);
+    
+    for (int x = found ? bw->link[v] : u; x != u; x = bw->link[x]) {
+        path[(*len)++] = ov->ids[x];
+    }
+    for (int i = 0; i < touched; ++i) {
+        bw->stamp[qc->queue[i]] = qc->generation - 1;
+    }
+    return found ? 0 : -1;
+}
+
+int overlay_shortest_path_ctx(const Overlay *ov, QueryContext *qc, int source, int dest,
+                              int *path, int *pathLength, int *settled) {
+    if (ov == NULL || qc == NULL || path == NULL || pathLength == NULL || !ov->customized) return -1;
+    
+    int s = id_index_find(&ov->index, source);
+    int t = id_index_find(&ov->index, dest);
+    if (s == -1 || t == -1) return -1;
+    if (query_context_fit(qc, ov->cityCount, ov->edgeCount) != 0) return -1;
+    
+    query_begin(qc);
+    SearchSide *fw = &qc->forward;
+    side_set(qc, fw, s, 0, -1);
+    heap_push_or_decrease(&fw->heap, s, 0);
+    int settledCount = 0;
+    
+    while (!heap_empty(&fw->heap)) {
+        int du;
+        int u = heap_pop_min(&fw->heap, &du);
+        side_settle(qc, fw, u);
+        settledCount++;
+        if (u == t) break;
+        
+        int level = cross_level(ov, u, query_level(ov, u, s, t));
+        if (level == 0) {
+            for (int e = ov->offsets[u]; e < ov->offsets[u + 1]; ++e) {
+                overlay_relax(qc, fw, ov->heads[e], du + ov->weights[e], u);
+            }
+            continue;
+        }
+        
+        // u lies in a cell away from both ends: cross it, or leave it by a real route
+        const OverlayLevel *lv = &ov->levels[level - 1];
+        int cu = lv->cell[u];
+        if (lv->entryPos[u] >= 0) {
+            int exitCount = lv->exitStart[cu + 1] - lv->exitStart[cu];
+            const int *through = lv->matrix + lv->matrixStart[cu] + (long long)lv->entryPos[u] * exitCount;
+            const int *to = lv->exits + lv->exitStart[cu];
+            for (int j = 0; j < exitCount; ++j) {
+                if (through[j] != MAX_DISTANCE) overlay_relax(qc, fw, to[j], du + through[j], u);
+            }
+        }
+        for (int e = ov->offsets[u]; e < ov->offsets[u + 1]; ++e) {
+            if (lv->cell[ov->heads[e]] != cu) overlay_relax(qc, fw, ov->heads[e], du + ov->weights[e], u);
+        }
+    }
+    if (settled != NULL) *settled = settledCount;
+    
+    int dist = side_dist(qc, fw, t);
+    if (dist == MAX_DISTANCE) return -1;
+    
+    // walk back from t, expanding each hop that crossed a cell into its real routes
+    int len = 0;
+    path[len++] = ov->ids[t];
+    for (int cur = t; fw->link[cur] != -1; cur = fw->link[cur]) {
+        int u = fw->link[cur];
+        if (!is_route(ov, u, cur, fw->dist[cur] - fw->dist[u]) &&
+            unpack_hop(ov, qc, cross_level(ov, u, query_level(ov, u, s, t)), u, cur, path, &len) != 0) return -1;
+        path[len++] = ov->ids[u];
+    }
+    for (int i = 0; i < len / 2; ++i) {
+        int tmp = path[i];
+        path[i] = path[len - 1 - i];
+        path[len - 1 - i] = tmp;
+    }
+    *pathLength = len;
+    return dist;
+}
+
+int overlay_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength, int *settled) {
+    if (g == NULL) return -1;
+    
+    const Overlay *ov = graph_overlay(g);
+    QueryContext *qc = graph_query_context(g);
+    if (ov == NULL || qc == NULL) return -1;
+    return overlay_shortest_path_ctx(ov, qc, source, dest, path, pathLength, settled);
+}
\ No newline at end of file
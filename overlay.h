@@ -0,0 +1,71 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include "graph.h"
+#include "query.h"
+
+// Multi-level overlay in the style of Customizable Route Planning. The
+// topology is preprocessed once: cities are split by recursive coordinate
+// bisection into nested cells (OVERLAY_BASE_CELL cities at most on the bottom
+// level, OVERLAY_FANOUT times more per level up), and each cell lists its
+// entry cities (routes in from other cells) and exit cities (routes out).
+// Customization then fills, for every cell, the shortest distance inside the
+// cell from each entry to each exit, bottom level first and the cells of a
+// level in parallel; it only reads route distances, so it is all that has to
+// run again when distances change. A query searches real routes only near its
+// two ends and crosses every other cell through the entry-to-exit distances
+// of the highest level that separates it from both.
+//
+// A cell whose entries times exits would exceed cliqueFactor times its inner
+// routes stays open: it gets no distances, and searches cross it through the
+// cells below it or route by route. Networks of short hops, where a line
+// across the map cuts few routes, close nearly every cell. Networks without
+// small separators, such as hub-and-spoke ones where most cities have a route
+// far away, leave most cells open and the overlay degrades to plain Dijkstra.
+
+#define OVERLAY_LEVELS 3
+#define OVERLAY_BASE_CELL 64
+#define OVERLAY_FANOUT 16
+#define OVERLAY_CLIQUE_FACTOR 4  // default cliqueFactor
+#define OVERLAY_ALL_CLOSED 0     // cliqueFactor that closes every cell, whatever its boundary
+
+typedef struct {
+    int cellCount;
+    int *cell;                // dense index -> cell on this level
+    int *cellStart;           // cell c holds order[cellStart[c] .. cellStart[c + 1])
+    char *closed;             // cell c is crossed through its distances; open cells have none
+    int *entryStart;          // entries of cell c: entries[entryStart[c] .. entryStart[c + 1])
+    int *entries;
+    int *exitStart;
+    int *exits;
+    int *entryPos;            // dense index -> position among its cell's entries, -1 if not an entry
+    long long *matrixStart;   // cell c: one row of exit distances per entry from matrix[matrixStart[c]]
+    int *matrix;              // MAX_DISTANCE when the exit cannot be reached inside the cell
+} OverlayLevel;
+
+struct Overlay {
+    int cityCount;
+    int edgeCount;
+    int *ids;              // dense index -> city id
+    IdIndex index;         // city id -> dense index
+    int *order;            // cities by cell, each cell on every level a contiguous range
+    int *pos;              // dense index -> position in order
+    int *offsets;          // routes as in the frozen graph the overlay was built from
+    int *heads;
+    int *weights;          // route distances of the last customization
+    int levelCount;
+    int cliqueFactor;      // cells close when entries times exits is at most this times their inner routes
+    OverlayLevel levels[OVERLAY_LEVELS];
+    int customized;
+    unsigned int version;  // graph version of the last customization, kept by the graph
+};
+
+Overlay *overlay_build(const FrozenGraph *fg, int cliqueFactor);
+int overlay_customize(Overlay *ov, const FrozenGraph *fg, int threads);
+void overlay_free(Overlay *ov);
+long long overlay_matrix_entries(const Overlay *ov);
+int overlay_shortest_path(Graph *g, int source, int dest, int *path, int *pathLength, int *settled);
+int overlay_shortest_path_ctx(const Overlay *ov, QueryContext *qc, int source, int dest,
+                              int *path, int *pathLength, int *settled);
+
+#endif
\ No newline at end of file
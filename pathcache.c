@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pathcache.h"
+
+static unsigned int hash_pair(int source, int dest) {
+    unsigned int h = (unsigned int)source * 2654435761u;
+    h ^= (unsigned int)dest + 0x9e3779b9u + (h << 6) + (h >> 2);
+    return h * 2654435761u;
+}
+
+PathCache *path_cache_create(int capacity) {
+    if (capacity <= 0) return NULL;
+    
+    int slotCount = 8;
+    while (slotCount < capacity * 2) slotCount *= 2;
+    
+    PathCache *pc = calloc(1, sizeof(PathCache));
+    if (pc == NULL) return NULL;
+    
+    pc->entries = calloc(capacity, sizeof(CachedPath));
+    pc->slots = malloc(slotCount * sizeof(int));
+    if (pc->entries == NULL || pc->slots == NULL) {
+        path_cache_free(pc);
+        return NULL;
+    }
+    
+    pc->capacity = capacity;
+    pc->mask = slotCount - 1;
+    for (int i = 0; i < slotCount; ++i) {
+        pc->slots[i] = -1;
+    }
+    return pc;
+}
+
+void path_cache_free(PathCache *pc) {
+    if (pc == NULL) return;
+    
+    if (pc->entries != NULL) {
+        for (int i = 0; i < pc->capacity; ++i) {
+            free(pc->entries[i].path);
+        }
+    }
+    free(pc->entries);
+    free(pc->slots);
+    free(pc);
+}
+
+// slot holding the entry for (source, dest), or the empty slot where it would go
+static int find_slot(const PathCache *pc, int source, int dest) {
+    unsigned int slot = hash_pair(source, dest) & pc->mask;
+    while (pc->slots[slot] != -1) {
+        const CachedPath *e = &pc->entries[pc->slots[slot]];
+        if (e->source == source && e->dest == dest) break;
+        slot = (slot + 1) & pc->mask;
+    }
+    return (int)slot;
+}
+
+// backward-shift deletion keeps every probe sequence unbroken without tombstones
+static void unlink_entry(PathCache *pc, int entry) {
+    CachedPath *e = &pc->entries[entry];
+    unsigned int hole = (unsigned int)find_slot(pc, e->source, e->dest);
+    pc->slots[hole] = -1;
+    
+    unsigned int next = (hole + 1) & pc->mask;
+    while (pc->slots[next] != -1) {
+        const CachedPath *moved = &pc->entries[pc->slots[next]];
+        unsigned int home = hash_pair(moved->source, moved->dest) & pc->mask;
+        // move it back if its home is not in (hole, next]
+        if (((next - home) & pc->mask) >= ((next - hole) & pc->mask)) {
+            pc->slots[hole] = pc->slots[next];
+            pc->slots[next] = -1;
+            hole = next;
+        }
+        next = (next + 1) & pc->mask;
+    }
+    
+    e->inUse = 0;
+    pc->used--;
+}
+
+int path_cache_lookup(PathCache *pc, unsigned int version, int source, int dest, int *distance, int *path, int *pathLength) {
+    if (pc == NULL) return 0;
+    
+    int slot = find_slot(pc, source, dest);
+    if (pc->slots[slot] == -1 || pc->entries[pc->slots[slot]].version != version) {
+        pc->misses++;
+        return 0;
+    }
+    
+    CachedPath *e = &pc->entries[pc->slots[slot]];
+    e->referenced = 1;
+    *distance = e->distance;
+    if (e->distance >= 0) {
+        memcpy(path, e->path, e->length * sizeof(int));
+        *pathLength = e->length;
+    }
+    pc->hits++;
+    return 1;
+}
+
+static int pick_victim(PathCache *pc, unsigned int version) {
+    if (pc->used < pc->capacity) {
+        for (int i = 0; i < pc->capacity; ++i) {
+            int at = (pc->hand + i) % pc->capacity;
+            if (!pc->entries[at].inUse) return at;
+        }
+    }
+    
+    while (1) {
+        int at = pc->hand;
+        CachedPath *e = &pc->entries[at];
+        pc->hand = (pc->hand + 1) % pc->capacity;
+        if (e->version != version || !e->referenced) {
+            unlink_entry(pc, at);
+            pc->evictions++;
+            return at;
+        }
+        e->referenced = 0;
+    }
+}
+
+void path_cache_store(PathCache *pc, unsigned int version, int source, int dest, int distance, const int *path, int pathLength) {
+    if (pc == NULL) return;
+    if (distance < 0) pathLength = 0;
+    
+    int slot = find_slot(pc, source, dest);
+    int entry = pc->slots[slot];
+    if (entry == -1) {
+        entry = pick_victim(pc, version);
+        slot = find_slot(pc, source, dest); // the eviction may have shifted slots
+        pc->slots[slot] = entry;
+        pc->used++;
+    }
+    
+    CachedPath *e = &pc->entries[entry];
+    if (e->pathCap < pathLength) {
+        int *grown = realloc(e->path, pathLength * sizeof(int));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        e->path = grown;
+        e->pathCap = pathLength;
+    }
+    
+    e->inUse = 1;
+    e->source = source;
+    e->dest = dest;
+    e->version = version;
+    e->distance = distance;
+    e->length = pathLength;
+    e->referenced = 0;
+    if (pathLength > 0) memcpy(e->path, path, pathLength * sizeof(int));
+}
+
+// Removing a route never shortens anything, so entries current at oldVersion
+// stay exact unless their path used the route. Those are dropped and the
+// rest are carried forward to newVersion. Cached "no path" results stay valid.
+void path_cache_route_removed(PathCache *pc, unsigned int oldVersion, unsigned int newVersion, int from, int to) {
+    if (pc == NULL) return;
+    
+    for (int i = 0; i < pc->capacity; ++i) {
+        CachedPath *e = &pc->entries[i];
+        if (!e->inUse || e->version != oldVersion) continue;
+        
+        int usesRoute = 0;
+        for (int k = 0; k + 1 < e->length; ++k) {
+            if (e->path[k] == from && e->path[k + 1] == to) {
+                usesRoute = 1;
+                break;
+            }
+        }
+        
+        if (usesRoute) {
+            unlink_entry(pc, i);
+            pc->invalidations++;
+        } else {
+            e->version = newVersion;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+// Bounded cache of shortest path results keyed on (source, dest) city ids.
+// Every entry records the graph version it was computed at and only hits
+// while that is still the current version. Replacement is CLOCK: a hit sets
+// the entry's reference bit, the hand clears bits until it finds an entry
+// that is unreferenced or stale.
+
+#define PATH_CACHE_DEFAULT_CAPACITY 1024
+
+typedef struct {
+    int inUse;      // any int is a valid city id, so free entries are flagged instead
+    int source;
+    int dest;
+    unsigned int version;
+    int distance;   // -1 when no path exists
+    int length;
+    int pathCap;
+    int *path;
+    int referenced;
+} CachedPath;
+
+typedef struct PathCache {
+    CachedPath *entries;
+    int capacity;
+    int used;
+    int hand;
+    int *slots;     // open addressing over entries, -1 = empty
+    int mask;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long invalidations; // entries dropped because a removed route was on their path
+} PathCache;
+
+PathCache *path_cache_create(int capacity);
+void path_cache_free(PathCache *pc);
+int path_cache_lookup(PathCache *pc, unsigned int version, int source, int dest, int *distance, int *path, int *pathLength);
+void path_cache_store(PathCache *pc, unsigned int version, int source, int dest, int distance, const int *path, int pathLength);
+void path_cache_route_removed(PathCache *pc, unsigned int oldVersion, unsigned int newVersion, int from, int to);
+
+#endif
\ No newline at end of file
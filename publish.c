@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "publish.h"
+
+// Readers announce the global epoch before loading the current pointer, and
+// the writer advances the epoch only after swapping the pointer in. A reader
+// that could still see a retired version therefore announced an epoch no
+// later than the one recorded at retirement, so a version retired at epoch r
+// is safe to free once every active reader has announced an epoch above r.
+// All of this relies on the default sequentially consistent atomics.
+
+int publisher_init(GraphPublisher *p) {
+    if (p == NULL) return -1;
+    
+    atomic_init(&p->current, NULL);
+    atomic_init(&p->epoch, 1);
+    for (int i = 0; i < PUBLISH_MAX_READERS; ++i) {
+        atomic_init(&p->readers[i].epoch, 0);
+        atomic_init(&p->readers[i].inUse, 0);
+    }
+    if (pthread_mutex_init(&p->writer, NULL) != 0) return -1;
+    p->retired = NULL;
+    p->retiredCount = 0;
+    p->retiredCap = 0;
+    p->published = 0;
+    p->reclaimed = 0;
+    return 0;
+}
+
+static void free_published(PublishedGraph *pg) {
+    if (pg == NULL) return;
+    free_frozen_graph(pg->graph);
+    free(pg);
+}
+
+// only safe once no reader is inside a read section
+void publisher_destroy(GraphPublisher *p) {
+    if (p == NULL) return;
+    
+    free_published(atomic_exchange(&p->current, NULL));
+    for (int i = 0; i < p->retiredCount; ++i) {
+        free_published(p->retired[i].item);
+    }
+    free(p->retired);
+    p->retired = NULL;
+    p->retiredCount = 0;
+    p->retiredCap = 0;
+    pthread_mutex_destroy(&p->writer);
+}
+
+// claims a reader slot, -1 when all PUBLISH_MAX_READERS are taken
+int publisher_register(GraphPublisher *p) {
+    if (p == NULL) return -1;
+    
+    for (int i = 0; i < PUBLISH_MAX_READERS; ++i) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&p->readers[i].inUse, &expected, 1)) {
+            atomic_store(&p->readers[i].epoch, 0);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void publisher_unregister(GraphPublisher *p, int slot) {
+    if (p == NULL || slot < 0 || slot >= PUBLISH_MAX_READERS) return;
+    
+    atomic_store(&p->readers[slot].epoch, 0);
+    atomic_store(&p->readers[slot].inUse, 0);
+}
+
+// the returned version stays valid until publisher_exit on the same slot
+const PublishedGraph *publisher_enter(GraphPublisher *p, int slot) {
+    if (p == NULL || slot < 0 || slot >= PUBLISH_MAX_READERS) return NULL;
+    
+    atomic_store(&p->readers[slot].epoch, atomic_load(&p->epoch));
+    return atomic_load(&p->current);
+}
+
+void publisher_exit(GraphPublisher *p, int slot) {
+    if (p == NULL || slot < 0 || slot >= PUBLISH_MAX_READERS) return;
+    
+    atomic_store_explicit(&p->readers[slot].epoch, 0, memory_order_release);
+}
+
+// frees retired versions no active reader can hold; caller owns p->writer
+static int reclaim_locked(GraphPublisher *p) {
+    unsigned long oldest = 0; // smallest announced epoch, 0 when no reader is inside
+    for (int i = 0; i < PUBLISH_MAX_READERS; ++i) {
+        if (!atomic_load(&p->readers[i].inUse)) continue;
+        unsigned long e = atomic_load(&p->readers[i].epoch);
+        if (e != 0 && (oldest == 0 || e < oldest)) oldest = e;
+    }
+    
+    int freed = 0;
+    int kept = 0;
+    for (int i = 0; i < p->retiredCount; ++i) {
+        if (oldest == 0 || p->retired[i].epoch < oldest) {
+            free_published(p->retired[i].item);
+            freed++;
+        } else {
+            p->retired[kept++] = p->retired[i];
+        }
+    }
+    p->retiredCount = kept;
+    p->reclaimed += freed;
+    return freed;
+}
+
+// takes ownership of graph and makes it the version new readers see
+int publisher_publish(GraphPublisher *p, FrozenGraph *graph, unsigned int version) {
+    if (p == NULL || graph == NULL) return -1;
+    
+    PublishedGraph *next = malloc(sizeof(PublishedGraph));
+    if (next == NULL) return -1;
+    next->graph = graph;
+    next->version = version;
+    
+    pthread_mutex_lock(&p->writer);
+    if (p->retiredCount == p->retiredCap) {
+        int cap = p->retiredCap == 0 ? 8 : p->retiredCap * 2;
+        RetiredGraph *grown = realloc(p->retired, cap * sizeof(RetiredGraph));
+        if (grown == NULL) {
+            pthread_mutex_unlock(&p->writer);
+            free(next);
+            return -1;
+        }
+        p->retired = grown;
+        p->retiredCap = cap;
+    }
+    
+    PublishedGraph *old = atomic_exchange(&p->current, next);
+    unsigned long retiredAt = atomic_fetch_add(&p->epoch, 1);
+    if (old != NULL) {
+        p->retired[p->retiredCount].item = old;
+        p->retired[p->retiredCount].epoch = retiredAt;
+        p->retiredCount++;
+    }
+    p->published++;
+    reclaim_locked(p);
+    pthread_mutex_unlock(&p->writer);
+    return 0;
+}
+
+// freezes the writer's graph as it is now and publishes that copy
+int publisher_publish_graph(GraphPublisher *p, const Graph *g) {
+    if (p == NULL || g == NULL) return -1;
+    
+    FrozenGraph *fg = graph_freeze(g);
+    if (fg == NULL) return -1;
+    if (publisher_publish(p, fg, g->version) != 0) {
+        free_frozen_graph(fg);
+        return -1;
+    }
+    return 0;
+}
+
+// number of retired versions freed; publishing also reclaims
+int publisher_reclaim(GraphPublisher *p) {
+    if (p == NULL) return -1;
+    
+    pthread_mutex_lock(&p->writer);
+    int freed = reclaim_locked(p);
+    pthread_mutex_unlock(&p->writer);
+    return freed;
+}
\ No newline at end of file
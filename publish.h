@@ -0,0 +1,62 @@
+#ifndef PUBLISH_H
+#define PUBLISH_H
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include "graph.h"
+
+// Lock-free publication of immutable graph versions. The writer keeps
+// editing its Graph and publishes a fresh FrozenGraph with one atomic pointer
+// swap; query threads read whichever version was current when they entered
+// and never block on the writer. A replaced version is retired and freed once
+// every reader that could still hold it has left (epoch-based reclamation).
+//
+// Reader protocol, per query or per batch of queries:
+//     const PublishedGraph *pg = publisher_enter(p, slot);
+//     ... read pg->graph ...
+//     publisher_exit(p, slot);
+// Each reader thread registers once for its own slot.
+
+#define PUBLISH_MAX_READERS 64
+
+typedef struct {
+    FrozenGraph *graph;
+    unsigned int version; // Graph.version it was frozen at
+} PublishedGraph;
+
+typedef struct {
+    atomic_ulong epoch;   // 0 while outside a read section
+    atomic_int inUse;
+    char pad[64 - sizeof(atomic_ulong) - sizeof(atomic_int)]; // one slot per cache line
+} ReaderSlot;
+
+typedef struct {
+    PublishedGraph *item;
+    unsigned long epoch; // global epoch when it was replaced
+} RetiredGraph;
+
+typedef struct {
+    _Atomic(PublishedGraph *) current;
+    atomic_ulong epoch;  // starts at 1, advanced by every publication
+    ReaderSlot readers[PUBLISH_MAX_READERS];
+    pthread_mutex_t writer; // serializes publishers; readers never take it
+    RetiredGraph *retired;
+    int retiredCount;
+    int retiredCap;
+    unsigned long published;
+    unsigned long reclaimed;
+} GraphPublisher;
+
+int publisher_init(GraphPublisher *p);
+void publisher_destroy(GraphPublisher *p);
+
+int publisher_register(GraphPublisher *p);
+void publisher_unregister(GraphPublisher *p, int slot);
+const PublishedGraph *publisher_enter(GraphPublisher *p, int slot);
+void publisher_exit(GraphPublisher *p, int slot);
+
+int publisher_publish(GraphPublisher *p, FrozenGraph *graph, unsigned int version);
+int publisher_publish_graph(GraphPublisher *p, const Graph *g);
+int publisher_reclaim(GraphPublisher *p);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "heap.h"
+#include "query.h"
+#include "stats.h"
+
+static void side_release(SearchSide *s) {
+    free(s->stamp);
+    free(s->settled);
+    free(s->dist);
+    free(s->link);
+    free(s->aux);
+    heap_free(&s->heap);
+    memset(s, 0, sizeof(SearchSide));
+}
+
+static int side_alloc(SearchSide *s, int n) {
+    s->stamp = calloc(n, sizeof(unsigned int));
+    s->settled = calloc(n, sizeof(unsigned int));
+    s->dist = malloc(n * sizeof(int));
+    s->link = malloc(n * sizeof(int));
+    s->aux = malloc(n * sizeof(int));
+    if (s->stamp == NULL || s->settled == NULL || s->dist == NULL ||
+        s->link == NULL || s->aux == NULL || heap_init(&s->heap, n) != 0) {
+        free(s->stamp);
+        free(s->settled);
+        free(s->dist);
+        free(s->link);
+        free(s->aux);
+        memset(s, 0, sizeof(SearchSide));
+        return -1;
+    }
+    STATS_ADD(allocBytes, (size_t)n * (2 * sizeof(unsigned int) + 4 * sizeof(int) + sizeof(HeapEntry)));
+    return 0;
+}
+
+static void context_release(QueryContext *qc) {
+    side_release(&qc->forward);
+    side_release(&qc->backward);
+    free(qc->queue);
+    free(qc->path);
+    free(qc->potentialStamp);
+    free(qc->potential);
+    free(qc->nodeBlocked);
+    free(qc->edgeBlocked);
+    qc->queue = NULL;
+    qc->path = NULL;
+    qc->potentialStamp = NULL;
+    qc->potential = NULL;
+    qc->nodeBlocked = NULL;
+    qc->edgeBlocked = NULL;
+    qc->capacity = 0;
+    qc->edgeCapacity = 0;
+}
+
+QueryContext *query_context_create(int cityCount, int edgeCount) {
+    QueryContext *qc = calloc(1, sizeof(QueryContext));
+    if (qc == NULL) return NULL;
+    
+    if (query_context_fit(qc, cityCount, edgeCount) != 0) {
+        free(qc);
+        return NULL;
+    }
+    return qc;
+}
+
+// grows the context to serve a graph of this size; never shrinks it
+int query_context_fit(QueryContext *qc, int cityCount, int edgeCount) {
+    if (qc == NULL) return -1;
+    if (cityCount <= qc->capacity && edgeCount <= qc->edgeCapacity) return 0;
+    
+    // grow geometrically so a graph that gains a city at a time is not refitted every query
+    int n = cityCount > qc->capacity ? cityCount : qc->capacity;
+    int m = edgeCount > qc->edgeCapacity ? edgeCount : qc->edgeCapacity;
+    if (cityCount > qc->capacity && qc->capacity > 0 && n < qc->capacity * 2) n = qc->capacity * 2;
+    if (edgeCount > qc->edgeCapacity && qc->edgeCapacity > 0 && m < qc->edgeCapacity * 2) m = qc->edgeCapacity * 2;
+    if (n < 1) n = 1;
+    if (m < 1) m = 1;
+    
+    context_release(qc);
+    if (side_alloc(&qc->forward, n) != 0 || side_alloc(&qc->backward, n) != 0) {
+        context_release(qc);
+        return -1;
+    }
+    qc->queue = malloc(n * sizeof(int));
+    qc->path = malloc(n * sizeof(int));
+    qc->potentialStamp = calloc(n, sizeof(unsigned int));
+    qc->potential = malloc(n * sizeof(int));
+    qc->nodeBlocked = calloc(n, sizeof(char));
+    qc->edgeBlocked = calloc(m, sizeof(char));
+    if (qc->queue == NULL || qc->path == NULL || qc->potentialStamp == NULL ||
+        qc->potential == NULL || qc->nodeBlocked == NULL || qc->edgeBlocked == NULL) {
+        context_release(qc);
+        return -1;
+    }
+    
+    STATS_ADD(allocBytes, (size_t)n * (3 * sizeof(int) + sizeof(unsigned int) + sizeof(char)) + m);
+    qc->capacity = n;
+    qc->edgeCapacity = m;
+    qc->generation = 0; // all stamps are zero again
+    return 0;
+}
+
+void query_context_free(QueryContext *qc) {
+    if (qc == NULL) return;
+    context_release(qc);
+    free(qc);
+}
+
+// Starts a new query. Only when the generation counter wraps do the stamp
+// arrays have to be cleared in full.
+void query_begin(QueryContext *qc) {
+    qc->generation++;
+    if (qc->generation == 0) {
+        size_t bytes = qc->capacity * sizeof(unsigned int);
+        memset(qc->forward.stamp, 0, bytes);
+        memset(qc->forward.settled, 0, bytes);
+        memset(qc->backward.stamp, 0, bytes);
+        memset(qc->backward.settled, 0, bytes);
+        memset(qc->potentialStamp, 0, bytes);
+        qc->generation = 1;
+    }
+    heap_clear(&qc->forward.heap);
+    heap_clear(&qc->backward.heap);
+}
\ No newline at end of file
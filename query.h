@@ -0,0 +1,59 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "graph.h"
+#include "heap.h"
+
+// Reusable per-thread workspace for the searches. Arrays are sized to the
+// graph once; each query starts a new generation instead of clearing them,
+// so a value only counts when its stamp matches the current generation and
+// a query only pays for the cities it touches. Create one context per
+// thread; a context must not be shared between concurrent queries.
+
+typedef struct {
+    unsigned int *stamp;   // stamp[v] == generation: dist, link and aux are set
+    unsigned int *settled; // settled[v] == generation: v is done in this query
+    int *dist;
+    int *link;             // previous city (forward side) or next city (backward side)
+    int *aux;              // per-search extra, e.g. the shortcut a CH edge stands for
+    IndexedHeap heap;
+} SearchSide;
+
+struct QueryContext {
+    int capacity;      // cities
+    int edgeCapacity;  // routes
+    unsigned int generation;
+    SearchSide forward;
+    SearchSide backward;
+    int *queue;        // BFS queue, path chains
+    int *path;         // scratch path of up to capacity city ids for callers
+    unsigned int *potentialStamp;
+    int *potential;    // A* potentials of the current query
+    char *nodeBlocked; // spur search bans, all zero between queries
+    char *edgeBlocked;
+};
+
+QueryContext *query_context_create(int cityCount, int edgeCount);
+int query_context_fit(QueryContext *qc, int cityCount, int edgeCount);
+void query_context_free(QueryContext *qc);
+void query_begin(QueryContext *qc);
+
+static inline int side_dist(const QueryContext *qc, const SearchSide *s, int v) {
+    return s->stamp[v] == qc->generation ? s->dist[v] : MAX_DISTANCE;
+}
+
+static inline void side_set(const QueryContext *qc, SearchSide *s, int v, int dist, int link) {
+    s->stamp[v] = qc->generation;
+    s->dist[v] = dist;
+    s->link[v] = link;
+}
+
+static inline int side_is_settled(const QueryContext *qc, const SearchSide *s, int v) {
+    return s->settled[v] == qc->generation;
+}
+
+static inline void side_settle(const QueryContext *qc, SearchSide *s, int v) {
+    s->settled[v] = qc->generation;
+}
+
+#endif
\ No newline at end of file
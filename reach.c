@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "reach.h"
+
+static int reach_bit(const ReachIndex *ri, int from, int to) {
+    const uint64_t *row = ri->closure + (size_t)from * ri->words;
+    return (row[to >> 6] >> (to & 63)) & 1;
+}
+
+static void reach_or_row(ReachIndex *ri, int into, int from) {
+    uint64_t *dst = ri->closure + (size_t)into * ri->words;
+    const uint64_t *src = ri->closure + (size_t)from * ri->words;
+    for (int w = 0; w < ri->words; ++w) {
+        dst[w] |= src[w];
+    }
+}
+
+// iterative Tarjan, returns the number of components
+static int tarjan(const FrozenGraph *fg, int *component) {
+    int n = fg->cityCount;
+    int *order = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *low = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *stack = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *callNode = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *callEdge = malloc((n > 0 ? n : 1) * sizeof(int));
+    
+    if (order == NULL || low == NULL || stack == NULL || callNode == NULL || callEdge == NULL) {
+        free(order);
+        free(low);
+        free(stack);
+        free(callNode);
+        free(callEdge);
+        return -1;
+    }
+    
+    for (int i = 0; i < n; ++i) {
+        order[i] = -1;
+        component[i] = -1; // -1 while the city is still on the Tarjan stack
+    }
+    
+    int counter = 0;
+    int stackTop = 0;
+    int components = 0;
+    for (int root = 0; root < n; ++root) {
+        if (order[root] != -1) continue;
+        
+        int depth = 0;
+        callNode[depth] = root;
+        callEdge[depth] = fg->offsets[root];
+        order[root] = low[root] = counter++;
+        stack[stackTop++] = root;
+        
+        while (depth >= 0) {
+            int v = callNode[depth];
+            if (callEdge[depth] < fg->offsets[v + 1]) {
+                int w = fg->edges[callEdge[depth]++].dest;
+                if (order[w] == -1) {
+                    depth++;
+                    callNode[depth] = w;
+                    callEdge[depth] = fg->offsets[w];
+                    order[w] = low[w] = counter++;
+                    stack[stackTop++] = w;
+                } else if (component[w] == -1 && order[w] < low[v]) {
+                    low[v] = order[w];
+                }
+                continue;
+            }
+            
+            if (low[v] == order[v]) {
+                int w;
+                do {
+                    w = stack[--stackTop];
+                    component[w] = components;
+                } while (w != v);
+                components++;
+            }
+            depth--;
+            if (depth >= 0 && low[v] < low[callNode[depth]]) {
+                low[callNode[depth]] = low[v];
+            }
+        }
+    }
+    
+    free(order);
+    free(low);
+    free(stack);
+    free(callNode);
+    free(callEdge);
+    return components;
+}
+
+// returns NULL when out of memory or when the network has more than
+// REACH_MAX_COMPONENTS components; callers then fall back to a search
+ReachIndex *reach_build(const FrozenGraph *fg) {
+    if (fg == NULL) return NULL;
+    
+    int n = fg->cityCount;
+    ReachIndex *ri = calloc(1, sizeof(ReachIndex));
+    if (ri == NULL) return NULL;
+    
+    ri->cityCount = n;
+    ri->component = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (ri->component == NULL) {
+        reach_free(ri);
+        return NULL;
+    }
+    
+    int c = tarjan(fg, ri->component);
+    if (c < 0 || c > REACH_MAX_COMPONENTS) {
+        reach_free(ri);
+        return NULL;
+    }
+    ri->componentCount = c;
+    ri->words = (c + 63) / 64;
+    ri->closure = calloc((c > 0 ? (size_t)c * ri->words : 1), sizeof(uint64_t));
+    
+    // cities grouped by component, and a stamp so each successor is merged once
+    int *start = calloc(c + 1, sizeof(int));
+    int *members = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *seen = malloc((c > 0 ? c : 1) * sizeof(int));
+    if (ri->closure == NULL || start == NULL || members == NULL || seen == NULL) {
+        free(start);
+        free(members);
+        free(seen);
+        reach_free(ri);
+        return NULL;
+    }
+    
+    for (int i = 0; i < n; ++i) {
+        start[ri->component[i] + 1]++;
+    }
+    for (int k = 0; k < c; ++k) {
+        start[k + 1] += start[k];
+        seen[k] = -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        members[start[ri->component[i]]++] = i;
+    }
+    for (int k = c; k > 0; --k) {
+        start[k] = start[k - 1];
+    }
+    start[0] = 0;
+    
+    // successors always have smaller numbers, so their rows are final already
+    for (int k = 0; k < c; ++k) {
+        ri->closure[(size_t)k * ri->words + (k >> 6)] |= (uint64_t)1 << (k & 63);
+        for (int m = start[k]; m < start[k + 1]; ++m) {
+            int v = members[m];
+            for (int e = fg->offsets[v]; e < fg->offsets[v + 1]; ++e) {
+                int d = ri->component[fg->edges[e].dest];
+                if (d == k || seen[d] == k) continue;
+                seen[d] = k;
+                reach_or_row(ri, k, d);
+            }
+        }
+    }
+    
+    free(start);
+    free(members);
+    free(seen);
+    return ri;
+}
+
+void reach_free(ReachIndex *ri) {
+    if (ri == NULL) return;
+    free(ri->component);
+    free(ri->closure);
+    free(ri);
+}
+
+int reach_query(const ReachIndex *ri, int fromIdx, int toIdx) {
+    if (fromIdx < 0 || toIdx < 0 || fromIdx >= ri->cityCount || toIdx >= ri->cityCount) return 0;
+    return reach_bit(ri, ri->component[fromIdx], ri->component[toIdx]);
+}
+
+// A new route u -> v lets everything that reaches u also reach whatever v
+// reaches. Components joined into a cycle are not merged; their rows simply
+// become equal, which is all the queries need.
+void reach_add_route(ReachIndex *ri, int fromIdx, int toIdx) {
+    int cu = ri->component[fromIdx];
+    int cv = ri->component[toIdx];
+    if (reach_bit(ri, cu, cv)) return;
+    
+    for (int x = 0; x < ri->componentCount; ++x) {
+        if (reach_bit(ri, x, cu)) reach_or_row(ri, x, cv);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef REACH_H
+#define REACH_H
+
+#include <stdint.h>
+#include "graph.h"
+
+// Reachability index: strongly connected components (Tarjan) and the
+// transitive closure of the condensation DAG as one bitset row per component.
+// Components are numbered in the order Tarjan completes them, so every
+// route leaves a component for one with a smaller number.
+
+#define REACH_MAX_COMPONENTS 16384 // closure is components^2 bits (32 MiB here)
+
+struct ReachIndex {
+    int cityCount;      // dense city indices, same order as the graph it was built from
+    int componentCount;
+    int *component;     // city index -> component
+    int words;          // 64-bit words per closure row
+    uint64_t *closure;  // row c: components reachable from c, c included
+};
+
+ReachIndex *reach_build(const FrozenGraph *fg);
+void reach_free(ReachIndex *ri);
+int reach_query(const ReachIndex *ri, int fromIdx, int toIdx);
+void reach_add_route(ReachIndex *ri, int fromIdx, int toIdx);
+
+#endif
\ No newline at end of file
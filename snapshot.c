@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "graph.h"
+#include "snapshot.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Layout: SnapshotHeader, then one section per FrozenGraph array in the order
+// below. Sections start on 8-byte boundaries; the checksum (FNV-1a 64) covers
+// every byte after the header, padding included.
+
+enum {
+    SEC_OFFSETS,
+    SEC_EDGES,
+    SEC_IDS,
+    SEC_INDEX,
+    SEC_REV_OFFSETS,
+    SEC_REV_EDGES,
+    SEC_NAME_OFFSETS,
+    SEC_NAME_DATA,
+    SEC_LATITUDE,
+    SEC_LONGITUDE,
+    SECTION_COUNT
+};
+
+#define SNAPSHOT_MAGIC "AIRGRAPH"
+#define SNAPSHOT_ENDIAN 0x01020304u
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+} SnapshotSection;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    int32_t cityCount;
+    int32_t edgeCount;
+    int32_t indexMask;
+    uint32_t sectionCount;
+    double geoBound;
+    uint64_t fileSize;
+    uint64_t checksum;
+    SnapshotSection sections[SECTION_COUNT];
+} SnapshotHeader;
+
+static uint64_t fnv1a(uint64_t h, const unsigned char *p, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static size_t name_bytes(const FrozenGraph *fg) {
+    if (fg->cityCount == 0) return 0;
+    const char *last = fg->nameData + fg->nameOffsets[fg->cityCount - 1];
+    return (size_t)(last - fg->nameData) + strlen(last) + 1;
+}
+
+int snapshot_write(const FrozenGraph *fg, const char *path) {
+    if (fg == NULL || path == NULL) return -1;
+    
+    int n = fg->cityCount;
+    int m = fg->edgeCount;
+    const void *data[SECTION_COUNT] = {
+        fg->offsets, fg->edges, fg->ids, fg->index.slots,
+        fg->revOffsets, fg->revEdges, fg->nameOffsets, fg->nameData,
+        fg->latitude, fg->longitude
+    };
+    size_t sizes[SECTION_COUNT] = {
+        (size_t)(n + 1) * sizeof(int),
+        (size_t)m * sizeof(CsrEdge),
+        (size_t)n * sizeof(int),
+        (size_t)(fg->index.mask + 1) * sizeof(IdSlot),
+        (size_t)(n + 1) * sizeof(int),
+        (size_t)m * sizeof(CsrEdge),
+        (size_t)n * sizeof(int),
+        name_bytes(fg),
+        (size_t)n * sizeof(double),
+        (size_t)n * sizeof(double)
+    };
+    
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, 8);
+    h.version = SNAPSHOT_VERSION;
+    h.endianTag = SNAPSHOT_ENDIAN;
+    h.cityCount = n;
+    h.edgeCount = m;
+    h.indexMask = fg->index.mask;
+    h.sectionCount = SECTION_COUNT;
+    h.geoBound = fg->geoBound;
+    
+    size_t at = align8(sizeof(SnapshotHeader));
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        h.sections[s].offset = at;
+        h.sections[s].size = sizes[s];
+        at = align8(at + sizes[s]);
+    }
+    h.fileSize = at;
+    
+    // write to a temporary name and rename, so a worker never maps a half-written file
+    size_t pathLen = strlen(path);
+    char *tmpPath = malloc(pathLen + 5);
+    if (tmpPath == NULL) return -1;
+    memcpy(tmpPath, path, pathLen);
+    memcpy(tmpPath + pathLen, ".tmp", 5);
+    
+    FILE *fp = fopen(tmpPath, "wb");
+    if (fp == NULL) {
+        free(tmpPath);
+        return -1;
+    }
+    
+    static const unsigned char zeros[8] = {0};
+    uint64_t sum = 0xcbf29ce484222325ULL;
+    int ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+    size_t written = sizeof(h);
+    for (int s = 0; s < SECTION_COUNT && ok; ++s) {
+        size_t pad = h.sections[s].offset - written;
+        sum = fnv1a(sum, zeros, pad);
+        sum = fnv1a(sum, data[s], sizes[s]);
+        ok = fwrite(zeros, 1, pad, fp) == pad &&
+             (sizes[s] == 0 || fwrite(data[s], 1, sizes[s], fp) == sizes[s]);
+        written += pad + sizes[s];
+    }
+    if (ok) {
+        size_t pad = h.fileSize - written;
+        sum = fnv1a(sum, zeros, pad);
+        ok = fwrite(zeros, 1, pad, fp) == pad;
+    }
+    
+    h.checksum = sum;
+    if (ok) ok = fseek(fp, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, fp) == 1;
+    if (fclose(fp) != 0) ok = 0;
+    
+#ifdef _WIN32
+    if (ok) remove(path);
+#endif
+    if (ok) ok = rename(tmpPath, path) == 0;
+    if (!ok) remove(tmpPath);
+    free(tmpPath);
+    return ok ? 0 : -1;
+}
+
+static void *map_file(const char *path, size_t *size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) {
+        CloseHandle(file);
+        return NULL;
+    }
+    HANDLE view = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (view == NULL) return NULL;
+    
+    void *base = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(view);
+    *size = (size_t)len.QuadPart;
+    return base;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+    
+    *size = (size_t)st.st_size;
+    return base;
+#endif
+}
+
+void snapshot_release(void *mapping, size_t size) {
+    if (mapping == NULL) return;
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+static int header_valid(const SnapshotHeader *h, size_t size) {
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, 8) != 0) return 0;
+    if (h->version != SNAPSHOT_VERSION || h->endianTag != SNAPSHOT_ENDIAN) return 0;
+    if (h->sectionCount != SECTION_COUNT || h->fileSize != size) return 0;
+    if (h->cityCount < 0 || h->edgeCount < 0) return 0;
+    if (h->indexMask < 7 || (h->indexMask & (h->indexMask + 1)) != 0) return 0;
+    if ((int64_t)h->indexMask + 1 < 2 * (int64_t)h->cityCount) return 0;
+    
+    uint64_t n = (uint64_t)h->cityCount;
+    uint64_t m = (uint64_t)h->edgeCount;
+    uint64_t expected[SECTION_COUNT] = {
+        (n + 1) * sizeof(int),
+        m * sizeof(CsrEdge),
+        n * sizeof(int),
+        ((uint64_t)h->indexMask + 1) * sizeof(IdSlot),
+        (n + 1) * sizeof(int),
+        m * sizeof(CsrEdge),
+        n * sizeof(int),
+        0,
+        n * sizeof(double),
+        n * sizeof(double)
+    };
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        const SnapshotSection *sec = &h->sections[s];
+        if (s != SEC_NAME_DATA && sec->size != expected[s]) return 0;
+        if (sec->offset % 8 != 0 || sec->offset < sizeof(SnapshotHeader)) return 0;
+        if (sec->offset > size || sec->size > size - sec->offset) return 0;
+    }
+    
+    // every name lookup must land inside the string table on a terminated string
+    const SnapshotSection *names = &h->sections[SEC_NAME_DATA];
+    if (n > 0 && (names->size == 0 || ((const char *)h)[names->offset + names->size - 1] != '\0')) return 0;
+    return 1;
+}
+
+static int arrays_valid(const FrozenGraph *fg, uint64_t nameSize) {
+    int n = fg->cityCount;
+    if (fg->offsets[0] != 0 || fg->offsets[n] != fg->edgeCount) return 0;
+    if (fg->revOffsets[0] != 0 || fg->revOffsets[n] != fg->edgeCount) return 0;
+    for (int i = 0; i < n; ++i) {
+        if (fg->offsets[i] > fg->offsets[i + 1] || fg->revOffsets[i] > fg->revOffsets[i + 1]) return 0;
+        if (fg->nameOffsets[i] < 0 || (uint64_t)fg->nameOffsets[i] >= nameSize) return 0;
+    }
+    int emptySlots = 0;
+    for (int s = 0; s <= fg->index.mask; ++s) {
+        int idx = fg->index.slots[s].index;
+        if (idx < -1 || idx >= n) return 0;
+        if (idx == -1) emptySlots++;
+    }
+    if (emptySlots == 0) return 0; // lookups probe until an empty slot
+    for (int k = 0; k < fg->edgeCount; ++k) {
+        if (fg->edges[k].dest < 0 || fg->edges[k].dest >= n) return 0;
+        if (fg->revEdges[k].dest < 0 || fg->revEdges[k].dest >= n) return 0;
+    }
+    return 1;
+}
+
+// Maps a snapshot written by snapshot_write. The returned graph points straight
+// into the mapping; free_frozen_graph unmaps it. With verify set the checksum
+// and the CSR arrays are checked too, which touches every page of the file.
+FrozenGraph *snapshot_open(const char *path, int verify) {
+    if (path == NULL) return NULL;
+    
+    size_t size = 0;
+    unsigned char *base = map_file(path, &size);
+    if (base == NULL) return NULL;
+    
+    const SnapshotHeader *h = (const SnapshotHeader *)base;
+    if (size < sizeof(SnapshotHeader) || !header_valid(h, size)) {
+        snapshot_release(base, size);
+        return NULL;
+    }
+    if (verify) {
+        uint64_t sum = fnv1a(0xcbf29ce484222325ULL, base + sizeof(SnapshotHeader),
+                             size - sizeof(SnapshotHeader));
+        if (sum != h->checksum) {
+            snapshot_release(base, size);
+            return NULL;
+        }
+    }
+    
+    FrozenGraph *fg = malloc(sizeof(FrozenGraph));
+    if (fg == NULL) {
+        snapshot_release(base, size);
+        return NULL;
+    }
+    
+    fg->cityCount = h->cityCount;
+    fg->edgeCount = h->edgeCount;
+    fg->offsets = (int *)(base + h->sections[SEC_OFFSETS].offset);
+    fg->edges = (CsrEdge *)(base + h->sections[SEC_EDGES].offset);
+    fg->ids = (int *)(base + h->sections[SEC_IDS].offset);
+    fg->index.slots = (IdSlot *)(base + h->sections[SEC_INDEX].offset);
+    fg->index.mask = h->indexMask;
+    fg->revOffsets = (int *)(base + h->sections[SEC_REV_OFFSETS].offset);
+    fg->revEdges = (CsrEdge *)(base + h->sections[SEC_REV_EDGES].offset);
+    fg->nameOffsets = (int *)(base + h->sections[SEC_NAME_OFFSETS].offset);
+    fg->nameData = (char *)(base + h->sections[SEC_NAME_DATA].offset);
+    fg->latitude = (double *)(base + h->sections[SEC_LATITUDE].offset);
+    fg->longitude = (double *)(base + h->sections[SEC_LONGITUDE].offset);
+    fg->geoBound = h->geoBound;
+    fg->mapping = base;
+    fg->mappingSize = size;
+    
+    if (verify && !arrays_valid(fg, h->sections[SEC_NAME_DATA].size)) {
+        free_frozen_graph(fg);
+        return NULL;
+    }
+    return fg;
+}
\ No newline at end of file
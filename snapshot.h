@@ -0,0 +1,16 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include "graph.h"
+
+// Binary snapshot of a FrozenGraph. The file is a fixed header followed by
+// the CSR arrays, each 8-byte aligned, so it can be mapped and used in place.
+
+#define SNAPSHOT_VERSION 1
+
+int snapshot_write(const FrozenGraph *fg, const char *path);
+FrozenGraph *snapshot_open(const char *path, int verify);
+void snapshot_release(void *mapping, size_t size);
+
+#endif
\ No newline at end of file
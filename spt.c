@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "spt.h"
+
+static void *grow_array(void *p, size_t count, size_t size) {
+    void *grown = realloc(p, (count > 0 ? count : 1) * size);
+    if (grown == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static void reset_tree_entries(ShortestPathTree *t, int from, int to) {
+    for (int v = from; v < to; ++v) {
+        t->dist[v] = MAX_DISTANCE;
+        t->parent[v] = -1;
+        t->firstChild[v] = -1;
+        t->nextSibling[v] = -1;
+        t->prevSibling[v] = -1;
+    }
+}
+
+static void size_tree(ShortestPathTree *t, int cap) {
+    t->dist = grow_array(t->dist, cap, sizeof(int));
+    t->parent = grow_array(t->parent, cap, sizeof(int));
+    t->firstChild = grow_array(t->firstChild, cap, sizeof(int));
+    t->nextSibling = grow_array(t->nextSibling, cap, sizeof(int));
+    t->prevSibling = grow_array(t->prevSibling, cap, sizeof(int));
+}
+
+// new cities start with no incoming routes and unreachable in every tree
+static void ensure_cities(HubTrees *ht, int count) {
+    if (count > ht->cityCap) {
+        int cap = ht->cityCap > 0 ? ht->cityCap : 16;
+        while (cap < count) cap *= 2;
+        
+        ht->in = grow_array(ht->in, cap, sizeof(InRoute *));
+        ht->inCount = grow_array(ht->inCount, cap, sizeof(int));
+        ht->inCap = grow_array(ht->inCap, cap, sizeof(int));
+        ht->list = grow_array(ht->list, cap, sizeof(int));
+        for (int i = 0; i < ht->treeCount; ++i) {
+            size_tree(ht->trees[i], cap);
+        }
+        heap_free(&ht->heap);
+        if (heap_init(&ht->heap, cap) != 0) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        ht->cityCap = cap;
+    }
+    
+    for (int v = ht->cityCount; v < count; ++v) {
+        ht->in[v] = NULL;
+        ht->inCount[v] = 0;
+        ht->inCap[v] = 0;
+    }
+    for (int i = 0; i < ht->treeCount; ++i) {
+        reset_tree_entries(ht->trees[i], ht->cityCount, count);
+    }
+    if (count > ht->cityCount) ht->cityCount = count;
+}
+
+static void add_in_route(HubTrees *ht, int from, int to, int distance) {
+    if (ht->inCount[to] == ht->inCap[to]) {
+        ht->inCap[to] = ht->inCap[to] > 0 ? ht->inCap[to] * 2 : 4;
+        ht->in[to] = grow_array(ht->in[to], ht->inCap[to], sizeof(InRoute));
+    }
+    ht->in[to][ht->inCount[to]].from = from;
+    ht->in[to][ht->inCount[to]].distance = distance;
+    ht->inCount[to]++;
+}
+
+static InRoute *find_in_route(HubTrees *ht, int from, int to) {
+    for (int i = 0; i < ht->inCount[to]; ++i) {
+        if (ht->in[to][i].from == from) return &ht->in[to][i];
+    }
+    return NULL;
+}
+
+static void load_in_routes(HubTrees *ht, const Graph *g) {
+    ensure_cities(ht, g->cityCount);
+    for (int v = 0; v < ht->cityCount; ++v) {
+        ht->inCount[v] = 0;
+    }
+    for (int u = 0; u < g->cityCount; ++u) {
+        const City *c = &g->cities[u];
+        for (int e = 0; e < c->edgeCount; ++e) {
+            int v = id_index_find(&g->index, c->edges[e].destId);
+            if (v != -1) add_in_route(ht, u, v, c->edges[e].distance);
+        }
+    }
+}
+
+static void detach(ShortestPathTree *t, int v) {
+    int p = t->parent[v];
+    if (p == -1) return;
+    
+    if (t->prevSibling[v] != -1) t->nextSibling[t->prevSibling[v]] = t->nextSibling[v];
+    else t->firstChild[p] = t->nextSibling[v];
+    if (t->nextSibling[v] != -1) t->prevSibling[t->nextSibling[v]] = t->prevSibling[v];
+    t->parent[v] = -1;
+}
+
+static void set_parent(ShortestPathTree *t, int v, int p) {
+    if (t->parent[v] == p) return;
+    
+    detach(t, v);
+    t->parent[v] = p;
+    t->prevSibling[v] = -1;
+    t->nextSibling[v] = t->firstChild[p];
+    if (t->firstChild[p] != -1) t->prevSibling[t->firstChild[p]] = v;
+    t->firstChild[p] = v;
+}
+
+// Dijkstra from whatever is queued, returns the number of cities settled
+static int propagate(HubTrees *ht, const Graph *g, ShortestPathTree *t) {
+    int settled = 0;
+    while (!heap_empty(&ht->heap)) {
+        int d;
+        int x = heap_pop_min(&ht->heap, &d);
+        settled++;
+        
+        const City *c = &g->cities[x];
+        for (int e = 0; e < c->edgeCount; ++e) {
+            int y = id_index_find(&g->index, c->edges[e].destId);
+            if (y == -1) continue;
+            
+            int nd = d + c->edges[e].distance;
+            if (nd < t->dist[y]) {
+                t->dist[y] = nd;
+                set_parent(t, y, x);
+                heap_push_or_decrease(&ht->heap, y, nd);
+            }
+        }
+    }
+    return settled;
+}
+
+static void build_tree(HubTrees *ht, const Graph *g, ShortestPathTree *t) {
+    reset_tree_entries(t, 0, ht->cityCount);
+    t->dist[t->source] = 0;
+    heap_clear(&ht->heap);
+    heap_push_or_decrease(&ht->heap, t->source, 0);
+    propagate(ht, g, t);
+}
+
+// from -> to got cheaper or is new: push the improvement down while it lasts
+static void lower(HubTrees *ht, const Graph *g, ShortestPathTree *t, int from, int to, int distance) {
+    if (t->dist[from] == MAX_DISTANCE) return;
+    
+    int nd = t->dist[from] + distance;
+    if (nd >= t->dist[to]) return;
+    
+    t->dist[to] = nd;
+    set_parent(t, to, from);
+    heap_clear(&ht->heap);
+    heap_push_or_decrease(&ht->heap, to, nd);
+    ht->settled += propagate(ht, g, t);
+}
+
+// the tree route into v was cut or lengthened: every city below v may now be
+// farther, nothing else is, so only v's subtree is settled again
+static void repair(HubTrees *ht, const Graph *g, ShortestPathTree *t, int v) {
+    int n = 0;
+    ht->list[n++] = v;
+    for (int i = 0; i < n; ++i) {
+        for (int c = t->firstChild[ht->list[i]]; c != -1; c = t->nextSibling[c]) {
+            ht->list[n++] = c;
+        }
+    }
+    
+    detach(t, v);
+    for (int i = 0; i < n; ++i) {
+        int y = ht->list[i];
+        t->parent[y] = -1;
+        t->firstChild[y] = -1;
+        t->dist[y] = MAX_DISTANCE;
+    }
+    
+    // reattach each cut city through its cheapest route from outside the subtree
+    heap_clear(&ht->heap);
+    for (int i = 0; i < n; ++i) {
+        int y = ht->list[i];
+        int best = MAX_DISTANCE;
+        int bestFrom = -1;
+        for (int r = 0; r < ht->inCount[y]; ++r) {
+            int x = ht->in[y][r].from;
+            if (t->dist[x] == MAX_DISTANCE) continue;
+            
+            int nd = t->dist[x] + ht->in[y][r].distance;
+            if (nd < best) {
+                best = nd;
+                bestFrom = x;
+            }
+        }
+        if (bestFrom != -1) {
+            t->dist[y] = best;
+            set_parent(t, y, bestFrom);
+            heap_push_or_decrease(&ht->heap, y, best);
+        }
+    }
+    ht->settled += propagate(ht, g, t);
+}
+
+HubTrees *spt_create(const Graph *g) {
+    if (g == NULL) return NULL;
+    
+    HubTrees *ht = calloc(1, sizeof(HubTrees));
+    if (ht == NULL) return NULL;
+    
+    load_in_routes(ht, g);
+    return ht;
+}
+
+static void free_tree(ShortestPathTree *t) {
+    free(t->dist);
+    free(t->parent);
+    free(t->firstChild);
+    free(t->nextSibling);
+    free(t->prevSibling);
+    free(t);
+}
+
+void spt_free(HubTrees *ht) {
+    if (ht == NULL) return;
+    
+    for (int v = 0; v < ht->cityCount; ++v) {
+        free(ht->in[v]);
+    }
+    for (int i = 0; i < ht->treeCount; ++i) {
+        free_tree(ht->trees[i]);
+    }
+    free(ht->in);
+    free(ht->inCount);
+    free(ht->inCap);
+    free(ht->list);
+    free(ht->trees);
+    heap_free(&ht->heap);
+    free(ht);
+}
+
+const ShortestPathTree *spt_find(const HubTrees *ht, int source) {
+    if (ht == NULL) return NULL;
+    
+    for (int i = 0; i < ht->treeCount; ++i) {
+        if (ht->trees[i]->source == source) return ht->trees[i];
+    }
+    return NULL;
+}
+
+// builds the tree from dense city index source, or returns it if already tracked
+const ShortestPathTree *spt_track(HubTrees *ht, const Graph *g, int source) {
+    if (ht == NULL || g == NULL || source < 0 || source >= ht->cityCount) return NULL;
+    
+    const ShortestPathTree *existing = spt_find(ht, source);
+    if (existing != NULL) return existing;
+    
+    ShortestPathTree *t = calloc(1, sizeof(ShortestPathTree));
+    if (t == NULL) return NULL;
+    t->source = source;
+    size_tree(t, ht->cityCap);
+    
+    if (ht->treeCount == ht->treeCap) {
+        ht->treeCap = ht->treeCap > 0 ? ht->treeCap * 2 : 4;
+        ht->trees = grow_array(ht->trees, ht->treeCap, sizeof(ShortestPathTree *));
+    }
+    ht->trees[ht->treeCount++] = t;
+    build_tree(ht, g, t);
+    return t;
+}
+
+int spt_untrack(HubTrees *ht, int source) {
+    if (ht == NULL) return -1;
+    
+    for (int i = 0; i < ht->treeCount; ++i) {
+        if (ht->trees[i]->source == source) {
+            free_tree(ht->trees[i]);
+            for (int j = i; j + 1 < ht->treeCount; ++j) {
+                ht->trees[j] = ht->trees[j + 1];
+            }
+            ht->treeCount--;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// path of city ids from the tree's source to dense index dest, returns its distance or -1
+int spt_path(const Graph *g, const ShortestPathTree *t, int dest, int *path, int *pathLength) {
+    if (g == NULL || t == NULL || path == NULL || pathLength == NULL) return -1;
+    *pathLength = 0;
+    if (dest < 0 || dest >= g->cityCount || t->dist[dest] == MAX_DISTANCE) return -1;
+    
+    int n = 0;
+    for (int v = dest; v != -1; v = t->parent[v]) {
+        path[n++] = g->cities[v].id;
+    }
+    for (int i = 0; i < n / 2; ++i) {
+        int tmp = path[i];
+        path[i] = path[n - 1 - i];
+        path[n - 1 - i] = tmp;
+    }
+    *pathLength = n;
+    return t->dist[dest];
+}
+
+void spt_city_added(HubTrees *ht) {
+    if (ht == NULL) return;
+    ensure_cities(ht, ht->cityCount + 1);
+}
+
+// from, to are dense indices; the graph already holds the new route
+void spt_route_added(HubTrees *ht, const Graph *g, int from, int to, int distance) {
+    if (ht == NULL) return;
+    
+    add_in_route(ht, from, to, distance);
+    for (int i = 0; i < ht->treeCount; ++i) {
+        lower(ht, g, ht->trees[i], from, to, distance);
+    }
+    ht->updates++;
+}
+
+void spt_route_removed(HubTrees *ht, const Graph *g, int from, int to) {
+    if (ht == NULL) return;
+    
+    InRoute *r = find_in_route(ht, from, to);
+    if (r == NULL) return;
+    *r = ht->in[to][--ht->inCount[to]];
+    
+    for (int i = 0; i < ht->treeCount; ++i) {
+        ShortestPathTree *t = ht->trees[i];
+        if (t->parent[to] == from) repair(ht, g, t, to);
+    }
+    ht->updates++;
+}
+
+void spt_route_changed(HubTrees *ht, const Graph *g, int from, int to, int oldDistance, int newDistance) {
+    if (ht == NULL || oldDistance == newDistance) return;
+    
+    InRoute *r = find_in_route(ht, from, to);
+    if (r == NULL) return;
+    r->distance = newDistance;
+    
+    for (int i = 0; i < ht->treeCount; ++i) {
+        ShortestPathTree *t = ht->trees[i];
+        if (newDistance < oldDistance) lower(ht, g, t, from, to, newDistance);
+        else if (t->parent[to] == from) repair(ht, g, t, to);
+    }
+    ht->updates++;
+}
+
+// after bulk edits: reload the incoming routes and recompute every tree
+void spt_rebuild(HubTrees *ht, const Graph *g) {
+    if (ht == NULL || g == NULL) return;
+    
+    load_in_routes(ht, g);
+    for (int i = 0; i < ht->treeCount; ++i) {
+        build_tree(ht, g, ht->trees[i]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef SPT_H
+#define SPT_H
+
+#include "graph.h"
+#include "heap.h"
+
+// Shortest path trees from tracked source cities, kept exact across route
+// edits in the style of Ramalingam and Reps. A new or shortened route only
+// propagates from its head while distances drop. A removed or lengthened
+// tree route cuts off the subtree below it; the subtree is reattached through
+// its cheapest routes from the rest of the tree and settled again by a
+// Dijkstra search confined to it. Both cost time in the cities whose
+// distance changes, not in the size of the network. Route distances must
+// not be negative.
+//
+// The graph calls the spt_route_* hooks from its edit functions; callers
+// only track and untrack sources and read the trees.
+
+struct ShortestPathTree {
+    int source;       // dense city index
+    int *dist;        // MAX_DISTANCE when unreachable
+    int *parent;      // previous city on the tree path, -1 for the source and unreachable cities
+    int *firstChild;  // children of each city as a doubly linked sibling list
+    int *nextSibling;
+    int *prevSibling;
+};
+
+typedef struct {
+    int from;     // dense city index
+    int distance;
+} InRoute;
+
+struct HubTrees {
+    int cityCount;
+    int cityCap;
+    InRoute **in;     // incoming routes of each city
+    int *inCount;
+    int *inCap;
+    ShortestPathTree **trees;
+    int treeCount;
+    int treeCap;
+    IndexedHeap heap; // scratch shared by the updates
+    int *list;        // cities cut off by the current update
+    unsigned long updates;
+    unsigned long long settled; // cities settled again by the updates
+};
+
+HubTrees *spt_create(const Graph *g);
+void spt_free(HubTrees *ht);
+const ShortestPathTree *spt_track(HubTrees *ht, const Graph *g, int source);
+int spt_untrack(HubTrees *ht, int source);
+const ShortestPathTree *spt_find(const HubTrees *ht, int source);
+int spt_path(const Graph *g, const ShortestPathTree *t, int dest, int *path, int *pathLength);
+
+void spt_city_added(HubTrees *ht);
+void spt_route_added(HubTrees *ht, const Graph *g, int from, int to, int distance);
+void spt_route_removed(HubTrees *ht, const Graph *g, int from, int to);
+void spt_route_changed(HubTrees *ht, const Graph *g, int from, int to, int oldDistance, int newDistance);
+void spt_rebuild(HubTrees *ht, const Graph *g);
+
+#endif
\ No newline at end of file
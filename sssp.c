@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sssp.h"
+#include "workers.h"
+
+#define SSSP_CHUNK 256 // frontier cities a worker claims at a time
+
+typedef struct {
+    DeltaStepping *ds;
+    const int *cities;
+    int count;
+    int heavy;        // relax routes longer than delta, otherwise the others
+    atomic_int next;  // next unclaimed position in cities
+} SsspPhase;
+
+static uint64_t pack_label(int dist, int pred) {
+    return (uint64_t)(uint32_t)dist << 32 | (uint32_t)pred;
+}
+
+static int label_dist(uint64_t label) {
+    return (int)(label >> 32);
+}
+
+static void buffer_push(SsspBuffer *b, int v) {
+    if (b->count >= b->cap) {
+        int newCap = b->cap ? b->cap * 2 : 64;
+        int *items = realloc(b->items, newCap * sizeof(int));
+        if (items == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        b->items = items;
+        b->cap = newCap;
+    }
+    b->items[b->count++] = v;
+}
+
+// delta 0 takes a quarter of the routes' mean distance; on generated networks
+// of 200k cities that ran faster than both narrower buckets (more phases) and
+// wider ones (more cities relaxed again within a bucket)
+DeltaStepping *sssp_create(const FrozenGraph *fg, int threads, int delta) {
+    if (fg == NULL || delta < 0) return NULL;
+    
+    int n = fg->cityCount;
+    DeltaStepping *ds = calloc(1, sizeof(DeltaStepping));
+    if (ds == NULL) return NULL;
+    
+    long long total = 0;
+    int longest = 1;
+    for (int e = 0; e < fg->edgeCount; ++e) {
+        total += fg->edges[e].distance;
+        if (fg->edges[e].distance > longest) longest = fg->edges[e].distance;
+    }
+    if (delta == SSSP_AUTO_DELTA) delta = fg->edgeCount > 0 ? (int)(total / fg->edgeCount / 4) : 1;
+    
+    ds->fg = fg;
+    ds->threads = threads > 0 ? threads : cpu_count();
+    ds->serialCities = SSSP_SERIAL_CITIES;
+    ds->delta = delta > 0 ? delta : 1;
+    ds->bucketCount = longest / ds->delta + 2;
+    ds->dist = malloc((n > 0 ? n : 1) * sizeof(int));
+    ds->pred = malloc((n > 0 ? n : 1) * sizeof(int));
+    ds->label = malloc((n > 0 ? n : 1) * sizeof(_Atomic uint64_t));
+    ds->mark = calloc(n > 0 ? n : 1, sizeof(unsigned int));
+    ds->done = calloc(n > 0 ? n : 1, sizeof(unsigned int));
+    ds->buckets = calloc(ds->bucketCount, sizeof(SsspBuffer));
+    ds->local = calloc(ds->threads, sizeof(SsspBuffer));
+    int heapOk = heap_init(&ds->heap, n) == 0;
+    ds->heapReady = heapOk;
+    if (ds->dist == NULL || ds->pred == NULL || ds->label == NULL || ds->mark == NULL || ds->done == NULL ||
+        ds->buckets == NULL || ds->local == NULL || !heapOk) {
+        sssp_free(ds);
+        return NULL;
+    }
+    for (int v = 0; v < n; ++v) {
+        atomic_init(&ds->label[v], pack_label(MAX_DISTANCE, -1));
+    }
+    return ds;
+}
+
+void sssp_free(DeltaStepping *ds) {
+    if (ds == NULL) return;
+    
+    for (int b = 0; ds->buckets != NULL && b < ds->bucketCount; ++b) {
+        free(ds->buckets[b].items);
+    }
+    for (int w = 0; ds->local != NULL && w < ds->threads; ++w) {
+        free(ds->local[w].items);
+    }
+    free(ds->buckets);
+    free(ds->local);
+    free(ds->frontier.items);
+    free(ds->settled.items);
+    free(ds->dist);
+    free(ds->pred);
+    free(ds->label);
+    free(ds->mark);
+    free(ds->done);
+    if (ds->heapReady) heap_free(&ds->heap);
+    free(ds);
+}
+
+static void run_serial(DeltaStepping *ds, int source) {
+    const FrozenGraph *fg = ds->fg;
+    for (int v = 0; v < fg->cityCount; ++v) {
+        ds->dist[v] = MAX_DISTANCE;
+        ds->pred[v] = -1;
+    }
+    ds->dist[source] = 0;
+    heap_clear(&ds->heap);
+    heap_push_or_decrease(&ds->heap, source, 0);
+    
+    while (!heap_empty(&ds->heap)) {
+        int du;
+        int u = heap_pop_min(&ds->heap, &du);
+        for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+            int v = fg->edges[e].dest;
+            int newDist = du + fg->edges[e].distance;
+            if (newDist < ds->dist[v]) {
+                ds->dist[v] = newDist;
+                ds->pred[v] = u;
+                heap_push_or_decrease(&ds->heap, v, newDist);
+            }
+        }
+    }
+}
+
+// lowers v's distance to dist through u unless another thread got it lower already
+static int relax(DeltaStepping *ds, int u, int v, int dist) {
+    uint64_t old = atomic_load_explicit(&ds->label[v], memory_order_relaxed);
+    while (label_dist(old) > dist) {
+        if (atomic_compare_exchange_weak_explicit(&ds->label[v], &old, pack_label(dist, u),
+                                                  memory_order_relaxed, memory_order_relaxed)) return 1;
+    }
+    return 0;
+}
+
+static void phase_worker(void *arg, int worker) {
+    SsspPhase *ph = arg;
+    DeltaStepping *ds = ph->ds;
+    const FrozenGraph *fg = ds->fg;
+    SsspBuffer *out = &ds->local[worker];
+    
+    int first;
+    while ((first = atomic_fetch_add_explicit(&ph->next, SSSP_CHUNK, memory_order_relaxed)) < ph->count) {
+        int end = first + SSSP_CHUNK < ph->count ? first + SSSP_CHUNK : ph->count;
+        for (int i = first; i < end; ++i) {
+            int u = ph->cities[i];
+            int du = label_dist(atomic_load_explicit(&ds->label[u], memory_order_relaxed));
+            for (int e = fg->offsets[u]; e < fg->offsets[u + 1]; ++e) {
+                int w = fg->edges[e].distance;
+                if ((w > ds->delta) != ph->heavy) continue;
+                if (relax(ds, u, fg->edges[e].dest, du + w)) buffer_push(out, fg->edges[e].dest);
+            }
+        }
+    }
+}
+
+static void run_phase(DeltaStepping *ds, const int *cities, int count, int heavy) {
+    SsspPhase ph;
+    ph.ds = ds;
+    ph.cities = cities;
+    ph.count = count;
+    ph.heavy = heavy;
+    atomic_init(&ph.next, 0);
+    
+    // a thread per SSSP_GRAIN cities, so small phases stay on this thread
+    int threads = 1 + count / SSSP_GRAIN;
+    if (threads > ds->threads) threads = ds->threads;
+    run_workers(threads, phase_worker, &ph);
+}
+
+static void next_stamp(DeltaStepping *ds) {
+    if (++ds->stamp == 0) {
+        memset(ds->mark, 0, ds->fg->cityCount * sizeof(unsigned int));
+        ds->stamp = 1;
+    }
+}
+
+// files the cities the last phase lowered: those still in bucket `current`
+// join the next frontier once each, the others wait in their bucket
+static void collect(DeltaStepping *ds, long long current, int *pending) {
+    next_stamp(ds);
+    ds->frontier.count = 0;
+    for (int w = 0; w < ds->threads; ++w) {
+        SsspBuffer *out = &ds->local[w];
+        for (int i = 0; i < out->count; ++i) {
+            int v = out->items[i];
+            long long bucket = label_dist(atomic_load_explicit(&ds->label[v], memory_order_relaxed)) / ds->delta;
+            if (bucket == current) {
+                if (ds->mark[v] == ds->stamp) continue;
+                ds->mark[v] = ds->stamp;
+                buffer_push(&ds->frontier, v);
+            } else {
+                buffer_push(&ds->buckets[bucket % ds->bucketCount], v);
+                (*pending)++;
+            }
+        }
+        out->count = 0;
+    }
+}
+
+static void run_parallel(DeltaStepping *ds, int source) {
+    const FrozenGraph *fg = ds->fg;
+    for (int v = 0; v < fg->cityCount; ++v) {
+        atomic_store_explicit(&ds->label[v], pack_label(MAX_DISTANCE, -1), memory_order_relaxed);
+    }
+    atomic_store_explicit(&ds->label[source], pack_label(0, -1), memory_order_relaxed);
+    buffer_push(&ds->buckets[0], source);
+    int pending = 1;
+    long long current = 0;
+    
+    while (pending > 0) {
+        while (ds->buckets[current % ds->bucketCount].count == 0) {
+            current++;
+        }
+        
+        // the bucket's live entries, each once, are the first frontier; the rest went lower since
+        SsspBuffer *bucket = &ds->buckets[current % ds->bucketCount];
+        next_stamp(ds);
+        ds->frontier.count = 0;
+        for (int i = 0; i < bucket->count; ++i) {
+            int v = bucket->items[i];
+            if (label_dist(atomic_load_explicit(&ds->label[v], memory_order_relaxed)) / ds->delta != current) continue;
+            if (ds->mark[v] == ds->stamp) continue;
+            ds->mark[v] = ds->stamp;
+            buffer_push(&ds->frontier, v);
+        }
+        pending -= bucket->count;
+        bucket->count = 0;
+        
+        if (++ds->round == 0) {
+            memset(ds->done, 0, fg->cityCount * sizeof(unsigned int));
+            ds->round = 1;
+        }
+        ds->settled.count = 0;
+        while (ds->frontier.count > 0) {
+            for (int i = 0; i < ds->frontier.count; ++i) {
+                int v = ds->frontier.items[i];
+                if (ds->done[v] == ds->round) continue;
+                ds->done[v] = ds->round;
+                buffer_push(&ds->settled, v);
+            }
+            run_phase(ds, ds->frontier.items, ds->frontier.count, 0);
+            ds->phases++;
+            collect(ds, current, &pending);
+        }
+        
+        // heavy routes leave the bucket, so one pass over its cities' final distances covers them
+        run_phase(ds, ds->settled.items, ds->settled.count, 1);
+        collect(ds, current, &pending);
+    }
+    
+    for (int v = 0; v < fg->cityCount; ++v) {
+        uint64_t label = atomic_load_explicit(&ds->label[v], memory_order_relaxed);
+        ds->dist[v] = label_dist(label);
+        ds->pred[v] = (int)(uint32_t)label;
+    }
+}
+
+// source is a city id. Returns the number of cities reached, the source
+// included, or -1 for an unknown source; distances and predecessors stay in
+// ds until the next run.
+int sssp_run(DeltaStepping *ds, int source) {
+    if (ds == NULL) return -1;
+    
+    const FrozenGraph *fg = ds->fg;
+    int s = frozen_find_city(fg, source);
+    if (s == -1) return -1;
+    
+    ds->phases = 0;
+    if (fg->cityCount < ds->serialCities) run_serial(ds, s);
+    else run_parallel(ds, s);
+    
+    ds->reached = 0;
+    for (int v = 0; v < fg->cityCount; ++v) {
+        if (ds->dist[v] != MAX_DISTANCE) ds->reached++;
+    }
+    return ds->reached;
+}
+
+// the last run's route to a city id as city ids; returns its distance, or -1 when not reached
+int sssp_path(const DeltaStepping *ds, int dest, int *path, int *pathLength) {
+    if (ds == NULL || path == NULL || pathLength == NULL) return -1;
+    
+    int t = frozen_find_city(ds->fg, dest);
+    if (t == -1 || ds->dist[t] == MAX_DISTANCE) return -1;
+    
+    int len = 0;
+    for (int v = t; v != -1; v = ds->pred[v]) {
+        len++;
+    }
+    int at = len;
+    for (int v = t; v != -1; v = ds->pred[v]) {
+        path[--at] = ds->fg->ids[v];
+    }
+    *pathLength = len;
+    return ds->dist[t];
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef SSSP_H
+#define SSSP_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "heap.h"
+
+// One-to-all shortest paths over a frozen graph by delta-stepping (Meyer and
+// Sanders). Cities wait in buckets of width delta by tentative distance; the
+// lowest bucket is emptied in phases that relax light routes (distance up to
+// delta) in parallel, since those can put cities back into the same bucket,
+// and only then are the heavy routes of everything it settled relaxed, all
+// at once. A city's distance and predecessor share one 64-bit word updated by
+// compare-and-swap, so the two always agree. Small graphs use a serial
+// Dijkstra search instead, which wins there over the phases' fixed costs.
+
+#define SSSP_AUTO_DELTA 0         // pick delta from the routes' mean distance
+#define SSSP_SERIAL_CITIES 16384  // default for serialCities
+#define SSSP_GRAIN 2048           // frontier cities that justify one more thread in a phase
+
+typedef struct {
+    int *items;
+    int count;
+    int cap;
+} SsspBuffer;
+
+typedef struct {
+    const FrozenGraph *fg;
+    int threads;
+    int serialCities;          // graphs with fewer cities run serially, SSSP_SERIAL_CITIES unless changed
+    int delta;                 // bucket width in km
+    int bucketCount;           // buckets in the ring; more than the longest route spans
+    int *dist;                 // distance from the last run's source, MAX_DISTANCE when not reached
+    int *pred;                 // previous city on a shortest path, -1 at the source and when not reached
+    int reached;               // cities reached by the last run, the source included
+    int phases;                // light phases of the last run, 0 when it ran serially
+    _Atomic uint64_t *label;   // distance << 32 | predecessor while a run is in progress
+    unsigned int *mark;        // mark[v] == stamp: v is already in the frontier being built
+    unsigned int stamp;
+    unsigned int *done;        // done[v] == round: v is already in this bucket's settled list
+    unsigned int round;
+    SsspBuffer *buckets;       // ring of bucketCount buckets, stale entries skipped when taken
+    SsspBuffer *local;         // per worker: cities whose distance went down in a phase
+    SsspBuffer frontier;       // cities of the current bucket to relax in the next phase
+    SsspBuffer settled;        // cities the current bucket settled, for the heavy routes
+    IndexedHeap heap;          // serial runs
+    int heapReady;
+} DeltaStepping;
+
+DeltaStepping *sssp_create(const FrozenGraph *fg, int threads, int delta);
+void sssp_free(DeltaStepping *ds);
+int sssp_run(DeltaStepping *ds, int source);
+int sssp_path(const DeltaStepping *ds, int dest, int *path, int *pathLength);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "stats.h"
+
+static const char *opNames[STATS_OP_COUNT] = {
+    "can_reach", "shortest_path", "alternate_route"
+};
+
+const char *stats_op_name(StatsOp op) {
+    if (op < 0 || op >= STATS_OP_COUNT) return "unknown";
+    return opNames[op];
+}
+
+// smallest value that falls into bucket b, and the bucket's width
+static uint64_t bucket_low(int b, uint64_t *width) {
+    if (b < 64) {
+        *width = 1;
+        return (uint64_t)b;
+    }
+    int group = (b - 64) >> STATS_SUB_BITS;
+    int sub = (b - 64) & ((1 << STATS_SUB_BITS) - 1);
+    int shift = group + 6 - STATS_SUB_BITS;
+    *width = (uint64_t)1 << shift;
+    return (uint64_t)((1 << STATS_SUB_BITS) + sub) << shift;
+}
+
+// nanoseconds at or below which pct percent of the calls finished
+uint64_t stats_percentile(const OperationStats *s, double pct) {
+    if (s == NULL || s->calls == 0) return 0;
+    
+    uint64_t rank = (uint64_t)(pct / 100.0 * s->calls + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > s->calls) rank = s->calls;
+    
+    uint64_t seen = 0;
+    for (int b = 0; b < STATS_BUCKETS; ++b) {
+        seen += s->buckets[b];
+        if (seen >= rank) {
+            uint64_t width;
+            uint64_t high = bucket_low(b, &width) + width - 1;
+            return high < s->maxNs ? high : s->maxNs;
+        }
+    }
+    return s->maxNs;
+}
+
+#ifdef AIR_STATS
+
+#include <stdatomic.h>
+#include <time.h>
+
+typedef struct {
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t totalNs;
+    atomic_uint_fast64_t maxNs;
+    atomic_uint_fast64_t settled;
+    atomic_uint_fast64_t relaxed;
+    atomic_uint_fast64_t lookups;
+    atomic_uint_fast64_t allocBytes;
+    atomic_uint_fast64_t buckets[STATS_BUCKETS];
+} SharedStats;
+
+static SharedStats shared[STATS_OP_COUNT];
+
+_Thread_local StatsCounters statsLocal;
+static _Thread_local int scopeDepth;
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    timespec_get(&t, TIME_UTC);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static int bucket_of(uint64_t ns) {
+    if (ns < 64) return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int shift = msb - STATS_SUB_BITS;
+    return 64 + ((msb - 6) << STATS_SUB_BITS) + (int)((ns >> shift) - (1 << STATS_SUB_BITS));
+}
+
+static void add_relaxed(atomic_uint_fast64_t *a, uint64_t v) {
+    atomic_fetch_add_explicit(a, v, memory_order_relaxed);
+}
+
+void stats_scope_begin(StatsScope *scope) {
+    scope->outer = scopeDepth++ == 0;
+    if (!scope->outer) return;
+    
+    scope->start = statsLocal;
+    scope->startNs = now_ns();
+}
+
+void stats_scope_end(StatsScope *scope, StatsOp op) {
+    scopeDepth--;
+    if (!scope->outer) return;
+    
+    uint64_t ns = now_ns() - scope->startNs;
+    SharedStats *s = &shared[op];
+    add_relaxed(&s->calls, 1);
+    add_relaxed(&s->totalNs, ns);
+    add_relaxed(&s->settled, statsLocal.settled - scope->start.settled);
+    add_relaxed(&s->relaxed, statsLocal.relaxed - scope->start.relaxed);
+    add_relaxed(&s->lookups, statsLocal.lookups - scope->start.lookups);
+    add_relaxed(&s->allocBytes, statsLocal.allocBytes - scope->start.allocBytes);
+    add_relaxed(&s->buckets[bucket_of(ns)], 1);
+    
+    uint64_t seen = atomic_load_explicit(&s->maxNs, memory_order_relaxed);
+    while (ns > seen && !atomic_compare_exchange_weak_explicit(&s->maxNs, &seen, ns,
+                                                                memory_order_relaxed, memory_order_relaxed));
+}
+
+int stats_enabled(void) {
+    return 1;
+}
+
+// a consistent copy only while no queries are running; otherwise close enough for reporting
+int stats_read(StatsOp op, OperationStats *out) {
+    if (op < 0 || op >= STATS_OP_COUNT || out == NULL) return -1;
+    
+    SharedStats *s = &shared[op];
+    out->calls = atomic_load_explicit(&s->calls, memory_order_relaxed);
+    out->totalNs = atomic_load_explicit(&s->totalNs, memory_order_relaxed);
+    out->maxNs = atomic_load_explicit(&s->maxNs, memory_order_relaxed);
+    out->totals.settled = atomic_load_explicit(&s->settled, memory_order_relaxed);
+    out->totals.relaxed = atomic_load_explicit(&s->relaxed, memory_order_relaxed);
+    out->totals.lookups = atomic_load_explicit(&s->lookups, memory_order_relaxed);
+    out->totals.allocBytes = atomic_load_explicit(&s->allocBytes, memory_order_relaxed);
+    for (int b = 0; b < STATS_BUCKETS; ++b) {
+        out->buckets[b] = atomic_load_explicit(&s->buckets[b], memory_order_relaxed);
+    }
+    return 0;
+}
+
+void stats_reset(void) {
+    for (int op = 0; op < STATS_OP_COUNT; ++op) {
+        SharedStats *s = &shared[op];
+        atomic_store(&s->calls, 0);
+        atomic_store(&s->totalNs, 0);
+        atomic_store(&s->maxNs, 0);
+        atomic_store(&s->settled, 0);
+        atomic_store(&s->relaxed, 0);
+        atomic_store(&s->lookups, 0);
+        atomic_store(&s->allocBytes, 0);
+        for (int b = 0; b < STATS_BUCKETS; ++b) {
+            atomic_store(&s->buckets[b], 0);
+        }
+    }
+}
+
+void stats_dump(FILE *out) {
+    static OperationStats s; // too large for a small thread stack
+    
+    fprintf(out, "\n=== Query Statistics ===\n");
+    fprintf(out, "%-16s %9s %9s %9s %9s %9s %9s %9s %11s %11s %9s %11s\n",
+            "operation", "calls", "mean us", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us",
+            "settled/q", "relaxed/q", "lookups/q", "alloc B/q");
+    for (int op = 0; op < STATS_OP_COUNT; ++op) {
+        stats_read(op, &s);
+        if (s.calls == 0) {
+            fprintf(out, "%-16s %9d\n", stats_op_name(op), 0);
+            continue;
+        }
+        double calls = (double)s.calls;
+        fprintf(out, "%-16s %9llu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %11.1f %11.1f %9.1f %11.1f\n",
+                stats_op_name(op), (unsigned long long)s.calls, s.totalNs / calls / 1e3,
+                stats_percentile(&s, 50) / 1e3, stats_percentile(&s, 90) / 1e3,
+                stats_percentile(&s, 99) / 1e3, stats_percentile(&s, 99.9) / 1e3, s.maxNs / 1e3,
+                s.totals.settled / calls, s.totals.relaxed / calls,
+                s.totals.lookups / calls, s.totals.allocBytes / calls);
+    }
+}
+
+#else
+
+int stats_enabled(void) {
+    return 0;
+}
+
+int stats_read(StatsOp op, OperationStats *out) {
+    (void)op;
+    if (out != NULL) memset(out, 0, sizeof(*out));
+    return -1;
+}
+
+void stats_reset(void) {
+}
+
+void stats_dump(FILE *out) {
+    fprintf(out, "\nQuery statistics are not compiled in (build with -DAIR_STATS)\n");
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Query instrumentation. Built with -DAIR_STATS, every instrumented query
+// counts the cities it settles, the routes it relaxes, the id lookups and the
+// bytes it allocates, and its wall time goes into a per-operation latency
+// histogram. Without AIR_STATS the macros below expand to nothing and the
+// read functions report that no statistics were collected.
+//
+// Counters are thread-local, so concurrent batch workers do not contend on
+// them. A query that runs inside another (the search behind a graph-level
+// call) is accounted to the outermost operation only.
+
+typedef enum {
+    STATS_CAN_REACH,
+    STATS_SHORTEST_PATH,
+    STATS_ALTERNATE_ROUTE,
+    STATS_OP_COUNT
+} StatsOp;
+
+// log-linear buckets: exact below 64 ns, then 32 buckets per power of two (about 3% wide)
+#define STATS_SUB_BITS 5
+#define STATS_BUCKETS (64 + (64 - 6) * (1 << STATS_SUB_BITS))
+
+typedef struct {
+    uint64_t settled;    // cities taken off a search frontier
+    uint64_t relaxed;    // routes examined from a settled city
+    uint64_t lookups;    // city id -> index hash lookups
+    uint64_t allocBytes; // heap bytes requested
+} StatsCounters;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    StatsCounters totals;
+    uint64_t buckets[STATS_BUCKETS]; // call counts by wall time
+} OperationStats;
+
+int stats_enabled(void);
+const char *stats_op_name(StatsOp op);
+int stats_read(StatsOp op, OperationStats *out);
+uint64_t stats_percentile(const OperationStats *s, double pct);
+void stats_reset(void);
+void stats_dump(FILE *out);
+
+#ifdef AIR_STATS
+
+typedef struct {
+    int outer;           // only the outermost scope on a thread records
+    uint64_t startNs;
+    StatsCounters start;
+} StatsScope;
+
+extern _Thread_local StatsCounters statsLocal;
+
+void stats_scope_begin(StatsScope *scope);
+void stats_scope_end(StatsScope *scope, StatsOp op);
+
+#define STATS_ADD(field, n) (statsLocal.field += (uint64_t)(n))
+#define STATS_BEGIN(scope) StatsScope scope; stats_scope_begin(&scope)
+#define STATS_END(scope, op) stats_scope_end(&scope, op)
+
+#else
+
+#define STATS_ADD(field, n) ((void)0)
+#define STATS_BEGIN(scope) ((void)0)
+#define STATS_END(scope, op) ((void)0)
+
+#endif
+
+#endif
\ No newline at end of file
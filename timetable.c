@@ -0,0 +1,391 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "timetable.h"
+
+#define NO_TIME 0x3FFFFFFF
+
+typedef struct {
+    int flight;
+    int index; // position in the input
+} FlightKey;
+
+static int compare_flight_keys(const void *a, const void *b) {
+    const FlightKey *x = a;
+    const FlightKey *y = b;
+    if (x->flight != y->flight) return x->flight < y->flight ? -1 : 1;
+    return x->index - y->index;
+}
+
+static int compare_connections(const void *a, const void *b) {
+    const Connection *x = a;
+    const Connection *y = b;
+    if (x->departure != y->departure) return x->departure < y->departure ? -1 : 1;
+    if (x->arrival != y->arrival) return x->arrival < y->arrival ? -1 : 1;
+    return x->trip - y->trip;
+}
+
+// trip number of every valid leg: legs with the same flight number form one
+// trip as long as each leg leaves from where the previous one landed, after it
+// landed; a leg that breaks the chain starts a new trip
+static int assign_trips(const FlightSpec *flights, const int *valid, int count, int *trip) {
+    FlightKey *keys = malloc((count > 0 ? count : 1) * sizeof(FlightKey));
+    int *legs = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (keys == NULL || legs == NULL) {
+        free(keys);
+        free(legs);
+        return -1;
+    }
+    
+    int keyCount = 0;
+    int trips = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!valid[i]) continue;
+        if (flights[i].flight < 0) {
+            trip[i] = trips++;
+        } else {
+            keys[keyCount].flight = flights[i].flight;
+            keys[keyCount].index = i;
+            keyCount++;
+        }
+    }
+    qsort(keys, keyCount, sizeof(FlightKey), compare_flight_keys);
+    
+    for (int start = 0; start < keyCount;) {
+        int end = start;
+        while (end < keyCount && keys[end].flight == keys[start].flight) {
+            legs[end - start] = keys[end].index;
+            end++;
+        }
+        int legCount = end - start;
+        
+        // a flight has few legs, insertion sort by departure
+        for (int i = 1; i < legCount; ++i) {
+            int leg = legs[i];
+            int j = i;
+            while (j > 0 && flights[legs[j - 1]].departure > flights[leg].departure) {
+                legs[j] = legs[j - 1];
+                j--;
+            }
+            legs[j] = leg;
+        }
+        
+        trip[legs[0]] = trips++;
+        for (int i = 1; i < legCount; ++i) {
+            const FlightSpec *prev = &flights[legs[i - 1]];
+            const FlightSpec *cur = &flights[legs[i]];
+            int chained = cur->from == prev->to && cur->departure >= prev->arrival;
+            trip[legs[i]] = chained ? trip[legs[i - 1]] : trips++;
+        }
+        start = end;
+    }
+    
+    free(keys);
+    free(legs);
+    return trips;
+}
+
+Timetable *timetable_build(const Graph *g, const FlightSpec *flights, int count, int minTransfer) {
+    if (g == NULL || (flights == NULL && count > 0) || count < 0) return NULL;
+    
+    int n = g->cityCount;
+    Timetable *tt = calloc(1, sizeof(Timetable));
+    int *valid = malloc((count > 0 ? count : 1) * sizeof(int));
+    int *trip = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (tt == NULL || valid == NULL || trip == NULL) {
+        free(tt);
+        free(valid);
+        free(trip);
+        return NULL;
+    }
+    
+    tt->cityCount = n;
+    tt->minTransfer = minTransfer > 0 ? minTransfer : 0;
+    tt->ids = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (tt->ids == NULL) {
+        free(valid);
+        free(trip);
+        timetable_free(tt);
+        return NULL;
+    }
+    for (int i = 0; i < n; ++i) {
+        tt->ids[i] = g->cities[i].id;
+    }
+    id_index_build(&tt->index, tt->ids, n);
+    
+    // legs to unknown cities, loops and legs that land before they leave are dropped
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        const FlightSpec *f = &flights[i];
+        valid[i] = f->from != f->to && f->departure >= 0 && f->arrival > f->departure &&
+                   id_index_find(&tt->index, f->from) != -1 && id_index_find(&tt->index, f->to) != -1;
+        kept += valid[i];
+    }
+    
+    tt->tripCount = assign_trips(flights, valid, count, trip);
+    tt->connections = malloc((kept > 0 ? kept : 1) * sizeof(Connection));
+    if (tt->tripCount < 0 || tt->connections == NULL) {
+        free(valid);
+        free(trip);
+        timetable_free(tt);
+        return NULL;
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        if (!valid[i]) continue;
+        Connection *c = &tt->connections[tt->connectionCount++];
+        c->from = id_index_find(&tt->index, flights[i].from);
+        c->to = id_index_find(&tt->index, flights[i].to);
+        c->departure = flights[i].departure;
+        c->arrival = flights[i].arrival;
+        c->trip = trip[i];
+    }
+    qsort(tt->connections, tt->connectionCount, sizeof(Connection), compare_connections);
+    
+    free(valid);
+    free(trip);
+    return tt;
+}
+
+void timetable_free(Timetable *tt) {
+    if (tt == NULL) return;
+    
+    free(tt->ids);
+    id_index_free(&tt->index);
+    free(tt->connections);
+    free(tt);
+}
+
+TimetableQuery *timetable_query_create(const Timetable *tt) {
+    if (tt == NULL) return NULL;
+    
+    int n = tt->cityCount > 0 ? tt->cityCount : 1;
+    int trips = tt->tripCount > 0 ? tt->tripCount : 1;
+    TimetableQuery *tq = calloc(1, sizeof(TimetableQuery));
+    if (tq == NULL) return NULL;
+    
+    tq->cityCapacity = n;
+    tq->tripCapacity = trips;
+    tq->cityStamp = calloc(n, sizeof(unsigned int));
+    tq->arrival = malloc(n * sizeof(int));
+    tq->board = malloc(n * sizeof(int));
+    tq->exit = malloc(n * sizeof(int));
+    tq->tripStamp = calloc(trips, sizeof(unsigned int));
+    tq->tripBoard = malloc(trips * sizeof(int));
+    if (tq->cityStamp == NULL || tq->arrival == NULL || tq->board == NULL ||
+        tq->exit == NULL || tq->tripStamp == NULL || tq->tripBoard == NULL) {
+        timetable_query_free(tq);
+        return NULL;
+    }
+    return tq;
+}
+
+void timetable_query_free(TimetableQuery *tq) {
+    if (tq == NULL) return;
+    
+    free(tq->cityStamp);
+    free(tq->arrival);
+    free(tq->board);
+    free(tq->exit);
+    free(tq->tripStamp);
+    free(tq->tripBoard);
+    free(tq);
+}
+
+static void query_reset(TimetableQuery *tq) {
+    if (++tq->generation == 0) {
+        memset(tq->cityStamp, 0, tq->cityCapacity * sizeof(unsigned int));
+        memset(tq->tripStamp, 0, tq->tripCapacity * sizeof(unsigned int));
+        tq->generation = 1;
+    }
+}
+
+static int arrival_at(const TimetableQuery *tq, int v) {
+    return tq->cityStamp[v] == tq->generation ? tq->arrival[v] : NO_TIME;
+}
+
+// first connection departing at or after t
+static int first_departure(const Timetable *tt, int t) {
+    int lo = 0;
+    int hi = tt->connectionCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (tt->connections[mid].departure < t) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Earliest arrival at dest when ready to leave source at departAfter, or -1.
+// legs (room for cityCount entries, may be NULL) receives one leg per flight
+// taken, in travel order.
+int timetable_earliest_arrival(const Timetable *tt, TimetableQuery *tq, int source, int dest, int departAfter,
+                               JourneyLeg *legs, int *legCount) {
+    if (tt == NULL || tq == NULL) return -1;
+    if (tq->cityCapacity < tt->cityCount || tq->tripCapacity < tt->tripCount) return -1;
+    if (legCount != NULL) *legCount = 0;
+    
+    int s = id_index_find(&tt->index, source);
+    int t = id_index_find(&tt->index, dest);
+    if (s == -1 || t == -1) return -1;
+    if (s == t) return departAfter;
+    
+    query_reset(tq);
+    tq->cityStamp[s] = tq->generation;
+    tq->arrival[s] = departAfter;
+    
+    const Connection *conns = tt->connections;
+    for (int i = first_departure(tt, departAfter); i < tt->connectionCount; ++i) {
+        const Connection *c = &conns[i];
+        if (c->departure >= arrival_at(tq, t)) break; // nothing later can land sooner
+        
+        if (tq->tripStamp[c->trip] != tq->generation) {
+            int ready = arrival_at(tq, c->from);
+            if (ready == NO_TIME) continue;
+            if (c->from != s) ready += tt->minTransfer;
+            if (ready > c->departure) continue;
+            
+            tq->tripStamp[c->trip] = tq->generation;
+            tq->tripBoard[c->trip] = i;
+        }
+        
+        if (c->arrival < arrival_at(tq, c->to)) {
+            tq->cityStamp[c->to] = tq->generation;
+            tq->arrival[c->to] = c->arrival;
+            tq->board[c->to] = tq->tripBoard[c->trip];
+            tq->exit[c->to] = i;
+        }
+    }
+    
+    int best = arrival_at(tq, t);
+    if (best == NO_TIME) return -1;
+    
+    if (legs != NULL && legCount != NULL) {
+        int count = 0;
+        for (int cur = t; cur != s; cur = conns[tq->board[cur]].from) {
+            count++;
+        }
+        int at = count;
+        for (int cur = t; cur != s; cur = conns[tq->board[cur]].from) {
+            const Connection *in = &conns[tq->board[cur]];
+            const Connection *out = &conns[tq->exit[cur]];
+            JourneyLeg *leg = &legs[--at];
+            leg->from = tt->ids[in->from];
+            leg->to = tt->ids[out->to];
+            leg->departure = in->departure;
+            leg->arrival = out->arrival;
+            leg->trip = in->trip;
+        }
+        *legCount = count;
+    }
+    return best;
+}
+
+typedef struct {
+    ProfileEntry *items; // departure and arrival both strictly decreasing
+    int count;
+    int cap;
+} ProfileList;
+
+// earliest arrival from the list's city when ready to leave at t
+static int profile_eval(const ProfileList *list, int t) {
+    // items[0 .. k) depart at or after t; the last of them arrives first
+    int lo = 0;
+    int hi = list->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (list->items[mid].departure >= t) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo == 0 ? NO_TIME : list->items[lo - 1].arrival;
+}
+
+static int profile_add(ProfileList *list, int departure, int arrival) {
+    if (list->count > 0) {
+        ProfileEntry *last = &list->items[list->count - 1];
+        if (arrival >= last->arrival) return 0; // dominated by a later departure
+        if (departure == last->departure) {
+            last->arrival = arrival;
+            return 0;
+        }
+    }
+    if (list->count == list->cap) {
+        int newCap = list->cap ? list->cap * 2 : 4;
+        ProfileEntry *temp = realloc(list->items, newCap * sizeof(ProfileEntry));
+        if (temp == NULL) return -1;
+        list->items = temp;
+        list->cap = newCap;
+    }
+    list->items[list->count].departure = departure;
+    list->items[list->count].arrival = arrival;
+    list->count++;
+    return 0;
+}
+
+// All Pareto-optimal (departure, arrival) pairs from source to dest for
+// departures in [earliest, latest], in departure order. *entries is allocated
+// for the caller to free. Returns the number of entries, or -1.
+int timetable_profile(const Timetable *tt, int source, int dest, int earliest, int latest, ProfileEntry **entries) {
+    if (tt == NULL || entries == NULL) return -1;
+    *entries = NULL;
+    
+    int s = id_index_find(&tt->index, source);
+    int t = id_index_find(&tt->index, dest);
+    if (s == -1 || t == -1 || s == t) return -1;
+    
+    int n = tt->cityCount;
+    ProfileList *lists = calloc(n, sizeof(ProfileList));
+    int *tripBest = malloc((tt->tripCount > 0 ? tt->tripCount : 1) * sizeof(int));
+    if (lists == NULL || tripBest == NULL) {
+        free(lists);
+        free(tripBest);
+        return -1;
+    }
+    for (int i = 0; i < tt->tripCount; ++i) {
+        tripBest[i] = NO_TIME;
+    }
+    
+    // one backward pass: every stop learns when it can reach dest, later departures first
+    int failed = 0;
+    int first = first_departure(tt, earliest);
+    for (int i = tt->connectionCount - 1; i >= first && !failed; --i) {
+        const Connection *c = &tt->connections[i];
+        
+        int best = c->to == t ? c->arrival : NO_TIME;
+        if (tripBest[c->trip] < best) best = tripBest[c->trip];
+        if (c->to != t) {
+            int onward = profile_eval(&lists[c->to], c->arrival + tt->minTransfer);
+            if (onward < best) best = onward;
+        }
+        if (best == NO_TIME) continue;
+        
+        tripBest[c->trip] = best;
+        if (c->from != t && profile_add(&lists[c->from], c->departure, best) != 0) failed = 1;
+    }
+    
+    int count = 0;
+    const ProfileList *at = &lists[s];
+    if (!failed) {
+        *entries = malloc((at->count > 0 ? at->count : 1) * sizeof(ProfileEntry));
+        if (*entries == NULL) failed = 1;
+    }
+    if (!failed) {
+        for (int i = at->count - 1; i >= 0; --i) {
+            if (at->items[i].departure > latest) break;
+            (*entries)[count++] = at->items[i];
+        }
+    }
+    
+    for (int v = 0; v < n; ++v) {
+        free(lists[v].items);
+    }
+    free(lists);
+    free(tripBest);
+    if (failed) {
+        free(*entries);
+        *entries = NULL;
+        return -1;
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef TIMETABLE_H
+#define TIMETABLE_H
+
+#include "graph.h"
+
+// Flight schedule over the graph's cities, answered with the Connection Scan
+// Algorithm: every timed flight leg is one connection in an array sorted by
+// departure, and a query is a single forward (earliest arrival) or backward
+// (profile) pass over it. Times are minutes from the start of the schedule
+// day; an arrival after midnight is simply >= 1440.
+//
+// Changing planes at a city takes at least minTransfer minutes. Staying on
+// the same flight (legs sharing a flight number) needs no transfer.
+
+#define MINUTES_PER_DAY 1440
+#define DEFAULT_MIN_TRANSFER 45
+
+typedef struct {
+    int from;      // city ids
+    int to;
+    int departure; // minutes
+    int arrival;
+    int flight;    // legs of one multi-stop flight share a number, -1 for a single-leg flight
+} FlightSpec;
+
+typedef struct {
+    int from;      // dense city indices
+    int to;
+    int departure;
+    int arrival;
+    int trip;      // 0 .. tripCount - 1, one per flight
+} Connection;
+
+typedef struct {
+    int cityCount;
+    int *ids;                // dense index -> city id, same order as the graph's cities
+    IdIndex index;           // city id -> dense index
+    int connectionCount;
+    Connection *connections; // sorted by departure, then arrival
+    int tripCount;
+    int minTransfer;         // minutes
+} Timetable;
+
+typedef struct {
+    int from;      // city ids
+    int to;
+    int departure;
+    int arrival;
+    int trip;
+} JourneyLeg;
+
+typedef struct {
+    int departure; // leave the source at this time ...
+    int arrival;   // ... and reach the destination at this time at the earliest
+} ProfileEntry;
+
+// per-thread scratch for earliest arrival queries, reset by generation stamps
+typedef struct {
+    int cityCapacity;
+    int tripCapacity;
+    unsigned int generation;
+    unsigned int *cityStamp;
+    int *arrival;
+    int *board;    // connection where the ride into a city was boarded
+    int *exit;     // connection that arrives at the city
+    unsigned int *tripStamp;
+    int *tripBoard;
+} TimetableQuery;
+
+Timetable *timetable_build(const Graph *g, const FlightSpec *flights, int count, int minTransfer);
+void timetable_free(Timetable *tt);
+
+TimetableQuery *timetable_query_create(const Timetable *tt);
+void timetable_query_free(TimetableQuery *tq);
+
+int timetable_earliest_arrival(const Timetable *tt, TimetableQuery *tq, int source, int dest, int departAfter,
+                               JourneyLeg *legs, int *legCount);
+int timetable_profile(const Timetable *tt, int source, int dest, int earliest, int latest, ProfileEntry **entries);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "workers.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct {
+    WorkerFn fn;
+    void *arg;
+    int worker;
+} WorkerStart;
+
+int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void *worker_main(void *p) {
+    WorkerStart *start = p;
+    start->fn(start->arg, start->worker);
+    return NULL;
+}
+
+// returns the number of threads that actually ran fn
+int run_workers(int threads, WorkerFn fn, void *arg) {
+    if (fn == NULL) return 0;
+    if (threads < 1) threads = 1;
+    
+    pthread_t *handles = malloc(threads * sizeof(pthread_t));
+    WorkerStart *starts = malloc(threads * sizeof(WorkerStart));
+    int started = 1;
+    
+    if (handles != NULL && starts != NULL) {
+        for (int i = 1; i < threads; ++i) {
+            starts[started].fn = fn;
+            starts[started].arg = arg;
+            starts[started].worker = started;
+            if (pthread_create(&handles[started], NULL, worker_main, &starts[started]) != 0) break;
+            started++;
+        }
+    }
+    
+    fn(arg, 0);
+    
+    for (int i = 1; i < started; ++i) {
+        pthread_join(handles[i], NULL);
+    }
+    free(handles);
+    free(starts);
+    return started;
+}
\ No newline at end of file
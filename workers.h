@@ -0,0 +1,14 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+// Minimal fork/join helper: fn(arg, worker) runs once on each of up to
+// `threads` threads (the caller is worker 0) and run_workers returns when all
+// are done. If a thread cannot be started the others carry on, so callers
+// should claim work dynamically rather than by worker number.
+
+typedef void (*WorkerFn)(void *arg, int worker);
+
+int cpu_count(void);
+int run_workers(int threads, WorkerFn fn, void *arg);
+
+#endif
\ No newline at end of file